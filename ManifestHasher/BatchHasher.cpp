@@ -0,0 +1,721 @@
+/*----------------------------------------------------------------------------
+ *  FILE: BatchHasher.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "BatchHasher.h"
+#include "LayoutScheduler.h"
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define F_BATCH_URING (1)
+#endif
+#endif
+#ifndef F_BATCH_URING
+#define F_BATCH_URING (0)
+#endif
+
+#if F_BATCH_URING
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+bool BatchHasher::Options::ParseEngine(std::string const& _name, Engine* o_engine)
+{
+	if (_name == "auto")
+	{
+		*o_engine = Automatic;
+		return true;
+	}
+	if (_name == "uring")
+	{
+		*o_engine = Uring;
+		return true;
+	}
+	if (_name == "pool")
+	{
+		*o_engine = Pool;
+		return true;
+	}
+	return false;
+}
+
+BatchHasher::BatchHasher
+(
+	Options const& _options
+):
+	m_options(_options),
+	m_engineName("none"),
+	m_files(0),
+	m_bytes(0),
+	m_seconds(0.0)
+{
+	if (m_options.m_bufferSize < 4096)
+	{
+		m_options.m_bufferSize = 4096;
+	}
+	if (m_options.m_queueDepth == 0)
+	{
+		m_options.m_queueDepth = 1;
+	}
+}
+
+void BatchHasher::AddError
+(
+	std::string const& _error
+)
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	m_errors.push_back(_error);
+}
+
+bool BatchHasher::Run
+(
+	std::vector<ManifestFile>& io_files
+)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	m_errors.clear();
+
+	// Physical order is an engine of its own, so it can't be had along with
+	// one asked for by name; left to choose, that choice wins
+	ReadOrder order = m_options.m_order;
+	if (order == OrderPhysical && m_options.m_engine != Automatic)
+	{
+		AddError("Physical order can't be used with the uring or pool engine");
+		m_engineName = "none";
+		return false;
+	}
+	if (order == OrderAutomatic)
+	{
+		if (m_options.m_engine != Automatic)
+		{
+			order = OrderParallel;
+		}
+		else
+		{
+			order = (!io_files.empty() && DetectMedia(io_files[0].m_fullPath) == MediaRotational) ? OrderPhysical : OrderParallel;
+		}
+	}
+
+	unsigned threads = m_options.m_threads;
+	if (threads == 0)
+	{
+		threads = std::thread::hardware_concurrency();
+	}
+	WorkStealingPool pool(threads);
+
+	bool done = false;
+	if (order == OrderPhysical)
+	{
+		RunPhysical(io_files);
+		done = true;
+	}
+	if (!done && m_options.m_engine != Pool)
+	{
+		done = RunUring(io_files, pool);
+		if (!done && m_options.m_engine == Uring)
+		{
+			AddError("io_uring is not available");
+			m_engineName = "none";
+			return false;
+		}
+	}
+	if (!done)
+	{
+		std::vector<ManifestFile*> all(io_files.size());
+		for (size_t i = 0; i < io_files.size(); ++i)
+		{
+			all[i] = &io_files[i];
+		}
+		RunPool(all, pool);
+	}
+	pool.Wait();
+
+	m_files = 0;
+	m_bytes = 0;
+	for (size_t i = 0; i < io_files.size(); ++i)
+	{
+		if (io_files[i].m_hashed)
+		{
+			++m_files;
+			m_bytes += io_files[i].m_size;
+		}
+	}
+	m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return m_errors.empty();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Pool engine: a task per file, blocking reads
+
+void BatchHasher::RunPool
+(
+	std::vector<ManifestFile*> const& _files,
+	WorkStealingPool& _pool
+)
+{
+	m_engineName = "pool";
+	std::vector<std::vector<unsigned char> > buffers(_pool.ThreadCount());
+
+	for (size_t i = 0; i < _files.size(); ++i)
+	{
+		ManifestFile* file = _files[i];
+		_pool.Submit([this, file, &buffers, &_pool]()
+		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			std::vector<unsigned char>& buffer = buffers[_pool.CurrentWorker()];
+			if (buffer.empty())
+			{
+				buffer.resize(m_options.m_bufferSize);
+			}
+
+			FILE* handle = fopen(file->m_fullPath.c_str(), "rb");
+			if (handle == NULL)
+			{
+				AddError("Unable to open " + file->m_fullPath);
+				return;
+			}
+			// We read in large blocks already, stdio buffering would only add a copy
+			setvbuf(handle, NULL, _IONBF, 0);
+
+			fSHA1 sha;
+			sha.StreamStart();
+			size_t dataread;
+			while ((dataread = fread(&buffer[0], 1, buffer.size(), handle)) != 0)
+			{
+				sha.Update(&buffer[0], dataread);
+			}
+			bool ok = !ferror(handle);
+			fclose(handle);
+
+			if (!ok)
+			{
+				AddError("Unable to read " + file->m_fullPath);
+				return;
+			}
+			sha.Finish();
+			file->m_digest = sha.Digest();
+			file->m_size = sha.m_totalSize;
+			file->m_hashed = true;
+			file->m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		});
+	}
+	_pool.Wait();
+}
+
+static void IgnoreFile(ManifestFile const& /*_file*/, void* /*_context*/)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Physical order: one thread reading in elevator order
+
+void BatchHasher::RunPhysical
+(
+	std::vector<ManifestFile>& io_files
+)
+{
+	m_engineName = "physical order";
+
+	std::vector<ManifestFile*> files;
+	for (size_t i = 0; i < io_files.size(); ++i)
+	{
+		files.push_back(&io_files[i]);
+	}
+
+	LayoutScheduler::Options options;
+	options.m_bufferSize = m_options.m_bufferSize;
+	LayoutScheduler scheduler(options);
+	scheduler.Plan(files);
+	scheduler.Run(&IgnoreFile, NULL);
+	for (size_t i = 0; i < scheduler.Errors().size(); ++i)
+	{
+		AddError(scheduler.Errors()[i]);
+	}
+}
+
+#if F_BATCH_URING
+
+////////////////////////////////////////////////////////////////////////////////
+/// Just enough of an io_uring: the shared rings set up with the raw system
+/// calls, one submitting and reaping thread.
+class UringQueue
+{
+public:
+	UringQueue() :
+		m_fd(-1),
+		m_sqRing(MAP_FAILED),
+		m_cqRing(MAP_FAILED),
+		m_sqes(MAP_FAILED),
+		m_sqRingSize(0),
+		m_cqRingSize(0),
+		m_sqesSize(0),
+		m_sqTailLocal(0),
+		m_toSubmit(0)
+	{
+		memset(m_supported, 0, sizeof(m_supported));
+	}
+
+	~UringQueue()
+	{
+		Close();
+	}
+
+	/// Unmap the rings and close the ring, which cancels anything in flight
+	void Close()
+	{
+		if (m_sqes != MAP_FAILED)
+		{
+			munmap(m_sqes, m_sqesSize);
+			m_sqes = MAP_FAILED;
+		}
+		if (m_cqRing != MAP_FAILED && m_cqRing != m_sqRing)
+		{
+			munmap(m_cqRing, m_cqRingSize);
+		}
+		m_cqRing = MAP_FAILED;
+		if (m_sqRing != MAP_FAILED)
+		{
+			munmap(m_sqRing, m_sqRingSize);
+			m_sqRing = MAP_FAILED;
+		}
+		if (m_fd >= 0)
+		{
+			close(m_fd);
+			m_fd = -1;
+		}
+	}
+
+	/// False if the kernel doesn't have io_uring or won't let us use it
+	bool Open(unsigned _entries)
+	{
+		io_uring_params params;
+		memset(&params, 0, sizeof(params));
+		m_fd = (int)syscall(__NR_io_uring_setup, _entries, &params);
+		if (m_fd < 0)
+		{
+			return false;
+		}
+
+		m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		if (params.features & IORING_FEAT_SINGLE_MMAP)
+		{
+			m_sqRingSize = m_cqRingSize = (m_sqRingSize > m_cqRingSize) ? m_sqRingSize : m_cqRingSize;
+		}
+		m_sqRing = mmap(NULL, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+		if (m_sqRing == MAP_FAILED)
+		{
+			return false;
+		}
+		if (params.features & IORING_FEAT_SINGLE_MMAP)
+		{
+			m_cqRing = m_sqRing;
+		}
+		else
+		{
+			m_cqRing = mmap(NULL, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+			if (m_cqRing == MAP_FAILED)
+			{
+				return false;
+			}
+		}
+		m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+		m_sqes = mmap(NULL, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+		if (m_sqes == MAP_FAILED)
+		{
+			return false;
+		}
+
+		unsigned char* sq = (unsigned char*)m_sqRing;
+		m_sqHead = (unsigned*)(sq + params.sq_off.head);
+		m_sqTail = (unsigned*)(sq + params.sq_off.tail);
+		m_sqMask = *(unsigned*)(sq + params.sq_off.ring_mask);
+		m_sqEntries = *(unsigned*)(sq + params.sq_off.ring_entries);
+		m_sqArray = (unsigned*)(sq + params.sq_off.array);
+		m_sqTailLocal = *m_sqTail;
+
+		unsigned char* cq = (unsigned char*)m_cqRing;
+		m_cqHead = (unsigned*)(cq + params.cq_off.head);
+		m_cqTail = (unsigned*)(cq + params.cq_off.tail);
+		m_cqMask = *(unsigned*)(cq + params.cq_off.ring_mask);
+		m_cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+
+		// Which operations this kernel has (5.6 for open, read and close)
+		std::vector<uint64> probe((sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op) + 7) / 8, 0);
+		io_uring_probe* info = (io_uring_probe*)&probe[0];
+		if (syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_PROBE, info, 256) < 0)
+		{
+			return false;
+		}
+		for (unsigned op = 0; op <= info->last_op && op < 256; ++op)
+		{
+			m_supported[op] = (info->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+		}
+		return true;
+	}
+
+	bool Supports(unsigned _op) const
+	{
+		return _op < 256 && m_supported[_op];
+	}
+
+	/// A cleared submission entry, or NULL if the queue is full
+	io_uring_sqe* NextEntry()
+	{
+		unsigned head = __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+		if (m_sqTailLocal - head >= m_sqEntries)
+		{
+			return NULL;
+		}
+		unsigned index = m_sqTailLocal & m_sqMask;
+		io_uring_sqe* sqe = (io_uring_sqe*)m_sqes + index;
+		memset(sqe, 0, sizeof(*sqe));
+		m_sqArray[index] = index;
+		++m_sqTailLocal;
+		++m_toSubmit;
+		return sqe;
+	}
+
+	/// Submit the queued entries and wait for at least one completion.
+	/// Returns false on an unexpected error.
+	bool SubmitAndWait()
+	{
+		__atomic_store_n(m_sqTail, m_sqTailLocal, __ATOMIC_RELEASE);
+		long submitted = syscall(__NR_io_uring_enter, m_fd, m_toSubmit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+		if (submitted < 0)
+		{
+			// Interrupted, or out of room for completions: reap and come back
+			return errno == EINTR || errno == EAGAIN || errno == EBUSY;
+		}
+		m_toSubmit -= (unsigned)submitted;
+		return true;
+	}
+
+	bool NextCompletion(io_uring_cqe* o_cqe)
+	{
+		unsigned head = *m_cqHead;
+		if (head == __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE))
+		{
+			return false;
+		}
+		*o_cqe = m_cqes[head & m_cqMask];
+		__atomic_store_n(m_cqHead, head + 1, __ATOMIC_RELEASE);
+		return true;
+	}
+
+private:
+	int m_fd;
+	void* m_sqRing;
+	void* m_cqRing;
+	void* m_sqes;
+	size_t m_sqRingSize;
+	size_t m_cqRingSize;
+	size_t m_sqesSize;
+
+	unsigned* m_sqHead;
+	unsigned* m_sqTail;
+	unsigned m_sqMask;
+	unsigned m_sqEntries;
+	unsigned* m_sqArray;
+	unsigned m_sqTailLocal;		// entries queued, published to m_sqTail on submit
+	unsigned m_toSubmit;
+
+	unsigned* m_cqHead;
+	unsigned* m_cqTail;
+	unsigned m_cqMask;
+	io_uring_cqe* m_cqes;
+
+	bool m_supported[256];
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// One file in flight. Its buffer is either being read into or hashed,
+/// never both, so reads and hashing of the one file stay in order.
+struct UringSlot
+{
+	enum State
+	{
+		Idle,
+		Opening,
+		Reading,
+		Hashing,
+		Closing,
+	};
+
+	State m_state;
+	ManifestFile* m_file;
+	int m_fd;
+	bool m_failed;
+	uint64 m_offset;
+	size_t m_lastRead;
+	fSHA1 m_sha;
+	std::vector<unsigned char> m_buffer;
+	std::chrono::steady_clock::time_point m_start;
+
+	UringSlot() : m_state(Idle), m_file(NULL), m_fd(-1), m_failed(false), m_offset(0), m_lastRead(0) {}
+};
+
+// user_data of the read on the eventfd hashing tasks signal when they finish
+static const uint64 WakeTag = ~0ull;
+
+bool BatchHasher::RunUring
+(
+	std::vector<ManifestFile>& io_files,
+	WorkStealingPool& _pool
+)
+{
+	unsigned depth = (m_options.m_queueDepth > 4096) ? 4096 : m_options.m_queueDepth;
+	if (depth > io_files.size())
+	{
+		depth = io_files.empty() ? 1 : (unsigned)io_files.size();
+	}
+
+	UringQueue ring;
+	if (!ring.Open(depth + 1) || !ring.Supports(IORING_OP_OPENAT) || !ring.Supports(IORING_OP_READ) || !ring.Supports(IORING_OP_CLOSE))
+	{
+		return false;
+	}
+	int wake = eventfd(0, EFD_CLOEXEC);
+	if (wake < 0)
+	{
+		return false;
+	}
+	m_engineName = "io_uring";
+
+	std::vector<UringSlot> slots(depth);
+	for (size_t i = 0; i < slots.size(); ++i)
+	{
+		slots[i].m_buffer.resize(m_options.m_bufferSize);
+	}
+
+	// Slots whose buffer has been hashed, filled in by the pool
+	std::mutex readyLock;
+	std::vector<size_t> ready;
+	std::vector<size_t> readyNow;
+	uint64 wakeValue = 0;
+
+	size_t nextFile = 0;
+	size_t busy = 0;
+	bool ok = true;
+
+	// Every slot has at most one operation in flight, plus the eventfd read,
+	// so the ring (depth + 1 entries) can't run out
+	auto queueRead = [&](size_t _slot)
+	{
+		UringSlot& slot = slots[_slot];
+		io_uring_sqe* sqe = ring.NextEntry();
+		sqe->opcode = IORING_OP_READ;
+		sqe->fd = slot.m_fd;
+		sqe->addr = (uint64)(uintptr_t)&slot.m_buffer[0];
+		sqe->len = (unsigned)slot.m_buffer.size();
+		sqe->off = slot.m_offset;
+		sqe->user_data = _slot;
+		slot.m_state = UringSlot::Reading;
+	};
+	auto queueClose = [&](size_t _slot)
+	{
+		UringSlot& slot = slots[_slot];
+		io_uring_sqe* sqe = ring.NextEntry();
+		sqe->opcode = IORING_OP_CLOSE;
+		sqe->fd = slot.m_fd;
+		sqe->user_data = _slot;
+		slot.m_state = UringSlot::Closing;
+	};
+	auto queueWake = [&]()
+	{
+		io_uring_sqe* sqe = ring.NextEntry();
+		sqe->opcode = IORING_OP_READ;
+		sqe->fd = wake;
+		sqe->addr = (uint64)(uintptr_t)&wakeValue;
+		sqe->len = sizeof(wakeValue);
+		sqe->off = (uint64)-1;
+		sqe->user_data = WakeTag;
+	};
+	auto startNext = [&](size_t _slot)
+	{
+		UringSlot& slot = slots[_slot];
+		if (nextFile == io_files.size())
+		{
+			slot.m_state = UringSlot::Idle;
+			slot.m_file = NULL;
+			return;
+		}
+		slot.m_file = &io_files[nextFile++];
+		slot.m_fd = -1;
+		slot.m_failed = false;
+		slot.m_offset = 0;
+		slot.m_start = std::chrono::steady_clock::now();
+		slot.m_state = UringSlot::Opening;
+		++busy;
+
+		io_uring_sqe* sqe = ring.NextEntry();
+		sqe->opcode = IORING_OP_OPENAT;
+		sqe->fd = AT_FDCWD;
+		sqe->addr = (uint64)(uintptr_t)slot.m_file->m_fullPath.c_str();
+		sqe->open_flags = O_RDONLY | O_CLOEXEC;
+		sqe->user_data = _slot;
+	};
+
+	queueWake();
+	for (size_t i = 0; i < slots.size(); ++i)
+	{
+		startNext(i);
+	}
+
+	while (busy != 0)
+	{
+		if (!ring.SubmitAndWait())
+		{
+			AddError(std::string("io_uring_enter failed: ") + strerror(errno));
+			ok = false;
+			break;
+		}
+
+		io_uring_cqe cqe;
+		while (ring.NextCompletion(&cqe))
+		{
+			if (cqe.user_data == WakeTag)
+			{
+				{
+					std::lock_guard<std::mutex> lock(readyLock);
+					readyNow.swap(ready);
+				}
+				for (size_t i = 0; i < readyNow.size(); ++i)
+				{
+					slots[readyNow[i]].m_offset += slots[readyNow[i]].m_lastRead;
+					queueRead(readyNow[i]);
+				}
+				readyNow.clear();
+				queueWake();
+				continue;
+			}
+
+			size_t index = (size_t)cqe.user_data;
+			UringSlot& slot = slots[index];
+			switch (slot.m_state)
+			{
+			case UringSlot::Opening:
+				if (cqe.res < 0)
+				{
+					AddError("Unable to open " + slot.m_file->m_fullPath);
+					--busy;
+					startNext(index);
+					break;
+				}
+				slot.m_fd = cqe.res;
+				slot.m_sha.StreamStart();
+				queueRead(index);
+				break;
+
+			case UringSlot::Reading:
+				if (cqe.res < 0)
+				{
+					AddError("Unable to read " + slot.m_file->m_fullPath);
+					slot.m_failed = true;
+					queueClose(index);
+				}
+				else if (cqe.res == 0)
+				{
+					// A short read isn't taken as the end, only an empty one
+					queueClose(index);
+				}
+				else
+				{
+					slot.m_state = UringSlot::Hashing;
+					slot.m_lastRead = (size_t)cqe.res;
+					UringSlot* hashing = &slot;
+					_pool.Submit([hashing, index, wake, &readyLock, &ready]()
+					{
+						hashing->m_sha.Update(&hashing->m_buffer[0], hashing->m_lastRead);
+						{
+							std::lock_guard<std::mutex> lock(readyLock);
+							ready.push_back(index);
+						}
+						uint64 one = 1;
+						if (write(wake, &one, sizeof(one)) < 0)
+						{
+							// Can only fail if the counter would overflow, and then a wakeup is pending anyway
+						}
+					});
+				}
+				break;
+
+			case UringSlot::Closing:
+				if (!slot.m_failed)
+				{
+					slot.m_sha.Finish();
+					slot.m_file->m_digest = slot.m_sha.Digest();
+					slot.m_file->m_size = slot.m_sha.m_totalSize;
+					slot.m_file->m_hashed = true;
+				}
+				slot.m_file->m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - slot.m_start).count();
+				slot.m_fd = -1;
+				--busy;
+				startNext(index);
+				break;
+
+			default:
+				break;
+			}
+		}
+	}
+
+	// Hashing tasks refer to the slots
+	_pool.Wait();
+	if (!ok)
+	{
+		// Nothing more will complete; the ring has to go before the buffers
+		// it may still be reading into, then the files it left open
+		ring.Close();
+		std::vector<ManifestFile*> rest;
+		for (size_t i = 0; i < slots.size(); ++i)
+		{
+			if (slots[i].m_fd >= 0)
+			{
+				close(slots[i].m_fd);
+			}
+			if (slots[i].m_state != UringSlot::Idle)
+			{
+				rest.push_back(slots[i].m_file);
+			}
+		}
+		while (nextFile < io_files.size())
+		{
+			rest.push_back(&io_files[nextFile++]);
+		}
+		close(wake);
+
+		// Finish the unhashed files on the pool rather than leave them out
+		RunPool(rest, _pool);
+		m_engineName = "io_uring, then pool";
+		return true;
+	}
+	close(wake);
+	return true;
+}
+
+#else
+
+bool BatchHasher::RunUring
+(
+	std::vector<ManifestFile>& /*io_files*/,
+	WorkStealingPool& /*_pool*/
+)
+{
+	return false;
+}
+
+#endif
@@ -0,0 +1,116 @@
+/*----------------------------------------------------------------------------
+ *  FILE: BatchHasher.h
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		Hashes a given list of files. With many small files the time goes on
+ *		opening, reading and closing rather than hashing, so on Linux the
+ *		opens, reads and closes for a deep queue of files are issued through
+ *		io_uring from one thread, and each buffer read is handed to a
+ *		WorkStealingPool to hash. Where io_uring isn't available (other
+ *		platforms, old kernels, or blocked by a sandbox) every file is a pool
+ *		task of its own instead.
+ *
+ *		If the files are on a rotational disk, neither engine is used: they
+ *		are read in physical order by a LayoutScheduler.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef _BATCHHASHER_H
+#define _BATCHHASHER_H
+
+#include "TreeHasher.h"
+#include <mutex>
+#include <string>
+#include <vector>
+
+class BatchHasher
+{
+public:
+	enum Engine
+	{
+		Automatic,		// io_uring where possible, otherwise the pool
+		Uring,			// io_uring or fail
+		Pool,
+	};
+
+	struct Options
+	{
+		Engine m_engine;
+		unsigned m_threads;			// hashing threads, 0 for one per CPU
+		unsigned m_queueDepth;		// io_uring: files in flight at once
+		unsigned m_bufferSize;		// bytes per read
+		ReadOrder m_order;			// physical only with the Automatic engine, auto is parallel with the others
+
+		Options() :
+			m_engine(Automatic),
+			m_threads(0),
+			m_queueDepth(128),
+			m_bufferSize(256 * 1024),
+			m_order(OrderAutomatic)
+		{
+		}
+
+		static bool ParseEngine(std::string const& _name, Engine* o_engine);
+	};
+
+	explicit BatchHasher(Options const& _options);
+
+	/// Hash every file in io_files, opened by m_fullPath; m_size, m_digest,
+	/// m_seconds and m_hashed are filled in. Returns false if anything
+	/// couldn't be read, Errors() says what.
+	bool Run(std::vector<ManifestFile>& io_files);
+
+	/// What the last Run() used, "io_uring", "pool" or "physical order",
+	/// or "io_uring, then pool" if the ring failed part way
+	char const* EngineName() const
+	{
+		return m_engineName;
+	}
+
+	std::vector<std::string> const& Errors() const
+	{
+		return m_errors;
+	}
+
+	// Totals for the last Run()
+	uint64 Files() const
+	{
+		return m_files;
+	}
+	uint64 Bytes() const
+	{
+		return m_bytes;
+	}
+	double Seconds() const
+	{
+		return m_seconds;
+	}
+	double FilesPerSecond() const
+	{
+		return (m_seconds > 0.0) ? (double)m_files / m_seconds : 0.0;
+	}
+	double MegabytesPerSecond() const
+	{
+		return (m_seconds > 0.0) ? (double)m_bytes / (1024.0 * 1024.0) / m_seconds : 0.0;
+	}
+
+private:
+	Options m_options;
+	char const* m_engineName;
+	std::mutex m_lock;
+	std::vector<std::string> m_errors;
+	uint64 m_files;
+	uint64 m_bytes;
+	double m_seconds;
+
+	/// Returns false without touching io_files if io_uring can't be used.
+	/// If the ring fails part way, the rest are hashed by RunPool.
+	bool RunUring(std::vector<ManifestFile>& io_files, WorkStealingPool& _pool);
+	void RunPool(std::vector<ManifestFile*> const& _files, WorkStealingPool& _pool);
+	void RunPhysical(std::vector<ManifestFile>& io_files);
+	void AddError(std::string const& _error);
+};
+
+#endif
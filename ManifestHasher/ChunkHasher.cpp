@@ -0,0 +1,380 @@
+/*----------------------------------------------------------------------------
+ *  FILE: ChunkHasher.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "ChunkHasher.h"
+#include "../WatchDog/AtomicFile.h"
+#include <fstream>
+#include <stdio.h>
+#include <string.h>
+
+// First line of a chunk list file, bump the version if the layout changes
+static char const* const ChunkListHeader = "WatchDogChunks\t1";
+
+static void PutLittleEndian64(unsigned char* o_bytes, uint64 _value)
+{
+	for (unsigned i = 0; i < 8; ++i)
+	{
+		o_bytes[i] = (unsigned char)(_value >> (8 * i));
+	}
+}
+
+static size_t ChunkCount(uint64 _size, uint64 _chunkSize)
+{
+	return (_size == 0) ? 1 : (size_t)((_size + _chunkSize - 1) / _chunkSize);
+}
+
+Sha1Digest ChunkList::ComputeRoot() const
+{
+	std::vector<Sha1Digest> level = m_chunks;
+	while (level.size() > 1)
+	{
+		std::vector<Sha1Digest> next;
+		for (size_t i = 0; i < level.size(); i += 2)
+		{
+			if (i + 1 == level.size())
+			{
+				next.push_back(level[i]);
+				continue;
+			}
+			unsigned char node[1 + 2 * Sha1Digest::Size];
+			node[0] = 0x01;
+			memcpy(node + 1, level[i].m_bytes, Sha1Digest::Size);
+			memcpy(node + 1 + Sha1Digest::Size, level[i + 1].m_bytes, Sha1Digest::Size);
+			next.push_back(fSHA1::ComputeHash(node, sizeof(node)).Digest());
+		}
+		level.swap(next);
+	}
+
+	unsigned char root[1 + 8 + 8 + Sha1Digest::Size];
+	root[0] = 0x02;
+	PutLittleEndian64(root + 1, m_size);
+	PutLittleEndian64(root + 9, m_chunkSize);
+	memcpy(root + 17, level.empty() ? Sha1Digest().m_bytes : level[0].m_bytes, Sha1Digest::Size);
+	return fSHA1::ComputeHash(root, sizeof(root)).Digest();
+}
+
+bool ChunkList::Save
+(
+	std::string const& _path
+) const
+{
+	std::string contents = ChunkListHeader;
+	contents += "\n";
+
+	char line[128];
+	snprintf(line, sizeof(line), "%llu\t%llu\t", m_size, m_chunkSize);
+	contents += line;
+	contents += m_root.ToString(true);
+	contents += "\t";
+	contents += m_hasWholeFile ? m_wholeFile.ToString(true) : std::string("-");
+	contents += "\n";
+	for (size_t i = 0; i < m_chunks.size(); ++i)
+	{
+		contents += m_chunks[i].ToString(true);
+		contents += "\n";
+	}
+
+	return AtomicWriteFile(_path, contents.data(), contents.size());
+}
+
+bool ChunkList::Load
+(
+	std::string const& _path
+)
+{
+	std::ifstream file(_path.c_str(), std::ios::in | std::ios::binary);
+	std::string line;
+	if (!file.is_open() || !std::getline(file, line) || line != ChunkListHeader || !std::getline(file, line))
+	{
+		return false;
+	}
+
+	unsigned long long size, chunkSize;
+	char root[41], whole[41];
+	if (sscanf(line.c_str(), "%llu\t%llu\t%40s\t%40s", &size, &chunkSize, root, whole) != 4 || chunkSize == 0 ||
+		!Sha1Digest::Parse(root, &m_root))
+	{
+		return false;
+	}
+	m_size = size;
+	m_chunkSize = chunkSize;
+	m_hasWholeFile = Sha1Digest::Parse(whole, &m_wholeFile);
+
+	m_chunks.clear();
+	while (std::getline(file, line))
+	{
+		Sha1Digest chunk;
+		if (!Sha1Digest::Parse(line, &chunk))
+		{
+			return false;
+		}
+		m_chunks.push_back(chunk);
+	}
+	return m_chunks.size() == ChunkCount(m_size, m_chunkSize) && ComputeRoot() == m_root;
+}
+
+static bool SeekTo(FILE* _file, uint64 _offset)
+{
+#ifdef _WIN32
+	return _fseeki64(_file, (long long)_offset, SEEK_SET) == 0;
+#else
+	return fseeko(_file, (off_t)_offset, SEEK_SET) == 0;
+#endif
+}
+
+static uint64 FileSize(FILE* _file)
+{
+#ifdef _WIN32
+	_fseeki64(_file, 0, SEEK_END);
+	long long size = _ftelli64(_file);
+#else
+	fseeko(_file, 0, SEEK_END);
+	long long size = (long long)ftello(_file);
+#endif
+	return (size > 0) ? (uint64)size : 0;
+}
+
+ChunkHasher::ChunkHasher
+(
+	Options const& _options
+):
+	m_options(_options),
+	m_size(0),
+	m_chunkSize(0),
+	m_chunkCount(0),
+	m_chunks(NULL),
+	m_whole(NULL),
+	m_throttle(NULL),
+	m_nextChunk(0),
+	m_nextWhole(0),
+	m_failed(false)
+{
+}
+
+bool ChunkHasher::Hash
+(
+	std::string const& _path,
+	ChunkList* o_list
+)
+{
+	fSHA1 whole;
+	o_list->m_chunkSize = m_options.m_chunkSize;
+	if (!Run(_path, m_options.m_chunkSize, m_options.m_wholeFile ? &whole : NULL, &o_list->m_chunks, &o_list->m_size))
+	{
+		return false;
+	}
+
+	o_list->m_root = o_list->ComputeRoot();
+	o_list->m_hasWholeFile = m_options.m_wholeFile;
+	if (m_options.m_wholeFile)
+	{
+		o_list->m_wholeFile = whole.Digest();
+	}
+	return true;
+}
+
+bool ChunkHasher::Verify
+(
+	std::string const& _path,
+	ChunkList const& _expected,
+	std::vector<ChunkRange>* o_bad
+)
+{
+	o_bad->clear();
+
+	std::vector<Sha1Digest> chunks;
+	uint64 size = 0;
+	if (!Run(_path, _expected.m_chunkSize, NULL, &chunks, &size))
+	{
+		return false;
+	}
+
+	uint64 end = (size > _expected.m_size) ? size : _expected.m_size;
+	size_t count = (chunks.size() > _expected.m_chunks.size()) ? chunks.size() : _expected.m_chunks.size();
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (i < chunks.size() && i < _expected.m_chunks.size() && chunks[i] == _expected.m_chunks[i])
+		{
+			continue;
+		}
+
+		ChunkRange range;
+		range.m_offset = (uint64)i * _expected.m_chunkSize;
+		range.m_length = (end - range.m_offset < _expected.m_chunkSize) ? end - range.m_offset : _expected.m_chunkSize;
+		if (!o_bad->empty() && o_bad->back().m_offset + o_bad->back().m_length == range.m_offset)
+		{
+			o_bad->back().m_length += range.m_length;
+		}
+		else
+		{
+			o_bad->push_back(range);
+		}
+	}
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Hash every chunk of _path, and the whole file into o_whole if it
+///        isn't NULL
+bool ChunkHasher::Run
+(
+	std::string const& _path,
+	uint64 _chunkSize,
+	fSHA1* o_whole,
+	std::vector<Sha1Digest>* o_chunks,
+	uint64* o_size
+)
+{
+	m_error.clear();
+	if (_chunkSize == 0)
+	{
+		m_error = "Chunk size must not be zero";
+		return false;
+	}
+
+	FILE* file = fopen(_path.c_str(), "rb");
+	if (file == NULL)
+	{
+		m_error = "Unable to open " + _path;
+		return false;
+	}
+	m_size = FileSize(file);
+	fclose(file);
+
+	m_path = _path;
+	m_chunkSize = _chunkSize;
+	m_chunkCount = ChunkCount(m_size, _chunkSize);
+	o_chunks->assign(m_chunkCount, Sha1Digest());
+	m_chunks = o_chunks;
+	m_whole = o_whole;
+	m_nextChunk = 0;
+	m_nextWhole = 0;
+	m_failed = false;
+	if (m_whole)
+	{
+		m_whole->StreamStart();
+	}
+
+	unsigned threads = m_options.m_threads;
+	if (threads == 0)
+	{
+		threads = std::thread::hardware_concurrency();
+	}
+	{
+		WorkStealingPool pool(threads);
+		IoThrottle throttle(m_options.m_ioConcurrency);
+		m_throttle = &throttle;
+
+		// Tasks claim chunks in order, so whichever chunk the whole-file
+		// digest is waiting for is always in the hands of a running task
+		size_t tasks = (pool.ThreadCount() < m_chunkCount) ? pool.ThreadCount() : m_chunkCount;
+		for (size_t i = 0; i < tasks; ++i)
+		{
+			pool.Submit([this]() { HashChunks(); });
+		}
+		pool.Wait();
+		m_throttle = NULL;
+	}
+
+	m_chunks = NULL;
+	m_whole = NULL;
+	if (m_failed)
+	{
+		return false;
+	}
+	if (o_whole)
+	{
+		o_whole->Finish();
+	}
+	*o_size = m_size;
+	return true;
+}
+
+void ChunkHasher::HashChunks()
+{
+	FILE* file = fopen(m_path.c_str(), "rb");
+	if (file == NULL)
+	{
+		Fail("Unable to open " + m_path);
+		return;
+	}
+	// Whole chunks are read at once, stdio buffering would only add a copy
+	setvbuf(file, NULL, _IONBF, 0);
+	std::vector<unsigned char> buffer((size_t)((m_size < m_chunkSize) ? m_size + 1 : m_chunkSize));
+
+	while (1)
+	{
+		size_t index;
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			if (m_failed || m_nextChunk == m_chunkCount)
+			{
+				break;
+			}
+			index = m_nextChunk++;
+		}
+
+		uint64 offset = (uint64)index * m_chunkSize;
+		size_t length = (size_t)((m_size - offset < m_chunkSize) ? m_size - offset : m_chunkSize);
+		size_t dataread = 0;
+		if (length != 0)
+		{
+			IoThrottle::Scope io(*m_throttle);
+			if (SeekTo(file, offset))
+			{
+				dataread = fread(&buffer[0], 1, length, file);
+			}
+		}
+		if (dataread != length)
+		{
+			Fail(ferror(file) ? "Unable to read " + m_path : m_path + " changed size while being read");
+			break;
+		}
+
+		(*m_chunks)[index] = fSHA1::ComputeHash(&buffer[0], length).Digest();
+
+		if (m_whole)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_lock);
+				while (m_nextWhole != index && !m_failed)
+				{
+					m_turn.wait(lock);
+				}
+				if (m_failed)
+				{
+					break;
+				}
+			}
+			// Only the task whose turn it is touches m_whole
+			m_whole->Update(&buffer[0], length);
+			{
+				std::lock_guard<std::mutex> lock(m_lock);
+				++m_nextWhole;
+			}
+			m_turn.notify_all();
+		}
+	}
+	fclose(file);
+}
+
+void ChunkHasher::Fail
+(
+	std::string const& _error
+)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		if (!m_failed)
+		{
+			m_failed = true;
+			m_error = _error;
+		}
+	}
+	m_turn.notify_all();
+}
@@ -0,0 +1,120 @@
+/*----------------------------------------------------------------------------
+ *  FILE: ChunkHasher.h
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		Hashes a large file as fixed size chunks, each with its own SHA-1,
+ *		on a WorkStealingPool, and combines the chunk digests into a Merkle
+ *		root. Verifying against a saved ChunkList gives the byte ranges
+ *		that differ, so only those need fetching again.
+ *
+ *		The classic whole-file SHA-1 that manifests hold can be calculated
+ *		in the same pass: each chunk is fed to it in order as it is read.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef _CHUNKHASHER_H
+#define _CHUNKHASHER_H
+
+#include "../WatchDog/sha1.h"
+#include "WorkStealingPool.h"
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+/// Chunk digests of one file. A chunk digest is the plain SHA-1 of that byte
+/// range, so it can be checked with any tool. Interior tree nodes are
+/// SHA-1(0x01, left, right), an odd node out moves up a level unchanged, and
+/// the root is SHA-1(0x02, size, chunk size, top node) with the sizes as
+/// little endian 64 bit values. An empty file has a single empty chunk.
+struct ChunkList
+{
+	uint64 m_size;
+	uint64 m_chunkSize;
+	std::vector<Sha1Digest> m_chunks;
+	Sha1Digest m_root;
+	bool m_hasWholeFile;
+	Sha1Digest m_wholeFile;		// as in a manifest, if m_hasWholeFile
+
+	ChunkList() : m_size(0), m_chunkSize(0), m_hasWholeFile(false) {}
+
+	/// Root of m_chunks for m_size and m_chunkSize
+	Sha1Digest ComputeRoot() const;
+
+	/// Text file: a header line, a line with the size, chunk size, root and
+	/// whole-file digest (or -), then one digest per chunk
+	bool Save(std::string const& _path) const;
+
+	/// False if the file is missing, malformed, or its root doesn't match
+	/// its chunks
+	bool Load(std::string const& _path);
+};
+
+struct ChunkRange
+{
+	uint64 m_offset;
+	uint64 m_length;
+};
+
+class ChunkHasher
+{
+public:
+	struct Options
+	{
+		unsigned m_threads;			// hashing threads, 0 for one per CPU
+		unsigned m_ioConcurrency;	// reads in flight at once
+		uint64 m_chunkSize;
+		bool m_wholeFile;			// Hash() also calculates the whole-file digest
+
+		Options() :
+			m_threads(0),
+			m_ioConcurrency(4),
+			m_chunkSize(4 * 1024 * 1024),
+			m_wholeFile(true)
+		{
+		}
+	};
+
+	explicit ChunkHasher(Options const& _options);
+
+	/// Returns false, with Error() set, if the file can't be read
+	bool Hash(std::string const& _path, ChunkList* o_list);
+
+	/// Hash _path in _expected's chunk size and list the ranges whose
+	/// digests differ, adjacent ones merged. Bytes past the end of the
+	/// shorter of the file and _expected count as differing. Returns false,
+	/// with Error() set, only if the file can't be read.
+	bool Verify(std::string const& _path, ChunkList const& _expected, std::vector<ChunkRange>* o_bad);
+
+	std::string const& Error() const
+	{
+		return m_error;
+	}
+
+private:
+	Options m_options;
+	std::string m_error;
+
+	// State of the current run, shared by the pool's tasks
+	std::string m_path;
+	uint64 m_size;
+	uint64 m_chunkSize;
+	size_t m_chunkCount;
+	std::vector<Sha1Digest>* m_chunks;
+	fSHA1* m_whole;
+	IoThrottle* m_throttle;
+	std::mutex m_lock;
+	std::condition_variable m_turn;
+	size_t m_nextChunk;			// next chunk for a task to claim
+	size_t m_nextWhole;			// next chunk for the whole-file digest
+	bool m_failed;
+
+	bool Run(std::string const& _path, uint64 _chunkSize, fSHA1* o_whole, std::vector<Sha1Digest>* o_chunks, uint64* o_size);
+	void HashChunks();
+	void Fail(std::string const& _error);
+};
+
+#endif
@@ -0,0 +1,379 @@
+/*----------------------------------------------------------------------------
+ *  FILE: DiskLayout.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "DiskLayout.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <winioctl.h>
+#else
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <sys/sysmacros.h>
+#endif
+#endif
+
+char const* MediaName
+(
+	MediaKind _media
+)
+{
+	switch (_media)
+	{
+	case MediaRotational:
+		return "rotational";
+	case MediaSolidState:
+		return "solid state";
+	default:
+		return "unknown";
+	}
+}
+
+bool ParseReadOrder
+(
+	std::string const& _name,
+	ReadOrder* o_order
+)
+{
+	if (_name == "auto")
+	{
+		*o_order = OrderAutomatic;
+		return true;
+	}
+	if (_name == "parallel")
+	{
+		*o_order = OrderParallel;
+		return true;
+	}
+	if (_name == "physical")
+	{
+		*o_order = OrderPhysical;
+		return true;
+	}
+	return false;
+}
+
+char const* ReadOrderName
+(
+	ReadOrder _order
+)
+{
+	switch (_order)
+	{
+	case OrderParallel:
+		return "parallel";
+	case OrderPhysical:
+		return "physical";
+	default:
+		return "auto";
+	}
+}
+
+/// Append an extent, merging it into the last one when it carries straight on
+static void AddExtent(std::vector<FileExtent>* io_extents, uint64 _logical, uint64 _physical, uint64 _length)
+{
+	if (!io_extents->empty())
+	{
+		FileExtent& last = io_extents->back();
+		if (last.m_logical + last.m_length == _logical && last.m_physical + last.m_length == _physical)
+		{
+			last.m_length += _length;
+			return;
+		}
+	}
+	FileExtent extent;
+	extent.m_logical = _logical;
+	extent.m_physical = _physical;
+	extent.m_length = _length;
+	io_extents->push_back(extent);
+}
+
+/// Drop what is allocated past the end of the file, preallocation that
+/// holds no data, so the last extent ends where the file does
+static void ClipExtents(std::vector<FileExtent>* io_extents, uint64 _size)
+{
+	while (!io_extents->empty() && io_extents->back().m_logical >= _size)
+	{
+		io_extents->pop_back();
+	}
+	if (!io_extents->empty() && io_extents->back().m_logical + io_extents->back().m_length > _size)
+	{
+		io_extents->back().m_length = _size - io_extents->back().m_logical;
+	}
+}
+
+#ifdef _WIN32
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The volume _path is on, as "C:\" or "\\server\share\"
+static bool VolumeOf(std::string const& _path, std::string* o_volume)
+{
+	char volume[MAX_PATH];
+	if (!GetVolumePathNameA(_path.c_str(), volume, MAX_PATH))
+	{
+		return false;
+	}
+	*o_volume = volume;
+	return true;
+}
+
+MediaKind DetectMedia
+(
+	std::string const& _path
+)
+{
+	std::string volume;
+	if (!VolumeOf(_path, &volume) || volume.size() < 2 || volume[1] != ':')
+	{
+		return MediaUnknown;
+	}
+
+	// Querying the device doesn't need any access to it
+	std::string device = "\\\\.\\" + volume.substr(0, 2);
+	HANDLE handle = CreateFileA(device.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, 0, NULL);
+	if (handle == INVALID_HANDLE_VALUE)
+	{
+		return MediaUnknown;
+	}
+
+	STORAGE_PROPERTY_QUERY query;
+	memset(&query, 0, sizeof(query));
+	query.PropertyId = StorageDeviceSeekPenaltyProperty;
+	query.QueryType = PropertyStandardQuery;
+	DEVICE_SEEK_PENALTY_DESCRIPTOR penalty;
+	memset(&penalty, 0, sizeof(penalty));
+	DWORD returned = 0;
+	BOOL ok = DeviceIoControl(handle, IOCTL_STORAGE_QUERY_PROPERTY, &query, sizeof(query), &penalty, sizeof(penalty), &returned, NULL);
+	CloseHandle(handle);
+
+	if (!ok || returned < sizeof(penalty))
+	{
+		return MediaUnknown;
+	}
+	return penalty.IncursSeekPenalty ? MediaRotational : MediaSolidState;
+}
+
+bool QueryExtents
+(
+	std::string const& _path,
+	std::vector<FileExtent>* o_extents
+)
+{
+	o_extents->clear();
+
+	std::string volume;
+	DWORD sectorsPerCluster, bytesPerSector, freeClusters, totalClusters;
+	if (!VolumeOf(_path, &volume) || !GetDiskFreeSpaceA(volume.c_str(), &sectorsPerCluster, &bytesPerSector, &freeClusters, &totalClusters))
+	{
+		return false;
+	}
+	uint64 clusterSize = (uint64)sectorsPerCluster * bytesPerSector;
+
+	HANDLE handle = CreateFileA(_path.c_str(), FILE_READ_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, 0, NULL);
+	if (handle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	STARTING_VCN_INPUT_BUFFER input;
+	input.StartingVcn.QuadPart = 0;
+	union
+	{
+		RETRIEVAL_POINTERS_BUFFER m_pointers;
+		unsigned char m_space[16 * 1024];
+	} output;
+
+	bool ok = true;
+	while (1)
+	{
+		DWORD returned = 0;
+		BOOL done = DeviceIoControl(handle, FSCTL_GET_RETRIEVAL_POINTERS, &input, sizeof(input), &output, sizeof(output), &returned, NULL);
+		DWORD error = done ? ERROR_SUCCESS : GetLastError();
+		if (!done && error != ERROR_MORE_DATA)
+		{
+			// ERROR_HANDLE_EOF for files small enough to live in their MFT record
+			ok = false;
+			break;
+		}
+
+		RETRIEVAL_POINTERS_BUFFER const& pointers = output.m_pointers;
+		LONGLONG vcn = pointers.StartingVcn.QuadPart;
+		for (DWORD i = 0; i < pointers.ExtentCount; ++i)
+		{
+			LONGLONG next = pointers.Extents[i].NextVcn.QuadPart;
+			LONGLONG lcn = pointers.Extents[i].Lcn.QuadPart;
+			// An LCN of -1 is a hole in a sparse file, or compressed away
+			if (lcn != -1)
+			{
+				AddExtent(o_extents, (uint64)vcn * clusterSize, (uint64)lcn * clusterSize, (uint64)(next - vcn) * clusterSize);
+			}
+			vcn = next;
+		}
+		if (done || pointers.ExtentCount == 0)
+		{
+			break;
+		}
+		input.StartingVcn.QuadPart = vcn;
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(handle, &size))
+	{
+		ok = false;
+	}
+	CloseHandle(handle);
+	if (ok)
+	{
+		ClipExtents(o_extents, (uint64)size.QuadPart);
+	}
+
+	return ok && !o_extents->empty();
+}
+
+#elif defined(__linux__)
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Read the first character of a sysfs attribute
+static bool ReadFlag(std::string const& _path, char* o_flag)
+{
+	FILE* file = fopen(_path.c_str(), "r");
+	if (file == NULL)
+	{
+		return false;
+	}
+	int c = fgetc(file);
+	fclose(file);
+	if (c == EOF)
+	{
+		return false;
+	}
+	*o_flag = (char)c;
+	return true;
+}
+
+MediaKind DetectMedia
+(
+	std::string const& _path
+)
+{
+	struct stat info;
+	if (stat(_path.c_str(), &info) != 0 || major(info.st_dev) == 0)
+	{
+		// Major 0 is anonymous: tmpfs, overlays, network file systems
+		return MediaUnknown;
+	}
+
+	char device[64];
+	snprintf(device, sizeof(device), "/sys/dev/block/%u:%u", major(info.st_dev), minor(info.st_dev));
+
+	// A partition has no queue of its own, its disk's is one directory up
+	char flag;
+	if (!ReadFlag(std::string(device) + "/queue/rotational", &flag) && !ReadFlag(std::string(device) + "/../queue/rotational", &flag))
+	{
+		return MediaUnknown;
+	}
+	return (flag == '1') ? MediaRotational : MediaSolidState;
+}
+
+bool QueryExtents
+(
+	std::string const& _path,
+	std::vector<FileExtent>* o_extents
+)
+{
+	o_extents->clear();
+
+	int fd = open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+	{
+		return false;
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	static const unsigned BatchSize = 64;
+	union
+	{
+		struct fiemap m_map;
+		unsigned char m_space[sizeof(struct fiemap) + BatchSize * sizeof(struct fiemap_extent)];
+	} request;
+
+	bool ok = true;
+	bool last = false;
+	uint64 start = 0;
+	while (!last)
+	{
+		memset(&request, 0, sizeof(request));
+		request.m_map.fm_start = start;
+		request.m_map.fm_length = ~0ull;
+		request.m_map.fm_extent_count = BatchSize;
+		if (ioctl(fd, FS_IOC_FIEMAP, &request.m_map) != 0)
+		{
+			ok = false;
+			break;
+		}
+		if (request.m_map.fm_mapped_extents == 0)
+		{
+			break;
+		}
+
+		for (unsigned i = 0; i < request.m_map.fm_mapped_extents; ++i)
+		{
+			struct fiemap_extent const& extent = request.m_map.fm_extents[i];
+			start = extent.fe_logical + extent.fe_length;
+			last = (extent.fe_flags & FIEMAP_EXTENT_LAST) != 0;
+			if (extent.fe_logical >= (uint64)info.st_size)
+			{
+				// preallocated past the end, nothing there to read
+				continue;
+			}
+			// Not yet allocated, or inline in the inode: no meaningful address
+			if (extent.fe_flags & (FIEMAP_EXTENT_UNKNOWN | FIEMAP_EXTENT_DELALLOC | FIEMAP_EXTENT_DATA_INLINE | FIEMAP_EXTENT_NOT_ALIGNED))
+			{
+				ok = false;
+			}
+			AddExtent(o_extents, extent.fe_logical, extent.fe_physical, extent.fe_length);
+		}
+	}
+	close(fd);
+	ClipExtents(o_extents, (uint64)info.st_size);
+
+	return ok && !o_extents->empty();
+}
+
+#else
+
+MediaKind DetectMedia
+(
+	std::string const& /*_path*/
+)
+{
+	return MediaUnknown;
+}
+
+bool QueryExtents
+(
+	std::string const& /*_path*/,
+	std::vector<FileExtent>* o_extents
+)
+{
+	o_extents->clear();
+	return false;
+}
+
+#endif
@@ -0,0 +1,61 @@
+/*----------------------------------------------------------------------------
+ *  FILE: DiskLayout.h
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		Where a file's data physically lies, and what sort of device it lies
+ *		on. On a spinning disk, reading in physical order saves a seek per
+ *		file; on an SSD it doesn't matter and parallel reads win.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef _DISKLAYOUT_H
+#define _DISKLAYOUT_H
+
+#include "../WatchDog/sha1.h"
+#include <string>
+#include <vector>
+
+enum MediaKind
+{
+	MediaUnknown,
+	MediaRotational,
+	MediaSolidState,
+};
+
+/// How the native hashers order their reads
+enum ReadOrder
+{
+	OrderAutomatic,		// physical on a rotational device, otherwise parallel
+	OrderParallel,
+	OrderPhysical,
+};
+
+struct FileExtent
+{
+	uint64 m_logical;		// offset in the file
+	uint64 m_physical;		// offset on the volume
+	uint64 m_length;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief What the volume holding _path is on
+/// @return MediaUnknown if the system won't say, e.g. for network shares or
+///         stacked block devices
+MediaKind DetectMedia(std::string const& _path);
+
+char const* MediaName(MediaKind _media);
+
+bool ParseReadOrder(std::string const& _name, ReadOrder* o_order);
+
+char const* ReadOrderName(ReadOrder _order);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The physical extents of _path in logical order, with physically
+///        contiguous neighbours merged. Holes are not listed.
+/// @return false if the file system can't say, e.g. data held in the MFT
+///         record, delayed allocation, or no support for the query at all
+bool QueryExtents(std::string const& _path, std::vector<FileExtent>* o_extents);
+
+#endif
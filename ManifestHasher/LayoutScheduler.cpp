@@ -0,0 +1,247 @@
+/*----------------------------------------------------------------------------
+ *  FILE: LayoutScheduler.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "LayoutScheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <set>
+#include <stdio.h>
+
+// Files without extents sort after everything else
+static const uint64 UnknownPhysical = ~0ull;
+
+static bool SeekTo(FILE* _file, uint64 _offset)
+{
+#ifdef _WIN32
+	return _fseeki64(_file, (long long)_offset, SEEK_SET) == 0;
+#else
+	return fseeko(_file, (off_t)_offset, SEEK_SET) == 0;
+#endif
+}
+
+LayoutScheduler::LayoutScheduler
+(
+	Options const& _options
+):
+	m_options(_options),
+	m_located(0),
+	m_backtracks(0),
+	m_backtracksUnplanned(0)
+{
+	if (m_options.m_bufferSize < 4096)
+	{
+		m_options.m_bufferSize = 4096;
+	}
+	if (m_options.m_openFiles == 0)
+	{
+		m_options.m_openFiles = 1;
+	}
+}
+
+void LayoutScheduler::Plan
+(
+	std::vector<ManifestFile*> const& _files
+)
+{
+	m_files = _files;
+	m_segments.clear();
+	m_located = 0;
+	m_backtracks = 0;
+	m_backtracksUnplanned = 0;
+
+	// Each file's segments, in file order
+	std::vector<std::vector<Segment> > perFile(m_files.size());
+	std::vector<FileExtent> extents;
+	uint64 head = 0;
+	for (size_t i = 0; i < m_files.size(); ++i)
+	{
+		std::vector<Segment>& segments = perFile[i];
+		if (QueryExtents(m_files[i]->m_fullPath, &extents))
+		{
+			++m_located;
+			uint64 offset = 0;
+			for (size_t e = 0; e < extents.size(); ++e)
+			{
+				// A hole before an extent is read along with it
+				Segment segment;
+				segment.m_file = i;
+				segment.m_offset = offset;
+				segment.m_length = extents[e].m_logical + extents[e].m_length - offset;
+				segment.m_physical = extents[e].m_physical;
+				segment.m_last = false;
+				segments.push_back(segment);
+				offset += segment.m_length;
+
+				if (extents[e].m_physical < head)
+				{
+					++m_backtracksUnplanned;
+				}
+				head = extents[e].m_physical + extents[e].m_length;
+			}
+		}
+		else
+		{
+			Segment segment;
+			segment.m_file = i;
+			segment.m_offset = 0;
+			segment.m_length = 0;
+			segment.m_physical = UnknownPhysical;
+			segment.m_last = true;
+			segments.push_back(segment);
+		}
+		segments.back().m_last = true;
+	}
+
+	// Elevator: take the nearest segment at or after the head, wrapping to
+	// the lowest when there's none. Only each file's next segment is a
+	// candidate, which keeps every file in order.
+	std::set<std::pair<uint64, size_t> > candidates;
+	std::vector<size_t> next(m_files.size(), 0);
+	for (size_t i = 0; i < m_files.size(); ++i)
+	{
+		candidates.insert(std::make_pair(perFile[i][0].m_physical, i));
+	}
+
+	head = 0;
+	while (!candidates.empty())
+	{
+		std::set<std::pair<uint64, size_t> >::iterator it = candidates.lower_bound(std::make_pair(head, (size_t)0));
+		if (it == candidates.end())
+		{
+			it = candidates.begin();
+		}
+		size_t file = it->second;
+		candidates.erase(it);
+
+		Segment const& segment = perFile[file][next[file]];
+		if (segment.m_physical != UnknownPhysical)
+		{
+			if (segment.m_physical < head)
+			{
+				++m_backtracks;
+			}
+			head = segment.m_physical + segment.m_length;
+		}
+		m_segments.push_back(segment);
+
+		if (++next[file] < perFile[file].size())
+		{
+			candidates.insert(std::make_pair(perFile[file][next[file]].m_physical, file));
+		}
+	}
+}
+
+bool LayoutScheduler::Run
+(
+	TreeHasher::FileCallback _callback,
+	void* _context
+)
+{
+	m_errors.clear();
+
+	std::vector<unsigned char> buffer(m_options.m_bufferSize);
+	std::vector<fSHA1> shas(m_files.size());
+	std::vector<FILE*> handles(m_files.size(), (FILE*)NULL);
+	std::vector<uint64> positions(m_files.size(), 0);
+	std::vector<bool> failed(m_files.size(), false);
+	std::vector<size_t> open;		// oldest first
+
+	for (size_t s = 0; s < m_segments.size(); ++s)
+	{
+		Segment const& segment = m_segments[s];
+		size_t index = segment.m_file;
+		ManifestFile* file = m_files[index];
+		if (failed[index])
+		{
+			continue;
+		}
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		if (segment.m_offset == 0)
+		{
+			shas[index].StreamStart();
+			file->m_seconds = 0.0;
+		}
+
+		FILE*& handle = handles[index];
+		if (handle == NULL)
+		{
+			if (open.size() >= m_options.m_openFiles)
+			{
+				fclose(handles[open.front()]);
+				handles[open.front()] = NULL;
+				open.erase(open.begin());
+			}
+			handle = fopen(file->m_fullPath.c_str(), "rb");
+			if (handle == NULL)
+			{
+				m_errors.push_back("Unable to open " + file->m_fullPath);
+				failed[index] = true;
+				_callback(*file, _context);
+				continue;
+			}
+			// We read in large blocks already, stdio buffering would only add a copy
+			setvbuf(handle, NULL, _IONBF, 0);
+			positions[index] = 0;
+			open.push_back(index);
+		}
+
+		bool ok = (positions[index] == segment.m_offset) || SeekTo(handle, segment.m_offset);
+		bool shortRead = false;
+		uint64 remaining = segment.m_length;
+		uint64 position = segment.m_offset;
+		while (ok && (segment.m_last || remaining > 0))
+		{
+			size_t wanted = buffer.size();
+			if (!segment.m_last && remaining < wanted)
+			{
+				wanted = (size_t)remaining;
+			}
+			size_t dataread = fread(&buffer[0], 1, wanted, handle);
+			if (dataread == 0)
+			{
+				ok = !ferror(handle);
+				shortRead = !segment.m_last;
+				break;
+			}
+			shas[index].Update(&buffer[0], dataread);
+			position += dataread;
+			remaining -= (dataread < remaining) ? dataread : remaining;
+		}
+		positions[index] = position;
+		file->m_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		if (!ok || shortRead)
+		{
+			m_errors.push_back((ok ? "Shrank while being read: " : "Unable to read ") + file->m_fullPath);
+			failed[index] = true;
+		}
+		else if (segment.m_last)
+		{
+			shas[index].Finish();
+			file->m_digest = shas[index].Digest();
+			file->m_size = shas[index].m_totalSize;
+			file->m_hashed = true;
+		}
+
+		if (failed[index] || segment.m_last)
+		{
+			fclose(handle);
+			handle = NULL;
+			open.erase(std::find(open.begin(), open.end(), index));
+			_callback(*file, _context);
+		}
+	}
+
+	// Only a file that failed part way can still be open
+	for (size_t i = 0; i < open.size(); ++i)
+	{
+		fclose(handles[open[i]]);
+	}
+	return m_errors.empty();
+}
@@ -0,0 +1,98 @@
+/*----------------------------------------------------------------------------
+ *  FILE: LayoutScheduler.h
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		Reads and hashes a set of files in the order their data lies on the
+ *		disk rather than the order they were listed in. Each file is cut into
+ *		segments at its extent boundaries and the segments of all the files
+ *		are read in elevator order: the next read is always the nearest one
+ *		ahead of the last, wrapping round when nothing is ahead. A file's own
+ *		segments still go in file order, as SHA-1 needs, so a fragmented file
+ *		is read in several sweeps with other files read in between.
+ *
+ *		Reads are from one thread, which is all a single spinning disk can
+ *		serve without seeking. Files whose extents can't be found go last,
+ *		in the order given.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef _LAYOUTSCHEDULER_H
+#define _LAYOUTSCHEDULER_H
+
+#include "DiskLayout.h"
+#include "TreeHasher.h"
+
+class LayoutScheduler
+{
+public:
+	struct Options
+	{
+		unsigned m_bufferSize;		// bytes per read
+		unsigned m_openFiles;		// handles kept open for files read in several sweeps
+
+		Options() :
+			m_bufferSize(1024 * 1024),
+			m_openFiles(64)
+		{
+		}
+	};
+
+	struct Segment
+	{
+		size_t m_file;				// index into the files planned
+		uint64 m_offset;
+		uint64 m_length;			// the last segment of a file runs to its end whatever this says
+		uint64 m_physical;
+		bool m_last;
+	};
+
+	explicit LayoutScheduler(Options const& _options);
+
+	/// Find the extents of every file and work out the order to read them in
+	void Plan(std::vector<ManifestFile*> const& _files);
+
+	/// Read and hash the planned files, filling in m_size, m_digest,
+	/// m_seconds and m_hashed, and calling _callback as each finishes.
+	/// Returns false if anything couldn't be read; Errors() says what.
+	bool Run(TreeHasher::FileCallback _callback, void* _context);
+
+	std::vector<Segment> const& Segments() const
+	{
+		return m_segments;
+	}
+
+	/// Files whose extents were found
+	size_t Located() const
+	{
+		return m_located;
+	}
+
+	/// Times the planned order moves backwards on the disk, against what the
+	/// order given would have needed
+	size_t Backtracks() const
+	{
+		return m_backtracks;
+	}
+	size_t BacktracksUnplanned() const
+	{
+		return m_backtracksUnplanned;
+	}
+
+	std::vector<std::string> const& Errors() const
+	{
+		return m_errors;
+	}
+
+private:
+	Options m_options;
+	std::vector<ManifestFile*> m_files;
+	std::vector<Segment> m_segments;
+	size_t m_located;
+	size_t m_backtracks;
+	size_t m_backtracksUnplanned;
+	std::vector<std::string> m_errors;
+};
+
+#endif
@@ -0,0 +1,101 @@
+/*----------------------------------------------------------------------------
+ *  FILE: ManifestWriter.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "ManifestWriter.h"
+#include "../WatchDog/AtomicFile.h"
+#include <algorithm>
+#include <stdio.h>
+
+ManifestWriter::ManifestWriter
+(
+	std::string const& _title,
+	std::string const& _version,
+	bool _slash
+):
+	m_title(_title),
+	m_version(_version),
+	m_slash(_slash)
+{
+}
+
+void ManifestWriter::Add
+(
+	ManifestFile const& _file
+)
+{
+	Entry entry;
+	entry.m_path = _file.m_path;
+	if (m_slash)
+	{
+		std::replace(entry.m_path.begin(), entry.m_path.end(), '\\', '/');
+	}
+	entry.m_hash = _file.m_digest.ToString(true);
+	entry.m_size = _file.m_size;
+	m_entries.push_back(entry);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Append _value with the characters XmlWriter escapes in text and
+///        attribute values replaced by entities
+void ManifestWriter::AppendEscaped
+(
+	std::string* o_text,
+	std::string const& _value,
+	bool _attribute
+)
+{
+	for (size_t i = 0; i < _value.size(); ++i)
+	{
+		char c = _value[i];
+		switch (c)
+		{
+		case '&':	*o_text += "&amp;";		break;
+		case '<':	*o_text += "&lt;";		break;
+		case '>':	*o_text += "&gt;";		break;
+		case '"':	*o_text += _attribute ? "&quot;" : "\"";	break;
+		default:	*o_text += c;			break;
+		}
+	}
+}
+
+std::string ManifestWriter::Format() const
+{
+	std::vector<Entry> entries = m_entries;
+	std::sort(entries.begin(), entries.end());
+
+	std::string text = "\xEF\xBB\xBF<?xml version=\"1.0\" encoding=\"utf-8\"?>";
+	text += "<Manifest title=\"";
+	AppendEscaped(&text, m_title, true);
+	text += "\" version=\"";
+	AppendEscaped(&text, m_version, true);
+	text += "\">";
+
+	char size[32];
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		text += "<File><Path>";
+		AppendEscaped(&text, entries[i].m_path, false);
+		text += "</Path><Hash>";
+		text += entries[i].m_hash;
+		text += "</Hash><Size>";
+		sprintf(size, "%llu", entries[i].m_size);
+		text += size;
+		text += "</Size></File>";
+	}
+	text += "</Manifest>";
+	return text;
+}
+
+bool ManifestWriter::Save
+(
+	std::string const& _path
+) const
+{
+	std::string text = Format();
+	return AtomicWriteFile(_path, text.data(), text.size());
+}
@@ -0,0 +1,61 @@
+/*----------------------------------------------------------------------------
+ *  FILE: ManifestWriter.h
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		Writes the manifest XML in the form ManifestTool's
+ *		ManifestFileBuilder.SaveFile produces:
+ *
+ *		<?xml version="1.0" encoding="utf-8"?><Manifest title=".." version="..">
+ *		<File><Path>..</Path><Hash>..</Hash><Size>..</Size></File>...</Manifest>
+ *
+ *		on a single line with a UTF-8 byte order mark, as XmlWriter does by
+ *		default. Hashes are lower case hex. Files are written sorted by path so
+ *		the output doesn't depend on the order they were found or hashed in.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef _MANIFESTWRITER_H
+#define _MANIFESTWRITER_H
+
+#include "TreeHasher.h"
+#include <string>
+#include <vector>
+
+class ManifestWriter
+{
+public:
+	ManifestWriter(std::string const& _title, std::string const& _version, bool _slash);
+
+	void Add(ManifestFile const& _file);
+
+	/// The complete document
+	std::string Format() const;
+
+	/// Format() to _path, replacing any existing file atomically
+	bool Save(std::string const& _path) const;
+
+private:
+	struct Entry
+	{
+		std::string m_path;
+		std::string m_hash;
+		uint64 m_size;
+
+		bool operator<(Entry const& _other) const
+		{
+			return m_path < _other.m_path;
+		}
+	};
+
+	std::string m_title;
+	std::string m_version;
+	bool m_slash;
+	std::vector<Entry> m_entries;
+
+	/// _value as XML text, quotes escaped too if it is going in an attribute
+	static void AppendEscaped(std::string* o_text, std::string const& _value, bool _attribute);
+};
+
+#endif
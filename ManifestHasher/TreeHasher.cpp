@@ -0,0 +1,283 @@
+/*----------------------------------------------------------------------------
+ *  FILE: TreeHasher.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "TreeHasher.h"
+#include "LayoutScheduler.h"
+#include <chrono>
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef _WIN32
+static const char NativeSeparator = '\\';
+#else
+static const char NativeSeparator = '/';
+#endif
+
+TreeHasher::TreeHasher
+(
+	Options const& _options,
+	FileCallback _callback,
+	void* _context
+):
+	m_options(_options),
+	m_callback(_callback),
+	m_context(_context),
+	m_media(MediaUnknown),
+	m_order(OrderParallel),
+	m_pool(NULL),
+	m_throttle(NULL)
+{
+}
+
+bool TreeHasher::Run
+(
+	std::string const& _root
+)
+{
+	unsigned threads = m_options.m_threads;
+	if (threads == 0)
+	{
+		threads = std::thread::hardware_concurrency();
+	}
+
+	WorkStealingPool pool(threads);
+
+	std::string root = _root;
+	while (root.size() > 1 && (root[root.size() - 1] == '\\' || root[root.size() - 1] == '/'))
+	{
+		root.erase(root.size() - 1);
+	}
+
+	m_media = DetectMedia(root);
+	m_order = m_options.m_order;
+	unsigned ioConcurrency = m_options.m_ioConcurrency;
+	if (m_order == OrderAutomatic)
+	{
+		m_order = (m_media == MediaRotational) ? OrderPhysical : OrderParallel;
+		// Solid state serves reads in parallel, as many as there are threads to issue them
+		if (m_media == MediaSolidState && ioConcurrency < pool.ThreadCount())
+		{
+			ioConcurrency = pool.ThreadCount();
+		}
+	}
+
+	IoThrottle throttle(ioConcurrency);
+	m_pool = &pool;
+	m_throttle = &throttle;
+	m_buffers.assign(pool.ThreadCount(), std::vector<unsigned char>());
+
+	pool.Submit([this, root]() { ListDirectory(root, std::string()); });
+	pool.Wait();
+
+	if (m_order == OrderPhysical)
+	{
+		std::vector<ManifestFile*> files;
+		for (size_t i = 0; i < m_files.size(); ++i)
+		{
+			files.push_back(&m_files[i]);
+		}
+
+		LayoutScheduler::Options options;
+		options.m_bufferSize = m_options.m_bufferSize;
+		LayoutScheduler scheduler(options);
+		scheduler.Plan(files);
+		scheduler.Run(m_callback, m_context);
+		m_errors.insert(m_errors.end(), scheduler.Errors().begin(), scheduler.Errors().end());
+	}
+
+	m_pool = NULL;
+	m_throttle = NULL;
+	m_buffers.clear();
+	return m_errors.empty();
+}
+
+void TreeHasher::AddError
+(
+	std::string const& _error
+)
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	m_errors.push_back(_error);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief List one directory, queueing a task for each file and for each
+///        subdirectory
+/// @param _fullPath Path of the directory as it can be opened
+/// @param _relativePath Path below the root in manifest form, empty for the root
+void TreeHasher::ListDirectory
+(
+	std::string const& _fullPath,
+	std::string const& _relativePath
+)
+{
+	std::vector<std::string> directories;
+	std::vector<ManifestFile> files;
+
+#ifdef _WIN32
+	WIN32_FIND_DATAA data;
+	HANDLE find = FindFirstFileA((_fullPath + "\\*").c_str(), &data);
+	if (find == INVALID_HANDLE_VALUE)
+	{
+		AddError("Unable to list " + _fullPath);
+		return;
+	}
+	do
+	{
+		std::string name = data.cFileName;
+		if (name == "." || name == "..")
+		{
+			continue;
+		}
+		if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+		{
+			// Don't follow junctions, they can loop back on themselves
+			if ((data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) == 0)
+			{
+				directories.push_back(name);
+			}
+			continue;
+		}
+		ManifestFile file;
+		file.m_path = name;
+		file.m_size = ((uint64)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+		files.push_back(file);
+	}
+	while (FindNextFileA(find, &data));
+	FindClose(find);
+#else
+	DIR* dir = opendir(_fullPath.c_str());
+	if (dir == NULL)
+	{
+		AddError("Unable to list " + _fullPath);
+		return;
+	}
+	while (struct dirent* entry = readdir(dir))
+	{
+		std::string name = entry->d_name;
+		if (name == "." || name == "..")
+		{
+			continue;
+		}
+		std::string full = _fullPath + NativeSeparator + name;
+		struct stat info;
+		if (lstat(full.c_str(), &info) != 0)
+		{
+			AddError("Unable to query " + full);
+			continue;
+		}
+		if (S_ISDIR(info.st_mode))
+		{
+			directories.push_back(name);
+			continue;
+		}
+		// Symbolic links to files are hashed as the file, as on Windows
+		if (S_ISLNK(info.st_mode) && (stat(full.c_str(), &info) != 0 || !S_ISREG(info.st_mode)))
+		{
+			continue;
+		}
+		if (!S_ISREG(info.st_mode))
+		{
+			continue;
+		}
+		ManifestFile file;
+		file.m_path = name;
+		file.m_size = (uint64)info.st_size;
+		files.push_back(file);
+	}
+	closedir(dir);
+#endif
+
+	std::string prefix = _relativePath.empty() ? std::string() : _relativePath + "\\";
+
+	for (size_t i = 0; i < directories.size(); ++i)
+	{
+		std::string full = _fullPath + NativeSeparator + directories[i];
+		std::string relative = prefix + directories[i];
+		m_pool->Submit([this, full, relative]() { ListDirectory(full, relative); });
+	}
+
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		ManifestFile* file;
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			m_files.push_back(files[i]);
+			file = &m_files.back();
+		}
+		file->m_fullPath = _fullPath + NativeSeparator + file->m_path;
+		file->m_path = prefix + file->m_path;
+		if (m_order != OrderPhysical)
+		{
+			m_pool->Submit([this, file]() { HashFile(file); });
+		}
+	}
+}
+
+void TreeHasher::HashFile
+(
+	ManifestFile* _file
+)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	std::vector<unsigned char>& buffer = m_buffers[m_pool->CurrentWorker()];
+	if (buffer.empty())
+	{
+		buffer.resize(m_options.m_bufferSize);
+	}
+
+	FILE* file = fopen(_file->m_fullPath.c_str(), "rb");
+	if (file == NULL)
+	{
+		AddError("Unable to open " + _file->m_fullPath);
+		m_callback(*_file, m_context);
+		return;
+	}
+	// We read in large blocks already, stdio buffering would only add a copy
+	setvbuf(file, NULL, _IONBF, 0);
+
+	fSHA1 sha;
+	sha.StreamStart();
+	bool ok = true;
+	while (1)
+	{
+		size_t dataread;
+		{
+			IoThrottle::Scope io(*m_throttle);
+			dataread = fread(&buffer[0], 1, buffer.size(), file);
+		}
+		if (dataread == 0)
+		{
+			ok = !ferror(file);
+			break;
+		}
+		sha.Update(&buffer[0], dataread);
+	}
+	fclose(file);
+
+	if (ok)
+	{
+		sha.Finish();
+		_file->m_digest = sha.Digest();
+		_file->m_size = sha.m_totalSize;
+		_file->m_hashed = true;
+	}
+	else
+	{
+		AddError("Unable to read " + _file->m_fullPath);
+	}
+	_file->m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	m_callback(*_file, m_context);
+}
@@ -0,0 +1,116 @@
+/*----------------------------------------------------------------------------
+ *  FILE: TreeHasher.h
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		Walks a directory tree and hashes every file in it on a
+ *		WorkStealingPool. Directories are listed in parallel, each file is a
+ *		task of its own, and reads go through an IoThrottle so the number of
+ *		outstanding reads stays independent of the number of hashing threads.
+ *
+ *		On a rotational disk the tree is listed first and the files are then
+ *		read in physical order by a LayoutScheduler instead; on a solid state
+ *		one the throttle is opened up to the number of threads.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef _TREEHASHER_H
+#define _TREEHASHER_H
+
+#include "../WatchDog/sha1.h"
+#include "DiskLayout.h"
+#include "WorkStealingPool.h"
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct ManifestFile
+{
+	std::string m_path;			// relative to the root, '\\' separated as ManifestTool writes it
+	std::string m_fullPath;
+	uint64 m_size;
+	Sha1Digest m_digest;
+	double m_seconds;			// time spent reading and hashing
+	bool m_hashed;
+
+	ManifestFile() : m_size(0), m_seconds(0.0), m_hashed(false) {}
+
+	double MegabytesPerSecond() const
+	{
+		return (m_seconds > 0.0) ? (double)m_size / (1024.0 * 1024.0) / m_seconds : 0.0;
+	}
+};
+
+class TreeHasher
+{
+public:
+	struct Options
+	{
+		unsigned m_threads;			// hashing threads, 0 for one per CPU
+		unsigned m_ioConcurrency;	// reads in flight at once
+		unsigned m_bufferSize;		// bytes per read
+		ReadOrder m_order;
+
+		Options() :
+			m_threads(0),
+			m_ioConcurrency(4),
+			m_bufferSize(1024 * 1024),
+			m_order(OrderAutomatic)
+		{
+		}
+	};
+
+	/// Called as each file finishes, successfully or not, on a worker thread
+	/// or, reading in physical order, on the thread calling Run()
+	typedef void (*FileCallback)(ManifestFile const& _file, void* _context);
+
+	TreeHasher(Options const& _options, FileCallback _callback, void* _context);
+
+	/// Hash everything below _root. Returns false if anything couldn't be
+	/// listed or read; Errors() says what.
+	bool Run(std::string const& _root);
+
+	/// Every file found, in no particular order
+	std::deque<ManifestFile> const& Files() const
+	{
+		return m_files;
+	}
+
+	std::vector<std::string> const& Errors() const
+	{
+		return m_errors;
+	}
+
+	/// What the last Run() found the root to be on, and the order it read in
+	MediaKind Media() const
+	{
+		return m_media;
+	}
+	ReadOrder Order() const
+	{
+		return m_order;
+	}
+
+private:
+	Options m_options;
+	FileCallback m_callback;
+	void* m_context;
+	MediaKind m_media;
+	ReadOrder m_order;
+
+	WorkStealingPool* m_pool;
+	IoThrottle* m_throttle;
+	std::vector<std::vector<unsigned char> > m_buffers;	// one per worker
+
+	std::mutex m_lock;
+	std::deque<ManifestFile> m_files;	// deque so entries stay put as it grows
+	std::vector<std::string> m_errors;
+
+	void ListDirectory(std::string const& _fullPath, std::string const& _relativePath);
+	void HashFile(ManifestFile* _file);
+	void AddError(std::string const& _error);
+};
+
+#endif
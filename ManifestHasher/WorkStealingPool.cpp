@@ -0,0 +1,163 @@
+/*----------------------------------------------------------------------------
+ *  FILE: WorkStealingPool.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "WorkStealingPool.h"
+
+// Which pool, and which worker of it, the current thread is
+static thread_local WorkStealingPool const* s_currentPool = NULL;
+static thread_local unsigned s_currentWorker = 0;
+
+WorkStealingPool::WorkStealingPool
+(
+	unsigned _threads
+):
+	m_queued(0),
+	m_pending(0),
+	m_nextQueue(0),
+	m_stop(false)
+{
+	if (_threads == 0)
+	{
+		_threads = 1;
+	}
+	for (unsigned i = 0; i < _threads; ++i)
+	{
+		m_queues.push_back(std::unique_ptr<Queue>(new Queue));
+	}
+	for (unsigned i = 0; i < _threads; ++i)
+	{
+		m_threads.push_back(std::thread(&WorkStealingPool::WorkerThread, this, i));
+	}
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+	Wait();
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+	for (size_t i = 0; i < m_threads.size(); ++i)
+	{
+		m_threads[i].join();
+	}
+}
+
+int WorkStealingPool::CurrentWorker() const
+{
+	return (s_currentPool == this) ? (int)s_currentWorker : -1;
+}
+
+void WorkStealingPool::Submit
+(
+	Task _task
+)
+{
+	int worker = CurrentWorker();
+	unsigned target;
+	{
+		// Counted before it is queued so m_queued never drops below zero; a
+		// worker woken early just finds nothing and looks again
+		std::lock_guard<std::mutex> lock(m_lock);
+		++m_pending;
+		++m_queued;
+		target = (worker >= 0) ? (unsigned)worker : (m_nextQueue++ % (unsigned)m_queues.size());
+	}
+
+	Queue& queue = *m_queues[target];
+	{
+		std::lock_guard<std::mutex> lock(queue.m_lock);
+		queue.m_tasks.push_back(_task);
+	}
+	m_wake.notify_one();
+}
+
+void WorkStealingPool::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_lock);
+	while (m_pending > 0)
+	{
+		m_idle.wait(lock);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Take the newest task from our own queue, or the oldest from
+///        anybody else's
+bool WorkStealingPool::TryPop
+(
+	unsigned _worker,
+	Task* o_task
+)
+{
+	{
+		Queue& own = *m_queues[_worker];
+		std::lock_guard<std::mutex> lock(own.m_lock);
+		if (!own.m_tasks.empty())
+		{
+			*o_task = own.m_tasks.back();
+			own.m_tasks.pop_back();
+			return true;
+		}
+	}
+
+	unsigned count = (unsigned)m_queues.size();
+	for (unsigned i = 1; i < count; ++i)
+	{
+		Queue& victim = *m_queues[(_worker + i) % count];
+		std::lock_guard<std::mutex> lock(victim.m_lock);
+		if (!victim.m_tasks.empty())
+		{
+			*o_task = victim.m_tasks.front();
+			victim.m_tasks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+void WorkStealingPool::WorkerThread
+(
+	unsigned _worker
+)
+{
+	s_currentPool = this;
+	s_currentWorker = _worker;
+
+	while (1)
+	{
+		Task task;
+		if (TryPop(_worker, &task))
+		{
+			--m_queued;
+			task();
+
+			bool idle;
+			{
+				std::lock_guard<std::mutex> lock(m_lock);
+				idle = (--m_pending == 0);
+			}
+			if (idle)
+			{
+				m_idle.notify_all();
+			}
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_lock);
+		while (m_queued == 0 && !m_stop)
+		{
+			m_wake.wait(lock);
+		}
+		if (m_stop && m_queued == 0)
+		{
+			break;
+		}
+	}
+}
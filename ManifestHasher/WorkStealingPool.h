@@ -0,0 +1,121 @@
+/*----------------------------------------------------------------------------
+ *  FILE: WorkStealingPool.h
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		Fixed set of worker threads, each with its own task queue. A worker
+ *		runs the newest task from its own queue and, when that is empty,
+ *		steals the oldest task from another worker. Tasks may submit further
+ *		tasks, which go to the submitting worker's queue, so a directory walk
+ *		spreads itself across the pool as it discovers work.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef _WORKSTEALINGPOOL_H
+#define _WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool
+{
+public:
+	typedef std::function<void()> Task;
+
+	explicit WorkStealingPool(unsigned _threads);
+
+	/// Waits for outstanding tasks, then stops the workers
+	~WorkStealingPool();
+
+	void Submit(Task _task);
+
+	/// Block until every task, including any submitted by other tasks, has run
+	void Wait();
+
+	unsigned ThreadCount() const
+	{
+		return (unsigned)m_threads.size();
+	}
+
+	/// Index of the calling worker thread in [0, ThreadCount()), or -1 if the
+	/// caller isn't one of this pool's workers
+	int CurrentWorker() const;
+
+private:
+	struct Queue
+	{
+		std::mutex m_lock;
+		std::deque<Task> m_tasks;
+	};
+
+	std::vector<std::unique_ptr<Queue> > m_queues;
+	std::vector<std::thread> m_threads;
+
+	std::mutex m_lock;
+	std::condition_variable m_wake;		// tasks queued, or stopping
+	std::condition_variable m_idle;		// m_pending reached zero
+	std::atomic<size_t> m_queued;		// in a queue, not yet picked up
+	size_t m_pending;					// submitted and not yet finished, guarded by m_lock
+	unsigned m_nextQueue;				// round robin for submissions from outside the pool
+	bool m_stop;
+
+	bool TryPop(unsigned _worker, Task* o_task);
+	void WorkerThread(unsigned _worker);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Counting semaphore limiting how many threads do I/O at once, so a pool
+/// sized for the CPU doesn't swamp a disk that works best at a low queue depth.
+class IoThrottle
+{
+public:
+	explicit IoThrottle(unsigned _limit) :
+		m_available(_limit > 0 ? _limit : 1)
+	{
+	}
+
+	void Acquire()
+	{
+		std::unique_lock<std::mutex> lock(m_lock);
+		while (m_available == 0)
+		{
+			m_released.wait(lock);
+		}
+		--m_available;
+	}
+
+	void Release()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			++m_available;
+		}
+		m_released.notify_one();
+	}
+
+	/// Holds the throttle for the lifetime of the object
+	class Scope
+	{
+	public:
+		explicit Scope(IoThrottle& _throttle) : m_throttle(_throttle) { m_throttle.Acquire(); }
+		~Scope() { m_throttle.Release(); }
+	private:
+		IoThrottle& m_throttle;
+		Scope(Scope const&);
+		Scope& operator=(Scope const&);
+	};
+
+private:
+	std::mutex m_lock;
+	std::condition_variable m_released;
+	unsigned m_available;
+};
+
+#endif
@@ -0,0 +1,449 @@
+/*----------------------------------------------------------------------------
+ *  FILE: main.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		ManifestHasher: builds a product manifest for an install tree, the
+ *		same document ManifestTool's import writes, but hashing files in
+ *		parallel.
+ *
+ *		ManifestHasher /Root <dir> /Output <file> [/Title <title>]
+ *			[/Version <version>] [/Slash true] [/Threads <n>]
+ *			[/IoThreads <n>] [/BufferSize <KB>] [/Quiet true]
+ *			[/Order auto|parallel|physical]
+ *
+ *		By default files are read in physical order when the root is on a
+ *		rotational disk, see LayoutScheduler.h, and in parallel otherwise.
+ *
+ *		Chunked hashing of a single large file, see ChunkHasher.h:
+ *
+ *		ManifestHasher /ChunkFile <file> /Output <chunk list>
+ *			[/ChunkSize <MB>] [/WholeFile false] [/Threads <n>] [/IoThreads <n>]
+ *		ManifestHasher /ChunkFile <file> /VerifyChunks <chunk list>
+ *			[/Threads <n>] [/IoThreads <n>]
+ *
+ *		The whole-file digest, as a manifest has it, is serial however many
+ *		threads there are; /WholeFile false leaves it out. Verifying prints
+ *		the byte ranges that differ and exits with 3 if there are any.
+ *
+ *		Hashing a list of files, one path per line, see BatchHasher.h:
+ *
+ *		ManifestHasher /FileList <list> [/Root <dir>] [/Output <file>]
+ *			[/Engine auto|uring|pool] [/QueueDepth <n>] [/Threads <n>]
+ *			[/BufferSize <KB>] [/Quiet true] [/Order auto|parallel|physical]
+ *
+ *		Relative paths in the list are taken from /Root when it is given. A
+ *		manifest is written only if there is an /Output.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "BatchHasher.h"
+#include "ChunkHasher.h"
+#include "TreeHasher.h"
+#include "ManifestWriter.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <stdlib.h>
+#include <unordered_map>
+
+struct Progress
+{
+	std::mutex m_lock;
+	bool m_quiet;
+	uint64 m_files;
+	uint64 m_bytes;
+};
+
+static void OnFileHashed(ManifestFile const& _file, void* _context)
+{
+	Progress* progress = (Progress*)_context;
+	std::lock_guard<std::mutex> lock(progress->m_lock);
+	if (!_file.m_hashed)
+	{
+		return;
+	}
+	++progress->m_files;
+	progress->m_bytes += _file.m_size;
+	if (!progress->m_quiet)
+	{
+		std::cout << _file.m_digest.ToString(true) << ' ' << _file.m_size << " bytes "
+			<< _file.m_seconds << "s " << _file.MegabytesPerSecond() << " MB/s " << _file.m_path << "\n";
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief ManifestTool refuses two files with the same hash but different
+///        sizes, check the same here
+/// @return false if there are any such pairs
+static bool CheckCollisions(std::deque<ManifestFile> const& _files)
+{
+	bool ok = true;
+	std::unordered_map<Sha1Digest, ManifestFile const*> seen;
+	for (size_t i = 0; i < _files.size(); ++i)
+	{
+		ManifestFile const& file = _files[i];
+		std::pair<std::unordered_map<Sha1Digest, ManifestFile const*>::iterator, bool> inserted = seen.insert(std::make_pair(file.m_digest, &file));
+		if (!inserted.second && inserted.first->second->m_size != file.m_size)
+		{
+			std::cerr << "File " << file.m_path << " has the same hash as " << inserted.first->second->m_path
+				<< " (" << file.m_digest.ToString(true) << ") but a different size (" << file.m_size
+				<< " vs " << inserted.first->second->m_size << ")\n";
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Write the chunk list for _file to _output, or check _file against
+///        the chunk list _verify
+/// @return exit code
+static int RunChunks
+(
+	std::string const& _file,
+	std::string const& _output,
+	std::string const& _verify,
+	ChunkHasher::Options const& _options
+)
+{
+	ChunkHasher hasher(_options);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	if (!_verify.empty())
+	{
+		ChunkList expected;
+		if (!expected.Load(_verify))
+		{
+			std::cerr << "Unable to load chunk list " << _verify << "\n";
+			return 2;
+		}
+		std::vector<ChunkRange> bad;
+		if (!hasher.Verify(_file, expected, &bad))
+		{
+			std::cerr << hasher.Error() << "\n";
+			return 2;
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		uint64 badBytes = 0;
+		for (size_t i = 0; i < bad.size(); ++i)
+		{
+			std::cout << "Differs: offset " << bad[i].m_offset << ", " << bad[i].m_length << " bytes\n";
+			badBytes += bad[i].m_length;
+		}
+		std::cout << "Verified " << _file << " in " << seconds << "s: "
+			<< (bad.empty() ? std::string("all chunks match") : "differs in " + std::to_string(badBytes) + " bytes") << "\n";
+		return bad.empty() ? 0 : 3;
+	}
+
+	ChunkList list;
+	if (!hasher.Hash(_file, &list))
+	{
+		std::cerr << hasher.Error() << "\n";
+		return 2;
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "Hashed " << list.m_size << " bytes as " << list.m_chunks.size() << " chunks in " << seconds << "s: "
+		<< ((seconds > 0.0) ? (double)list.m_size / (1024.0 * 1024.0) / seconds : 0.0) << " MB/s, "
+		<< fSHA1::KernelName() << " kernel\n";
+	std::cout << "Root " << list.m_root.ToString(true) << "\n";
+	if (list.m_hasWholeFile)
+	{
+		std::cout << "Whole file " << list.m_wholeFile.ToString(true) << "\n";
+	}
+	if (!list.Save(_output))
+	{
+		std::cerr << "Unable to write " << _output << "\n";
+		return 2;
+	}
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Hash the files named in _list and report the rate, writing a
+///        manifest of them to _output if that's given
+/// @return exit code
+static int RunFileList
+(
+	std::string const& _list,
+	std::string const& _root,
+	std::string const& _output,
+	std::string const& _title,
+	std::string const& _version,
+	bool _slash,
+	bool _quiet,
+	BatchHasher::Options const& _options
+)
+{
+	std::ifstream input(_list.c_str());
+	if (!input)
+	{
+		std::cerr << "Unable to read " << _list << "\n";
+		return 1;
+	}
+
+	std::vector<ManifestFile> files;
+	std::string line;
+	while (std::getline(input, line))
+	{
+		if (!line.empty() && line[line.size() - 1] == '\r')
+		{
+			line.erase(line.size() - 1);
+		}
+		if (line.empty())
+		{
+			continue;
+		}
+		bool absolute = (line[0] == '/' || line[0] == '\\' || (line.size() > 1 && line[1] == ':'));
+
+		ManifestFile file;
+		file.m_fullPath = (absolute || _root.empty()) ? line : _root + "/" + line;
+		file.m_path = line;
+		for (size_t i = 0; i < file.m_path.size(); ++i)
+		{
+			if (file.m_path[i] == '/')
+			{
+				file.m_path[i] = '\\';
+			}
+		}
+		files.push_back(file);
+	}
+
+	BatchHasher hasher(_options);
+	bool ok = hasher.Run(files);
+
+	std::vector<std::string> const& errors = hasher.Errors();
+	for (size_t i = 0; i < errors.size(); ++i)
+	{
+		std::cerr << errors[i] << "\n";
+	}
+	if (!_quiet)
+	{
+		for (size_t i = 0; i < files.size(); ++i)
+		{
+			if (files[i].m_hashed)
+			{
+				std::cout << files[i].m_digest.ToString(true) << ' ' << files[i].m_size << " bytes "
+					<< files[i].m_seconds << "s " << files[i].m_path << "\n";
+			}
+		}
+	}
+	std::cout << "Hashed " << hasher.Files() << " of " << files.size() << " files, " << hasher.Bytes() << " bytes in "
+		<< hasher.Seconds() << "s: " << hasher.FilesPerSecond() << " files/s, " << hasher.MegabytesPerSecond() << " MB/s, "
+		<< hasher.EngineName() << " engine, " << fSHA1::KernelName() << " kernel\n";
+
+	if (_output.empty())
+	{
+		return ok ? 0 : 2;
+	}
+
+	std::deque<ManifestFile> hashed(files.begin(), files.end());
+	if (!ok || !CheckCollisions(hashed))
+	{
+		std::cerr << "Manifest not written\n";
+		return 2;
+	}
+	ManifestWriter writer(_title, _version, _slash);
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		writer.Add(files[i]);
+	}
+	if (!writer.Save(_output))
+	{
+		std::cerr << "Unable to write " << _output << "\n";
+		return 2;
+	}
+	return 0;
+}
+
+int main
+(
+	int argc,
+	char* argv[]
+)
+{
+	std::string root, output, title, version;
+	bool slash = false;
+	bool quiet = false;
+	TreeHasher::Options options;
+	std::string chunkFile, verifyChunks;
+	ChunkHasher::Options chunkOptions;
+	std::string fileList;
+	BatchHasher::Options batchOptions;
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string key = argv[i];
+		std::string value = argv[i + 1];
+
+		if (key == "/Root")
+		{
+			root = value;
+		}
+		else if (key == "/Output")
+		{
+			output = value;
+		}
+		else if (key == "/Title")
+		{
+			title = value;
+		}
+		else if (key == "/Version")
+		{
+			version = value;
+		}
+		else if (key == "/Slash")
+		{
+			slash = (value == "true");
+		}
+		else if (key == "/Threads")
+		{
+			options.m_threads = (unsigned)atoi(value.c_str());
+			chunkOptions.m_threads = options.m_threads;
+			batchOptions.m_threads = options.m_threads;
+		}
+		else if (key == "/IoThreads")
+		{
+			options.m_ioConcurrency = (unsigned)atoi(value.c_str());
+			chunkOptions.m_ioConcurrency = options.m_ioConcurrency;
+		}
+		else if (key == "/ChunkFile")
+		{
+			chunkFile = value;
+		}
+		else if (key == "/VerifyChunks")
+		{
+			verifyChunks = value;
+		}
+		else if (key == "/Order")
+		{
+			if (!ParseReadOrder(value, &options.m_order))
+			{
+				std::cerr << "Unknown order " << value << ", expected auto, parallel or physical\n";
+				return 1;
+			}
+			batchOptions.m_order = options.m_order;
+		}
+		else if (key == "/FileList")
+		{
+			fileList = value;
+		}
+		else if (key == "/Engine")
+		{
+			if (!BatchHasher::Options::ParseEngine(value, &batchOptions.m_engine))
+			{
+				std::cerr << "Unknown engine " << value << ", expected auto, uring or pool\n";
+				return 1;
+			}
+		}
+		else if (key == "/QueueDepth")
+		{
+			batchOptions.m_queueDepth = (unsigned)atoi(value.c_str());
+		}
+		else if (key == "/WholeFile")
+		{
+			chunkOptions.m_wholeFile = (value != "false");
+		}
+		else if (key == "/ChunkSize")
+		{
+			// in MB
+			chunkOptions.m_chunkSize = (uint64)atoi(value.c_str()) * 1024 * 1024;
+		}
+		else if (key == "/BufferSize")
+		{
+			// in KB
+			options.m_bufferSize = (unsigned)atoi(value.c_str()) * 1024;
+			batchOptions.m_bufferSize = options.m_bufferSize;
+		}
+		else if (key == "/Quiet")
+		{
+			quiet = (value == "true");
+		}
+		else
+		{
+			std::cerr << "Unknown option " << key << "\n";
+			return 1;
+		}
+	}
+
+	if (!chunkFile.empty() && (!output.empty() || !verifyChunks.empty()) && chunkOptions.m_chunkSize != 0)
+	{
+		return RunChunks(chunkFile, output, verifyChunks, chunkOptions);
+	}
+	if (!fileList.empty())
+	{
+		if (batchOptions.m_order == OrderPhysical && batchOptions.m_engine != BatchHasher::Automatic)
+		{
+			std::cerr << "/Order physical reads through its own engine, it can't be used with /Engine uring or pool\n";
+			return 1;
+		}
+		return RunFileList(fileList, root, output, title, version, slash, quiet, batchOptions);
+	}
+	if (root.empty() || output.empty())
+	{
+		std::cerr << "Usage: ManifestHasher /Root <dir> /Output <file> [/Title <title>] [/Version <version>] [/Slash true]\n"
+			"                      [/Threads <n>] [/IoThreads <n>] [/BufferSize <KB>] [/Quiet true]\n"
+			"                      [/Order auto|parallel|physical]\n"
+			"       ManifestHasher /ChunkFile <file> /Output <chunk list> [/ChunkSize <MB>] [/WholeFile false]\n"
+			"                      [/Threads <n>] [/IoThreads <n>]\n"
+			"       ManifestHasher /ChunkFile <file> /VerifyChunks <chunk list> [/Threads <n>] [/IoThreads <n>]\n"
+			"       ManifestHasher /FileList <list> [/Root <dir>] [/Output <file>] [/Engine auto|uring|pool]\n"
+			"                      [/QueueDepth <n>] [/Threads <n>] [/BufferSize <KB>] [/Quiet true]\n"
+			"                      [/Order auto|parallel|physical]\n";
+		return 1;
+	}
+	if (options.m_bufferSize < 64 * 1024)
+	{
+		options.m_bufferSize = 64 * 1024;
+	}
+
+	Progress progress;
+	progress.m_quiet = quiet;
+	progress.m_files = 0;
+	progress.m_bytes = 0;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	TreeHasher hasher(options, &OnFileHashed, &progress);
+	bool ok = hasher.Run(root);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::vector<std::string> const& errors = hasher.Errors();
+	for (size_t i = 0; i < errors.size(); ++i)
+	{
+		std::cerr << errors[i] << "\n";
+	}
+
+	double busy = 0.0;
+	std::deque<ManifestFile> const& files = hasher.Files();
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		busy += files[i].m_seconds;
+	}
+	std::cout << "Hashed " << progress.m_files << " files, " << progress.m_bytes << " bytes in " << seconds << "s: "
+		<< ((seconds > 0.0) ? (double)progress.m_bytes / (1024.0 * 1024.0) / seconds : 0.0) << " MB/s overall, "
+		<< ((busy > 0.0) ? (double)progress.m_bytes / (1024.0 * 1024.0) / busy : 0.0) << " MB/s average per file, "
+		<< fSHA1::KernelName() << " kernel, " << ReadOrderName(hasher.Order()) << " order on "
+		<< MediaName(hasher.Media()) << " media\n";
+
+	if (!ok || !CheckCollisions(files))
+	{
+		std::cerr << "Manifest not written\n";
+		return 2;
+	}
+
+	ManifestWriter writer(title, version, slash);
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		writer.Add(files[i]);
+	}
+	if (!writer.Save(output))
+	{
+		std::cerr << "Unable to write " << output << "\n";
+		return 2;
+	}
+	return 0;
+}
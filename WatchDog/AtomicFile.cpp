@@ -0,0 +1,63 @@
+/*----------------------------------------------------------------------------
+ *  FILE: AtomicFile.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "AtomicFile.h"
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+bool AtomicWriteFile
+(
+	std::string const& _path,
+	void const* _data,
+	size_t _size
+)
+{
+	std::string tempPath = _path + ".tmp";
+	bool ok = false;
+#ifdef _WIN32
+	HANDLE file = CreateFileA(tempPath.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	DWORD written = 0;
+	ok = WriteFile(file, _data, (DWORD)_size, &written, NULL) && written == _size && FlushFileBuffers(file);
+	CloseHandle(file);
+	if (ok)
+	{
+		ok = MoveFileExA(tempPath.c_str(), _path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != FALSE;
+	}
+	if (!ok)
+	{
+		DeleteFileA(tempPath.c_str());
+	}
+#else
+	int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+	{
+		return false;
+	}
+	ok = write(fd, _data, _size) == (ssize_t)_size && fsync(fd) == 0;
+	close(fd);
+	if (ok)
+	{
+		ok = rename(tempPath.c_str(), _path.c_str()) == 0;
+	}
+	if (!ok)
+	{
+		unlink(tempPath.c_str());
+	}
+#endif
+	return ok;
+}
@@ -0,0 +1,20 @@
+/*----------------------------------------------------------------------------
+ *  FILE: AtomicFile.h
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef _ATOMICFILE_H
+#define _ATOMICFILE_H
+
+#include <stddef.h>
+#include <string>
+
+/// Replace the contents of _path. The data goes to a temporary file which is
+/// flushed to disk and then renamed over the original, so a crash part way
+/// through leaves either the old contents or the new, never a mixture.
+bool AtomicWriteFile(std::string const& _path, void const* _data, size_t _size);
+
+#endif
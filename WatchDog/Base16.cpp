@@ -0,0 +1,356 @@
+/*----------------------------------------------------------------------------
+ *  FILE: Base16.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "Base16.h"
+#include "rc4encrypt.h"
+#include "Sha1Kernels.h"
+#include <string.h>
+
+// SSE2 is always there on x64, and on x86 when the compiler is told to use it
+#if F_SHA1_X86
+#include <emmintrin.h>
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define F_BASE16_SSE2 (1)
+#endif
+#endif
+#ifndef F_BASE16_SSE2
+#define F_BASE16_SSE2 (0)
+#endif
+
+static char const s_bitsToChar[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Value of a hex digit
+/// @return -1 if _c isn't one
+static inline int HexValue
+(
+    char _c
+)
+{
+    if ( _c >= '0' && _c <= '9' )
+    {
+        return _c - '0';
+    }
+    if ( _c >= 'A' && _c <= 'F' )
+    {
+        return _c - 'A' + 10;
+    }
+    if ( _c >= 'a' && _c <= 'f' )
+    {
+        return _c - 'a' + 10;
+    }
+    return -1;
+}
+
+
+#if F_BASE16_SSE2
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Nibbles 0-15 to '0'-'9', 'A'-'F'
+static inline __m128i NibblesToHex
+(
+    __m128i _nibbles
+)
+{
+    __m128i letters = _mm_and_si128( _mm_cmpgt_epi8( _nibbles, _mm_set1_epi8( 9 ) ), _mm_set1_epi8( 'A' - '0' - 10 ) );
+    return _mm_add_epi8( _mm_add_epi8( _nibbles, _mm_set1_epi8( '0' ) ), letters );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief 16 bytes to 32 characters
+static inline void Encode16
+(
+    unsigned char const * _input,
+    char * o_output
+)
+{
+    __m128i bytes = _mm_loadu_si128( (__m128i const *) _input );
+    __m128i mask = _mm_set1_epi8( 0x0F );
+    __m128i high = _mm_and_si128( _mm_srli_epi16( bytes, 4 ), mask );
+    __m128i low = _mm_and_si128( bytes, mask );
+    high = NibblesToHex( high );
+    low = NibblesToHex( low );
+    // Most significant nibble first
+    _mm_storeu_si128( (__m128i *) o_output, _mm_unpacklo_epi8( high, low ) );
+    _mm_storeu_si128( (__m128i *) (o_output + 16), _mm_unpackhi_epi8( high, low ) );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Values of 16 hex digits, and a mask of those that are
+static inline __m128i HexValues16
+(
+    __m128i _chars,
+    __m128i * o_valid
+)
+{
+    // (unsigned)x <= limit, as min(x, limit) == x
+    __m128i digit = _mm_sub_epi8( _chars, _mm_set1_epi8( '0' ) );
+    __m128i isDigit = _mm_cmpeq_epi8( _mm_min_epu8( digit, _mm_set1_epi8( 9 ) ), digit );
+
+    // Folding to lower case only for the letter test: it would also fold
+    // some control characters onto the digits
+    __m128i letter = _mm_sub_epi8( _mm_or_si128( _chars, _mm_set1_epi8( 0x20 ) ), _mm_set1_epi8( 'a' ) );
+    __m128i isLetter = _mm_cmpeq_epi8( _mm_min_epu8( letter, _mm_set1_epi8( 5 ) ), letter );
+
+    *o_valid = _mm_or_si128( isDigit, isLetter );
+    return _mm_or_si128( _mm_and_si128( isDigit, digit ), _mm_and_si128( isLetter, _mm_add_epi8( letter, _mm_set1_epi8( 10 ) ) ) );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief 32 characters to 16 bytes
+/// @return false if any of them isn't a hex digit
+static inline bool Decode32
+(
+    char const * _input,
+    unsigned char * o_output
+)
+{
+    __m128i valid0, valid1;
+    __m128i values0 = HexValues16( _mm_loadu_si128( (__m128i const *) _input ), &valid0 );
+    __m128i values1 = HexValues16( _mm_loadu_si128( (__m128i const *) (_input + 16) ), &valid1 );
+    if ( _mm_movemask_epi8( _mm_and_si128( valid0, valid1 ) ) != 0xFFFF )
+    {
+        return false;
+    }
+
+    // Each 16 bit lane holds a pair, high nibble in its low byte
+    __m128i lowByte = _mm_set1_epi16( 0x00FF );
+    __m128i bytes0 = _mm_and_si128( _mm_or_si128( _mm_slli_epi16( values0, 4 ), _mm_srli_epi16( values0, 8 ) ), lowByte );
+    __m128i bytes1 = _mm_and_si128( _mm_or_si128( _mm_slli_epi16( values1, 4 ), _mm_srli_epi16( values1, 8 ) ), lowByte );
+    _mm_storeu_si128( (__m128i *) o_output, _mm_packus_epi16( bytes0, bytes1 ) );
+    return true;
+}
+
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Hex-encode front to back. Each step loads its input before it
+///        stores, and stores nothing past what it has loaded, so o_output
+///        may start before _input as long as it ends where _input ends:
+///        o_output + 2 * _len == _input + _len.
+static void EncodeForward
+(
+    unsigned char const * _input,
+    size_t _len,
+    char * o_output
+)
+{
+    size_t i = 0;
+#if F_BASE16_SSE2
+    for ( ; i + 16 <= _len; i += 16 )
+    {
+        Encode16( _input + i, o_output + i * 2 );
+    }
+#endif
+    for ( ; i < _len; i++ )
+    {
+        unsigned char currChar = _input[i];
+        o_output[i * 2] = s_bitsToChar[ currChar >> 4 ];			// Most significant 4 bits
+        o_output[i * 2 + 1] = s_bitsToChar[ currChar & 0x0F ];	// Least significant 4 bits
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Hex-encode a string
+/// @param _input
+/// @param _len
+/// @return std::string
+
+std::string Base16Encode
+( 
+    char const * _input, 
+    unsigned int _len 
+)
+{
+    std::string encStr( (size_t) _len * 2, '\0' );	// For each byte, we write two characters.
+    if ( _len != 0 )
+    {
+        Base16EncodeTo( _input, _len, &encStr[0], encStr.size() );
+    }
+    return encStr;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Hex-encode into a caller's buffer
+/// @param _input
+/// @param _len bytes of _input
+/// @param o_output receives 2 * _len characters, not terminated
+/// @param _outputSize room in o_output
+/// @return false if there isn't room
+bool Base16EncodeTo
+(
+    void const * _input,
+    size_t _len,
+    char * o_output,
+    size_t _outputSize
+)
+{
+    if ( _len > _outputSize / 2 )
+    {
+        return false;
+    }
+
+    EncodeForward( (unsigned char const *) _input, _len, o_output );
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Decode hex into a caller's buffer
+/// @param _input
+/// @param _len characters of _input, even
+/// @param o_output receives _len / 2 bytes
+/// @param _outputSize room in o_output
+/// @return false if _input isn't all hex digits or there isn't room
+bool Base16DecodeTo
+(
+    char const * _input,
+    size_t _len,
+    void * o_output,
+    size_t _outputSize
+)
+{
+    if ( ( _len & 1 ) != 0 || _len / 2 > _outputSize )
+    {
+        return false;
+    }
+
+    unsigned char * output = (unsigned char *) o_output;
+    size_t i = 0;
+#if F_BASE16_SSE2
+    for ( ; i + 32 <= _len; i += 32 )
+    {
+        if ( !Decode32( _input + i, output + i / 2 ) )
+        {
+            return false;
+        }
+    }
+#endif
+    for ( ; i < _len; i += 2 )
+    {
+        int high = HexValue( _input[i] );
+        int low = HexValue( _input[i + 1] );
+        if ( high < 0 || low < 0 )
+        {
+            return false;
+        }
+        output[i / 2] = (unsigned char) ( ( high << 4 ) | low );
+    }
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Encrypt then base-16 encode a buffer
+/// @param _args
+/// @param szName
+/// @return std::string encoded data
+std::string EncryptAndB16
+(
+    void* _args, 
+    unsigned _len,
+    char const * _szKey
+)
+{
+    return EncryptAndB16 ( _args, _len, RC4Context ( _szKey ) );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Encrypt then base-16 encode a buffer with a keyed RC4 context
+/// @param _args
+/// @param _len
+/// @param _keyed context to clone, it isn't advanced
+/// @return std::string encoded data
+std::string EncryptAndB16
+(
+    void* _args, 
+    unsigned _len,
+    RC4Context const & _keyed
+)
+{
+    std::string encoded( (size_t) _len * 2, '\0' );
+    if ( _len != 0 )
+    {
+        EncryptAndB16To ( _args, _len, _keyed, &encoded[0], encoded.size() );
+    }
+    return encoded;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Encrypt then base-16 encode a buffer into a caller's buffer
+/// @param _args
+/// @param _len bytes of _args
+/// @param _keyed context to clone, it isn't advanced
+/// @param o_output receives 2 * _len characters, not terminated
+/// @param _outputSize room in o_output
+/// @return false if there isn't room
+bool EncryptAndB16To
+(
+    void const * _args,
+    size_t _len,
+    RC4Context const & _keyed,
+    char * o_output,
+    size_t _outputSize
+)
+{
+    if ( _len > _outputSize / 2 )
+    {
+        return false;
+    }
+
+    // A block at a time through a small buffer, so neither _args nor the
+    // size of the stack limit the payload
+    unsigned char block[256];
+    RC4Context rc4 = _keyed;
+    unsigned char const * args = (unsigned char const *) _args;
+    for ( size_t done = 0; done < _len; done += sizeof( block ) )
+    {
+        size_t size = ( _len - done < sizeof( block ) ) ? _len - done : sizeof( block );
+        rc4.Process ( args + done, block, size );
+        Base16EncodeTo ( block, size, o_output + done * 2, size * 2 );
+    }
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Encrypt then base-16 encode a buffer with no working space other
+///        than the output itself: the ciphertext goes to its back half and
+///        is expanded from there, front to back
+/// @param _args
+/// @param _len bytes of _args
+/// @param _keyed context to clone, it isn't advanced
+/// @param io_output receives 2 * _len characters, not terminated
+/// @param _outputSize room in io_output
+/// @return false if there isn't room
+bool EncryptAndB16InPlace
+(
+    void const * _args,
+    size_t _len,
+    RC4Context const & _keyed,
+    char * io_output,
+    size_t _outputSize
+)
+{
+    if ( _len > _outputSize / 2 )
+    {
+        return false;
+    }
+
+    unsigned char * cipher = (unsigned char *) io_output + _len;
+    RC4Context rc4 = _keyed;
+    rc4.Process ( (unsigned char const *) _args, cipher, _len );
+    EncodeForward ( cipher, _len, io_output );
+    return true;
+}
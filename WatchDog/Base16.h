@@ -0,0 +1,48 @@
+/*----------------------------------------------------------------------------
+ *  FILE: Base16.h
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		Hex encoding of the data WatchDog hands to the game, split out of
+ *		main.cpp so it can be benchmarked on its own. Encoding and decoding
+ *		into the caller's buffers use SSE2 where the target has it.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef _BASE16_H
+#define _BASE16_H
+
+#include <string>
+
+class RC4Context;
+
+/// Upper case hex, two characters per byte
+std::string Base16Encode(char const * _input, unsigned int _len);
+
+/// Upper case hex of _len bytes into o_output, 2 * _len characters and no
+/// terminator. Returns false, writing nothing, if _outputSize is too small.
+bool Base16EncodeTo(void const * _input, size_t _len, char * o_output, size_t _outputSize);
+
+/// Bytes from _len hex characters, upper or lower case, into o_output.
+/// Returns false if _len is odd, _outputSize is less than _len / 2, or
+/// there is anything other than hex digits; o_output may have been
+/// partly written.
+bool Base16DecodeTo(char const * _input, size_t _len, void * o_output, size_t _outputSize);
+
+/// RC4 encrypt a copy of _args with _szKey, then Base16Encode it
+std::string EncryptAndB16(void* _args, unsigned _len, char const * _szKey);
+
+/// As above with a copy of an already keyed context, leaving _keyed as it was
+std::string EncryptAndB16(void* _args, unsigned _len, RC4Context const & _keyed);
+
+/// Encrypt and hex encode _len bytes of _args straight into o_output, as
+/// Base16EncodeTo; _args is left as it was
+bool EncryptAndB16To(void const * _args, size_t _len, RC4Context const & _keyed, char * o_output, size_t _outputSize);
+
+/// As EncryptAndB16To, but using no memory besides io_output, e.g. a shared
+/// memory view: the ciphertext is written to its back half first, then
+/// expanded in place. _args must not overlap io_output.
+bool EncryptAndB16InPlace(void const * _args, size_t _len, RC4Context const & _keyed, char * io_output, size_t _outputSize);
+
+#endif
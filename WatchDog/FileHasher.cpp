@@ -0,0 +1,705 @@
+/*----------------------------------------------------------------------------
+ *  FILE: FileHasher.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "FileHasher.h"
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Unbuffered reads must start on, and be a multiple of, the device sector
+// size; 4K covers everything we are likely to meet.
+static const size_t IoAlignment = 4096;
+
+bool FileHashOptions::ParseMode(std::string const& _name, Mode* o_mode)
+{
+	if (_name == "serial")
+	{
+		*o_mode = Serial;
+		return true;
+	}
+	if (_name == "pipelined")
+	{
+		*o_mode = Pipelined;
+		return true;
+	}
+	if (_name == "mapped")
+	{
+		*o_mode = Mapped;
+		return true;
+	}
+	return false;
+}
+
+char const* FileHashOptions::ModeName(Mode _mode)
+{
+	switch (_mode)
+	{
+	case Serial:	return "serial";
+	case Pipelined:	return "pipelined";
+	case Mapped:	return "mapped";
+	}
+	return "unknown";
+}
+
+static void* AlignedAlloc(size_t _size)
+{
+#ifdef _WIN32
+	return _aligned_malloc(_size, IoAlignment);
+#else
+	void* p = NULL;
+	return (posix_memalign(&p, IoAlignment, _size) == 0) ? p : NULL;
+#endif
+}
+
+static void AlignedFree(void* _p)
+{
+#ifdef _WIN32
+	_aligned_free(_p);
+#else
+	free(_p);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// The digests asked for, fed from the one read. Used like an fSHA1.
+class FileDigests
+{
+public:
+	FileDigests(FileHashOptions::Digests _digests, FileHashResult* o_result) :
+		m_sha1((_digests != FileHashOptions::FastOnly) ? &o_result->m_digest : NULL),
+		m_fast((_digests != FileHashOptions::Sha1Only) ? &o_result->m_fastDigest : NULL)
+	{
+	}
+
+	void StreamStart()
+	{
+		if (m_sha1)
+		{
+			m_sha1->StreamStart();
+		}
+		if (m_fast)
+		{
+			m_fast->StreamStart();
+		}
+	}
+
+	void Update(void const* _data, size_t _size)
+	{
+		if (m_sha1 == NULL || m_fast == NULL)
+		{
+			if (m_sha1)
+			{
+				m_sha1->Update(_data, _size);
+			}
+			else
+			{
+				m_fast->Update(_data, _size);
+			}
+			return;
+		}
+
+		// Both: a piece at a time, so the second pass over it comes from the
+		// cache rather than memory
+		unsigned char const* data = (unsigned char const*)_data;
+		while (_size != 0)
+		{
+			size_t piece = (_size < 64 * 1024) ? _size : 64 * 1024;
+			m_sha1->Update(data, piece);
+			m_fast->Update(data, piece);
+			data += piece;
+			_size -= piece;
+		}
+	}
+
+	void Finish()
+	{
+		if (m_sha1)
+		{
+			m_sha1->Finish();
+		}
+		if (m_fast)
+		{
+			m_fast->Finish();
+		}
+	}
+
+	uint64 Size() const
+	{
+		return m_sha1 ? m_sha1->m_totalSize : m_fast->m_totalSize;
+	}
+
+private:
+	fSHA1* m_sha1;
+	fXXH3* m_fast;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Minimal sequential reader over the native file API, optionally bypassing
+/// the file cache.
+class RawFile
+{
+public:
+	RawFile() :
+#ifdef _WIN32
+		m_handle(INVALID_HANDLE_VALUE)
+#else
+		m_fd(-1)
+#endif
+	{
+	}
+
+	~RawFile()
+	{
+		Close();
+	}
+
+	bool Open(std::string const& _path, bool _unbuffered)
+	{
+#ifdef _WIN32
+		DWORD flags = FILE_FLAG_SEQUENTIAL_SCAN;
+		if (_unbuffered)
+		{
+			m_handle = CreateFileA(_path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, flags | FILE_FLAG_NO_BUFFERING, NULL);
+		}
+		if (m_handle == INVALID_HANDLE_VALUE)
+		{
+			m_handle = CreateFileA(_path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, flags, NULL);
+		}
+		return m_handle != INVALID_HANDLE_VALUE;
+#else
+		int flags = O_RDONLY;
+#ifdef O_DIRECT
+		if (_unbuffered)
+		{
+			m_fd = open(_path.c_str(), flags | O_DIRECT);
+		}
+#endif
+		if (m_fd < 0)
+		{
+			m_fd = open(_path.c_str(), flags);
+		}
+#ifdef POSIX_FADV_SEQUENTIAL
+		if (m_fd >= 0)
+		{
+			posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+		}
+#endif
+		return m_fd >= 0;
+#endif
+	}
+
+	void Close()
+	{
+#ifdef _WIN32
+		if (m_handle != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(m_handle);
+			m_handle = INVALID_HANDLE_VALUE;
+		}
+#else
+		if (m_fd >= 0)
+		{
+			close(m_fd);
+			m_fd = -1;
+		}
+#endif
+	}
+
+	/// Read up to _size bytes. Returns the number read, 0 at end of file or
+	/// -1 on error. A short read means the end of the file has been reached.
+	long long Read(void* _buffer, size_t _size)
+	{
+#ifdef _WIN32
+		DWORD dataread = 0;
+		if (!ReadFile(m_handle, _buffer, (DWORD)_size, &dataread, NULL))
+		{
+			return -1;
+		}
+		return (long long)dataread;
+#else
+		size_t total = 0;
+		while (total < _size)
+		{
+			ssize_t n = read(m_fd, (char*)_buffer + total, _size - total);
+			if (n < 0)
+			{
+#ifdef O_DIRECT
+				if (errno == EINVAL && (fcntl(m_fd, F_GETFL) & O_DIRECT) != 0)
+				{
+					// Filesystem doesn't support direct I/O, carry on through the cache
+					fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL) & ~O_DIRECT);
+					continue;
+				}
+#endif
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				return -1;
+			}
+			if (n == 0)
+			{
+				break;
+			}
+			total += (size_t)n;
+		}
+		return (long long)total;
+#endif
+	}
+
+private:
+#ifdef _WIN32
+	HANDLE m_handle;
+#else
+	int m_fd;
+#endif
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reader thread filling a ring of buffers which the calling thread hashes
+/// in order.
+class ReadPipeline
+{
+public:
+	ReadPipeline(RawFile& _file, unsigned _depth, size_t _bufferSize) :
+		m_file(_file),
+		m_bufferSize(_bufferSize),
+		m_filled(0),
+		m_consumed(0),
+		m_finished(false),
+		m_failed(false)
+	{
+		m_slots.resize(_depth);
+		for (size_t i = 0; i < m_slots.size(); ++i)
+		{
+			m_slots[i].m_data = (unsigned char*)AlignedAlloc(m_bufferSize);
+			m_slots[i].m_size = 0;
+			if (m_slots[i].m_data == NULL)
+			{
+				m_failed = true;
+			}
+		}
+	}
+
+	~ReadPipeline()
+	{
+		for (size_t i = 0; i < m_slots.size(); ++i)
+		{
+			AlignedFree(m_slots[i].m_data);
+		}
+	}
+
+	bool Run(FileDigests* o_digest)
+	{
+		if (m_failed)
+		{
+			return false;
+		}
+
+		std::thread reader(&ReadPipeline::ReaderThread, this);
+
+		o_digest->StreamStart();
+		while (1)
+		{
+			Slot* slot = NULL;
+			{
+				std::unique_lock<std::mutex> lock(m_lock);
+				while (m_consumed == m_filled && !m_finished)
+				{
+					m_changed.wait(lock);
+				}
+				if (m_consumed == m_filled)
+				{
+					break;
+				}
+				slot = &m_slots[m_consumed % m_slots.size()];
+			}
+
+			o_digest->Update(slot->m_data, slot->m_size);
+
+			{
+				std::lock_guard<std::mutex> lock(m_lock);
+				++m_consumed;
+			}
+			m_changed.notify_all();
+		}
+		o_digest->Finish();
+
+		reader.join();
+		return !m_failed;
+	}
+
+private:
+	struct Slot
+	{
+		unsigned char* m_data;
+		size_t m_size;
+	};
+
+	RawFile& m_file;
+	size_t m_bufferSize;
+	std::vector<Slot> m_slots;
+
+	std::mutex m_lock;
+	std::condition_variable m_changed;
+	uint64 m_filled;		// buffers handed to the hasher
+	uint64 m_consumed;		// buffers the hasher has finished with
+	bool m_finished;
+	bool m_failed;
+
+	void ReaderThread()
+	{
+		while (1)
+		{
+			Slot* slot = NULL;
+			{
+				std::unique_lock<std::mutex> lock(m_lock);
+				while (m_filled - m_consumed == m_slots.size())
+				{
+					m_changed.wait(lock);
+				}
+				slot = &m_slots[m_filled % m_slots.size()];
+			}
+
+			long long dataread = m_file.Read(slot->m_data, m_bufferSize);
+			bool done;
+
+			{
+				std::lock_guard<std::mutex> lock(m_lock);
+				if (dataread < 0)
+				{
+					m_failed = true;
+					m_finished = true;
+				}
+				else
+				{
+					if (dataread > 0)
+					{
+						slot->m_size = (size_t)dataread;
+						++m_filled;
+					}
+					m_finished = ((size_t)dataread < m_bufferSize);
+				}
+				done = m_finished;
+			}
+			m_changed.notify_all();
+
+			if (done)
+			{
+				break;
+			}
+		}
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read-only mapping of a whole file, viewed a window at a time.
+class MappedFile
+{
+public:
+	MappedFile() :
+#ifdef _WIN32
+		m_handle(INVALID_HANDLE_VALUE),
+		m_mapping(NULL),
+#else
+		m_fd(-1),
+#endif
+		m_view(NULL),
+		m_viewSize(0),
+		m_size(0)
+	{
+	}
+
+	~MappedFile()
+	{
+		Unmap();
+#ifdef _WIN32
+		if (m_mapping != NULL)
+		{
+			CloseHandle(m_mapping);
+		}
+		if (m_handle != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(m_handle);
+		}
+#else
+		if (m_fd >= 0)
+		{
+			close(m_fd);
+		}
+#endif
+	}
+
+	/// Open and map the file. Fails for anything that can't be mapped,
+	/// including empty files.
+	bool Open(std::string const& _path)
+	{
+#ifdef _WIN32
+		m_handle = CreateFileA(_path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (m_handle == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(m_handle, &size) || size.QuadPart == 0)
+		{
+			return false;
+		}
+		m_size = (uint64)size.QuadPart;
+		m_mapping = CreateFileMappingA(m_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+		return m_mapping != NULL;
+#else
+		m_fd = open(_path.c_str(), O_RDONLY);
+		if (m_fd < 0)
+		{
+			return false;
+		}
+		struct stat info;
+		if (fstat(m_fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0)
+		{
+			return false;
+		}
+		m_size = (uint64)info.st_size;
+		return true;
+#endif
+	}
+
+	uint64 Size() const
+	{
+		return m_size;
+	}
+
+	/// Map _size bytes from _offset, replacing any previous view. _offset
+	/// must be a multiple of the allocation granularity.
+	unsigned char const* Map(uint64 _offset, size_t _size)
+	{
+		Unmap();
+#ifdef _WIN32
+		m_view = MapViewOfFile(m_mapping, FILE_MAP_READ, (DWORD)(_offset >> 32), (DWORD)_offset, _size);
+		if (m_view == NULL)
+		{
+			return NULL;
+		}
+		// Ask for the whole window up front rather than faulting it in a
+		// page at a time
+		WIN32_MEMORY_RANGE_ENTRY range;
+		range.VirtualAddress = m_view;
+		range.NumberOfBytes = _size;
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+		void* view = mmap(NULL, _size, PROT_READ, MAP_PRIVATE, m_fd, (off_t)_offset);
+		if (view == MAP_FAILED)
+		{
+			return NULL;
+		}
+		m_view = view;
+		madvise(m_view, _size, MADV_SEQUENTIAL);
+		madvise(m_view, _size, MADV_WILLNEED);
+#endif
+		m_viewSize = _size;
+		return (unsigned char const*)m_view;
+	}
+
+	void Unmap()
+	{
+		if (m_view == NULL)
+		{
+			return;
+		}
+#ifdef _WIN32
+		UnmapViewOfFile(m_view);
+#else
+		munmap(m_view, m_viewSize);
+#endif
+		m_view = NULL;
+		m_viewSize = 0;
+	}
+
+private:
+#ifdef _WIN32
+	HANDLE m_handle;
+	HANDLE m_mapping;
+#else
+	int m_fd;
+#endif
+	void* m_view;
+	size_t m_viewSize;
+	uint64 m_size;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Hash one mapped window. An I/O error while paging the view in is
+///        raised as an exception on Windows rather than returned
+static bool HashView(FileDigests* _digest, unsigned char const* _view, size_t _size)
+{
+#ifdef _MSC_VER
+	__try
+	{
+		_digest->Update(_view, _size);
+	}
+	__except (GetExceptionCode() == EXCEPTION_IN_PAGE_ERROR ? EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH)
+	{
+		return false;
+	}
+	return true;
+#else
+	_digest->Update(_view, _size);
+	return true;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The original loop: read a buffer, hash it, read the next
+static bool HashFileSerial(std::string const& _path, unsigned _bufferSize, FileDigests* o_digest)
+{
+	std::ifstream file(_path, std::ios::in | std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	std::vector<char> buffer(_bufferSize);
+	o_digest->StreamStart();
+	while(1)
+	{
+		file.read(&buffer[0], _bufferSize);
+		int dataread = (int)file.gcount();
+		if (dataread == 0)
+		{
+			break;
+		}
+		o_digest->Update(&buffer[0], dataread);
+	}
+	o_digest->Finish();
+
+	return !file.bad();
+}
+
+static bool HashFilePipelined(std::string const& _path, FileHashOptions const& _options, FileDigests* o_digest)
+{
+	RawFile file;
+	if (!file.Open(_path, _options.m_unbuffered))
+	{
+		return false;
+	}
+
+	// At least one aligned block; an empty buffer would never see the end of the file
+	size_t bufferSize = (_options.m_bufferSize + IoAlignment - 1) / IoAlignment * IoAlignment;
+	if (bufferSize < IoAlignment)
+	{
+		bufferSize = IoAlignment;
+	}
+	unsigned depth = (_options.m_queueDepth < 2) ? 2 : _options.m_queueDepth;
+
+	ReadPipeline pipeline(file, depth, bufferSize);
+	return pipeline.Run(o_digest);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Hash straight out of mapped views of the file
+/// @param o_mapped Cleared if the file, or some window of it, could not be
+///        mapped, in which case the caller should read it instead
+/// @return false on failure
+static bool HashFileMapped(std::string const& _path, FileHashOptions const& _options, FileDigests* o_digest, bool* o_mapped)
+{
+	*o_mapped = false;
+
+	MappedFile file;
+	if (!file.Open(_path))
+	{
+		return false;
+	}
+
+	// Views have to start on the allocation granularity, 64K on Windows and a
+	// page elsewhere; a whole number of 64K is fine for both.
+	const uint64 granularity = 64 * 1024;
+	uint64 window = (_options.m_mapWindowSize < granularity) ? granularity : _options.m_mapWindowSize / granularity * granularity;
+	if (window > file.Size())
+	{
+		window = file.Size();
+	}
+
+	uint64 offset = 0;
+	o_digest->StreamStart();
+	while (offset < file.Size())
+	{
+		size_t size = (size_t)((file.Size() - offset < window) ? file.Size() - offset : window);
+		unsigned char const* view = file.Map(offset, size);
+		if (view == NULL)
+		{
+			// Out of address space or similar; reading it will still work
+			return false;
+		}
+		if (!HashView(o_digest, view, size))
+		{
+			*o_mapped = true;
+			return false;
+		}
+		offset += size;
+	}
+	o_digest->Finish();
+	*o_mapped = true;
+	return true;
+}
+
+bool HashFile
+(
+	std::string const& _path,
+	FileHashOptions const& _options,
+	FileHashResult* o_result
+)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	unsigned bufferSize = (_options.m_bufferSize < 64) ? 64 : _options.m_bufferSize;
+
+	bool ok = false;
+	FileDigests digests(_options.m_digests, o_result);
+	o_result->m_mode = _options.m_mode;
+	switch (_options.m_mode)
+	{
+	case FileHashOptions::Serial:
+		ok = HashFileSerial(_path, bufferSize, &digests);
+		break;
+
+	case FileHashOptions::Pipelined:
+		ok = HashFilePipelined(_path, _options, &digests);
+		break;
+
+	case FileHashOptions::Mapped:
+		{
+			bool mapped = false;
+			ok = HashFileMapped(_path, _options, &digests, &mapped);
+			if (!mapped)
+			{
+				o_result->m_mode = FileHashOptions::Pipelined;
+				ok = HashFilePipelined(_path, _options, &digests);
+			}
+		}
+		break;
+	}
+
+	o_result->m_size = digests.Size();
+	o_result->m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return ok;
+}
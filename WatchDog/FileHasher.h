@@ -0,0 +1,78 @@
+/*----------------------------------------------------------------------------
+ *  FILE: FileHasher.h
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		Whole file SHA-1. Besides the plain read-then-hash loop the file can
+ *		be read on a separate thread into a ring of aligned buffers so that
+ *		disk and hashing overlap, or mapped and hashed straight out of the
+ *		file cache. The XXH3 fast digest can be taken from the same read,
+ *		instead of or as well as the SHA-1.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef _FILEHASHER_H
+#define _FILEHASHER_H
+
+#include "sha1.h"
+#include "Xxh3.h"
+#include <string>
+
+struct FileHashOptions
+{
+	enum Mode
+	{
+		Serial,			// ifstream read, then hash, then read ...
+		Pipelined,		// reader thread filling a ring of buffers
+		Mapped,			// hash from mapped views, falls back to Pipelined
+	};
+
+	enum Digests
+	{
+		Sha1Only,
+		FastOnly,		// XXH3 only, to compare against an earlier fast digest
+		Sha1AndFast,	// both, from the one read
+	};
+
+	Mode m_mode;
+	Digests m_digests;
+	unsigned m_queueDepth;		// pipelined: number of buffers in the ring
+	unsigned m_bufferSize;		// bytes per read
+	bool m_unbuffered;			// pipelined: bypass the OS file cache where possible
+	unsigned m_mapWindowSize;	// mapped: bytes mapped at a time
+
+	FileHashOptions() :
+		m_mode(Pipelined),
+		m_digests(Sha1Only),
+		m_queueDepth(4),
+		m_bufferSize(1024 * 1024),
+		m_unbuffered(true),
+		m_mapWindowSize(64 * 1024 * 1024)
+	{
+	}
+
+	static bool ParseMode(std::string const& _name, Mode* o_mode);
+	static char const* ModeName(Mode _mode);
+};
+
+struct FileHashResult
+{
+	fSHA1 m_digest;			// unless FastOnly
+	fXXH3 m_fastDigest;		// unless Sha1Only
+	uint64 m_size;
+	double m_seconds;
+	FileHashOptions::Mode m_mode;	// the path actually taken
+
+	FileHashResult() : m_size(0), m_seconds(0.0), m_mode(FileHashOptions::Serial) {}
+
+	double MegabytesPerSecond() const
+	{
+		return (m_seconds > 0.0) ? (double)m_size / (1024.0 * 1024.0) / m_seconds : 0.0;
+	}
+};
+
+/// Hash a file. Returns false if it could not be opened or read.
+bool HashFile(std::string const& _path, FileHashOptions const& _options, FileHashResult* o_result);
+
+#endif
@@ -0,0 +1,432 @@
+/*----------------------------------------------------------------------------
+ *  FILE: HashCache.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "HashCache.h"
+#include "AtomicFile.h"
+#include <fstream>
+#include <iterator>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <bcrypt.h>
+#include <wincrypt.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// First line of the file, bump the version if the record layout changes
+static char const* const CacheHeader = "WatchDogHashCache\t3";
+
+// Bytes of key for the record MACs
+static const size_t KeySize = 32;
+
+bool FileIdentity::Get
+(
+	std::string const& _path,
+	FileIdentity* o_identity
+)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(_path.c_str(), FILE_READ_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, 0, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	BY_HANDLE_FILE_INFORMATION info;
+	FILE_BASIC_INFO basic;
+	bool ok = GetFileInformationByHandle(file, &info) && GetFileInformationByHandleEx(file, FileBasicInfo, &basic, sizeof(basic));
+	CloseHandle(file);
+	if (!ok)
+	{
+		return false;
+	}
+
+	o_identity->m_volume = info.dwVolumeSerialNumber;
+	o_identity->m_fileIndex = ((uint64)info.nFileIndexHigh << 32) | info.nFileIndexLow;
+	o_identity->m_size = ((uint64)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+	o_identity->m_lastWrite = (uint64)basic.LastWriteTime.QuadPart;
+	o_identity->m_change = (uint64)basic.ChangeTime.QuadPart;
+	return true;
+#else
+	struct stat info;
+	if (stat(_path.c_str(), &info) != 0)
+	{
+		return false;
+	}
+
+	o_identity->m_volume = (uint64)info.st_dev;
+	o_identity->m_fileIndex = (uint64)info.st_ino;
+	o_identity->m_size = (uint64)info.st_size;
+#if defined(__APPLE__)
+	o_identity->m_lastWrite = (uint64)info.st_mtimespec.tv_sec * 1000000000ull + (uint64)info.st_mtimespec.tv_nsec;
+	o_identity->m_change = (uint64)info.st_ctimespec.tv_sec * 1000000000ull + (uint64)info.st_ctimespec.tv_nsec;
+#else
+	o_identity->m_lastWrite = (uint64)info.st_mtim.tv_sec * 1000000000ull + (uint64)info.st_mtim.tv_nsec;
+	o_identity->m_change = (uint64)info.st_ctim.tv_sec * 1000000000ull + (uint64)info.st_ctim.tv_nsec;
+#endif
+	return true;
+#endif
+}
+
+HashCache::HashCache
+(
+	std::string const& _cachePath
+):
+	m_cachePath(_cachePath),
+	m_dirty(false)
+{
+}
+
+#ifdef _WIN32
+
+// Mixed into the DPAPI encryption, so the key is only readable by code that
+// knows what it is for
+static char const KeyEntropy[] = "WatchDogHashCacheKey";
+
+static bool ReadKey
+(
+	std::string const& _keyPath,
+	std::vector<unsigned char>* o_key
+)
+{
+	std::ifstream file(_keyPath.c_str(), std::ios::in | std::ios::binary);
+	std::vector<char> blob((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (blob.empty())
+	{
+		return false;
+	}
+
+	DATA_BLOB in = { (DWORD)blob.size(), (BYTE*)&blob[0] };
+	DATA_BLOB entropy = { sizeof(KeyEntropy), (BYTE*)KeyEntropy };
+	DATA_BLOB out = { 0, NULL };
+	if (!CryptUnprotectData(&in, NULL, &entropy, NULL, NULL, CRYPTPROTECT_UI_FORBIDDEN, &out))
+	{
+		return false;
+	}
+	bool ok = (out.cbData == KeySize);
+	if (ok)
+	{
+		o_key->assign(out.pbData, out.pbData + out.cbData);
+	}
+	SecureZeroMemory(out.pbData, out.cbData);
+	LocalFree(out.pbData);
+	return ok;
+}
+
+static bool CreateKey
+(
+	std::string const& _keyPath,
+	std::vector<unsigned char>* o_key
+)
+{
+	std::vector<unsigned char> key(KeySize);
+	if (BCryptGenRandom(NULL, &key[0], (ULONG)key.size(), BCRYPT_USE_SYSTEM_PREFERRED_RNG) != 0)
+	{
+		return false;
+	}
+
+	DATA_BLOB in = { (DWORD)key.size(), &key[0] };
+	DATA_BLOB entropy = { sizeof(KeyEntropy), (BYTE*)KeyEntropy };
+	DATA_BLOB out = { 0, NULL };
+	if (!CryptProtectData(&in, L"WatchDog hash cache", &entropy, NULL, NULL, CRYPTPROTECT_UI_FORBIDDEN, &out))
+	{
+		return false;
+	}
+	bool ok = AtomicWriteFile(_keyPath, out.pbData, out.cbData);
+	LocalFree(out.pbData);
+	if (ok)
+	{
+		o_key->swap(key);
+	}
+	return ok;
+}
+
+#else
+
+static bool ReadKey
+(
+	std::string const& _keyPath,
+	std::vector<unsigned char>* o_key
+)
+{
+	std::vector<unsigned char> key(KeySize);
+	FILE* file = fopen(_keyPath.c_str(), "rb");
+	if (file == NULL)
+	{
+		return false;
+	}
+	bool ok = (fread(&key[0], 1, key.size(), file) == key.size());
+	fclose(file);
+	if (ok)
+	{
+		o_key->swap(key);
+	}
+	return ok;
+}
+
+static bool CreateKey
+(
+	std::string const& _keyPath,
+	std::vector<unsigned char>* o_key
+)
+{
+	std::vector<unsigned char> key(KeySize);
+	FILE* random = fopen("/dev/urandom", "rb");
+	if (random == NULL)
+	{
+		return false;
+	}
+	bool ok = (fread(&key[0], 1, key.size(), random) == key.size());
+	fclose(random);
+	if (!ok)
+	{
+		return false;
+	}
+
+	// Only ever readable by this user, written whole to a new name and then
+	// renamed so another launch never reads half a key
+	std::string tempPath = _keyPath + ".tmp";
+	unlink(tempPath.c_str());
+	int file = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+	if (file < 0)
+	{
+		return false;
+	}
+	ok = write(file, &key[0], key.size()) == (ssize_t)key.size() && fsync(file) == 0;
+	ok = (close(file) == 0) && ok && rename(tempPath.c_str(), _keyPath.c_str()) == 0;
+	if (!ok)
+	{
+		unlink(tempPath.c_str());
+		return false;
+	}
+	o_key->swap(key);
+	return true;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief HMAC-SHA1 (RFC 2104) of one record, so records can't be written
+///        without the key
+std::string HashCache::RecordMac
+(
+	std::string const& _record
+) const
+{
+	unsigned char inner[64];
+	unsigned char outer[64];
+	for (size_t i = 0; i < 64; ++i)
+	{
+		unsigned char k = (i < m_key.size()) ? m_key[i] : 0;
+		inner[i] = k ^ 0x36;
+		outer[i] = k ^ 0x5C;
+	}
+
+	fSHA1 sha;
+	sha.StreamStart();
+	sha.Update(inner, sizeof(inner));
+	sha.Update(_record.data(), _record.size());
+	sha.Finish();
+	Sha1Digest innerDigest = sha.Digest();
+
+	fSHA1 mac;
+	mac.StreamStart();
+	mac.Update(outer, sizeof(outer));
+	mac.Update(innerDigest.m_bytes, Sha1Digest::Size);
+	mac.Finish();
+	return mac.ToString();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief One record as written to the file, without its trailing checksum
+std::string HashCache::FormatRecord
+(
+	std::string const& _path,
+	Entry const& _entry
+)
+{
+	char fields[256];
+	sprintf(fields, "%016llX\t%016llX\t%016llX\t%016llX\t%016llX\t%08X%08X%08X%08X%08X\t%s\t%016llX\t",
+		_entry.m_identity.m_volume, _entry.m_identity.m_fileIndex, _entry.m_identity.m_size,
+		_entry.m_identity.m_lastWrite, _entry.m_identity.m_change,
+		_entry.m_hash[0], _entry.m_hash[1], _entry.m_hash[2], _entry.m_hash[3], _entry.m_hash[4],
+		_entry.m_hasFast ? _entry.m_fast.ToString().c_str() : "-", _entry.m_sha1Time);
+	return std::string(fields) + _path;
+}
+
+void HashCache::Load()
+{
+	m_entries.clear();
+	m_dirty = false;
+
+	// Without the key nothing in the file can be trusted. A new key makes
+	// any records there unreadable, which is what's wanted.
+	std::string keyPath = m_cachePath + ".key";
+	m_key.clear();
+	if (!ReadKey(keyPath, &m_key) && !CreateKey(keyPath, &m_key))
+	{
+		m_key.clear();
+		return;
+	}
+
+	std::ifstream file(m_cachePath.c_str(), std::ios::in | std::ios::binary);
+	if (!file.is_open())
+	{
+		return;
+	}
+
+	std::string line;
+	if (!std::getline(file, line) || line != CacheHeader)
+	{
+		return;
+	}
+
+	while (std::getline(file, line))
+	{
+		// <volume> <index> <size> <lastwrite> <change> <digest> <fast digest or -> <digest time> <path> <mac>
+		size_t checkStart = line.rfind('\t');
+		if (checkStart == std::string::npos)
+		{
+			continue;
+		}
+		std::string record = line.substr(0, checkStart);
+		if (line.compare(checkStart + 1, std::string::npos, RecordMac(record)) != 0)
+		{
+			continue;
+		}
+
+		unsigned long long fields[6];
+		char digest[41];
+		char fast[33];
+		int pathStart = 0;
+		if (sscanf(record.c_str(), "%llx\t%llx\t%llx\t%llx\t%llx\t%40[0-9A-F]\t%32[-0-9a-f]\t%llx\t%n",
+			&fields[0], &fields[1], &fields[2], &fields[3], &fields[4], digest, fast, &fields[5], &pathStart) != 8 || pathStart == 0)
+		{
+			continue;
+		}
+
+		Entry entry;
+		entry.m_identity.m_volume = fields[0];
+		entry.m_identity.m_fileIndex = fields[1];
+		entry.m_identity.m_size = fields[2];
+		entry.m_identity.m_lastWrite = fields[3];
+		entry.m_identity.m_change = fields[4];
+		entry.m_hasFast = Xxh3Digest128::Parse(fast, &entry.m_fast);
+		entry.m_sha1Time = fields[5];
+		for (unsigned w = 0; w < 5; ++w)
+		{
+			char word[9];
+			memcpy(word, digest + w * 8, 8);
+			word[8] = 0;
+			entry.m_hash[w] = (fUInt32)strtoul(word, NULL, 16);
+		}
+		m_entries[record.substr(pathStart)] = entry;
+	}
+}
+
+bool HashCache::Save()
+{
+	if (!m_dirty)
+	{
+		return true;
+	}
+	if (m_key.empty())
+	{
+		return false;
+	}
+
+	std::string contents = CacheHeader;
+	contents += "\n";
+	for (std::map<std::string, Entry>::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+	{
+		std::string record = FormatRecord(it->first, it->second);
+		contents += record;
+		contents += "\t";
+		contents += RecordMac(record);
+		contents += "\n";
+	}
+
+	bool ok = AtomicWriteFile(m_cachePath, contents.data(), contents.size());
+	if (ok)
+	{
+		m_dirty = false;
+	}
+	return ok;
+}
+
+bool HashCache::Lookup
+(
+	std::string const& _path,
+	FileIdentity const& _identity,
+	fSHA1* o_digest
+) const
+{
+	std::map<std::string, Entry>::const_iterator it = m_entries.find(_path);
+	if (it == m_entries.end() || it->second.m_identity != _identity)
+	{
+		return false;
+	}
+	for (unsigned w = 0; w < 5; ++w)
+	{
+		o_digest->m_hash[w] = it->second.m_hash[w];
+	}
+	return true;
+}
+
+bool HashCache::LookupContent
+(
+	std::string const& _path,
+	Xxh3Digest128* o_fast,
+	fSHA1* o_digest,
+	uint64* o_sha1Time
+) const
+{
+	std::map<std::string, Entry>::const_iterator it = m_entries.find(_path);
+	if (it == m_entries.end() || !it->second.m_hasFast)
+	{
+		return false;
+	}
+	*o_fast = it->second.m_fast;
+	for (unsigned w = 0; w < 5; ++w)
+	{
+		o_digest->m_hash[w] = it->second.m_hash[w];
+	}
+	*o_sha1Time = it->second.m_sha1Time;
+	return true;
+}
+
+void HashCache::Store
+(
+	std::string const& _path,
+	FileIdentity const& _identity,
+	fSHA1 const& _digest,
+	Xxh3Digest128 const* _fast,
+	uint64 _sha1Time
+)
+{
+	Entry entry;
+	entry.m_identity = _identity;
+	entry.m_hasFast = (_fast != NULL);
+	if (_fast)
+	{
+		entry.m_fast = *_fast;
+	}
+	entry.m_sha1Time = _sha1Time;
+	for (unsigned w = 0; w < 5; ++w)
+	{
+		entry.m_hash[w] = _digest.m_hash[w];
+	}
+	m_entries[_path] = entry;
+	m_dirty = true;
+}
@@ -0,0 +1,110 @@
+/*----------------------------------------------------------------------------
+ *  FILE: HashCache.h
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		Digests of previously hashed files, remembered on disk together with
+ *		what identifies that exact version of the file: the volume and file
+ *		index (inode), the size and the last-write and change times. If any
+ *		of those differ the file is hashed again.
+ *
+ *		Entries also keep the XXH3 fast digest and when the SHA-1 was last
+ *		calculated, so a file that has only been touched can be recognised
+ *		by the fast hash alone, with a full SHA-1 every so often regardless.
+ *
+ *		A cached digest stands in for hashing the file, so each record
+ *		carries an HMAC-SHA1 made with a random key kept next to the cache
+ *		in <cache>.key. On Windows the key is encrypted with DPAPI for the
+ *		current user, so a record can't be forged by anyone who can merely
+ *		write to the directory. Records that don't verify are ignored.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef _HASHCACHE_H
+#define _HASHCACHE_H
+
+#include "sha1.h"
+#include "Xxh3.h"
+#include <map>
+#include <string>
+#include <vector>
+
+struct FileIdentity
+{
+	uint64 m_volume;
+	uint64 m_fileIndex;
+	uint64 m_size;
+	uint64 m_lastWrite;		// native timestamps, only ever compared for equality
+	uint64 m_change;
+
+	FileIdentity() : m_volume(0), m_fileIndex(0), m_size(0), m_lastWrite(0), m_change(0) {}
+
+	bool operator==(FileIdentity const& _other) const
+	{
+		return m_volume == _other.m_volume && m_fileIndex == _other.m_fileIndex && m_size == _other.m_size &&
+			m_lastWrite == _other.m_lastWrite && m_change == _other.m_change;
+	}
+	bool operator!=(FileIdentity const& _other) const
+	{
+		return !(*this == _other);
+	}
+
+	/// Fill in the identity of the file at _path. Returns false if it can't
+	/// be opened or queried.
+	static bool Get(std::string const& _path, FileIdentity* o_identity);
+};
+
+class HashCache
+{
+public:
+	explicit HashCache(std::string const& _cachePath);
+
+	/// Read the cache file, and the key, making one if there isn't one.
+	/// Records that fail their MAC are dropped, a missing or unreadable file
+	/// just leaves the cache empty, as does not having a key.
+	void Load();
+
+	/// Write the cache file, through AtomicWriteFile so a crash leaves either
+	/// the old cache or the new one, never a partial file. Fails if Load
+	/// couldn't get the key.
+	bool Save();
+
+	/// Returns true, with the digest, if _path was cached with this identity.
+	bool Lookup(std::string const& _path, FileIdentity const& _identity, fSHA1* o_digest) const;
+
+	/// Whatever is cached for _path, whatever its identity now: the fast
+	/// digest, the SHA-1 and when that SHA-1 was calculated (seconds since
+	/// 1970). Returns false if there's no entry or it has no fast digest.
+	bool LookupContent(std::string const& _path, Xxh3Digest128* o_fast, fSHA1* o_digest, uint64* o_sha1Time) const;
+
+	/// _fast may be NULL if it wasn't calculated. _sha1Time is when the SHA-1
+	/// was actually calculated, which is earlier than now if it was carried
+	/// over because the fast digest matched.
+	void Store(std::string const& _path, FileIdentity const& _identity, fSHA1 const& _digest, Xxh3Digest128 const* _fast, uint64 _sha1Time);
+
+	std::string const& Path() const
+	{
+		return m_cachePath;
+	}
+
+private:
+	struct Entry
+	{
+		FileIdentity m_identity;
+		fUInt32 m_hash[5];
+		bool m_hasFast;
+		Xxh3Digest128 m_fast;
+		uint64 m_sha1Time;
+	};
+
+	std::string m_cachePath;
+	std::map<std::string, Entry> m_entries;
+	bool m_dirty;
+	std::vector<unsigned char> m_key;
+
+	static std::string FormatRecord(std::string const& _path, Entry const& _entry);
+	std::string RecordMac(std::string const& _record) const;
+};
+
+#endif
@@ -0,0 +1,238 @@
+/*----------------------------------------------------------------------------
+ *  FILE: HttpBody.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "HttpBody.h"
+#include <string.h>
+
+static bool SeekTo(FILE* _file, uint64 _offset)
+{
+#ifdef _WIN32
+	return _fseeki64(_file, (long long)_offset, SEEK_SET) == 0;
+#else
+	return fseeko(_file, (off_t)_offset, SEEK_SET) == 0;
+#endif
+}
+
+static long long Tell(FILE* _file)
+{
+#ifdef _WIN32
+	return _ftelli64(_file);
+#else
+	return (long long)ftello(_file);
+#endif
+}
+
+HttpMemoryBody::HttpMemoryBody
+(
+	void const* _data,
+	size_t _size
+):
+	m_data((unsigned char const*)_data),
+	m_size(_size),
+	m_offset(0)
+{
+}
+
+bool HttpMemoryBody::Read
+(
+	void* o_data,
+	size_t _size,
+	size_t* o_read
+)
+{
+	size_t size = (m_size - m_offset < _size) ? m_size - m_offset : _size;
+	memcpy(o_data, m_data + m_offset, size);
+	m_offset += size;
+	*o_read = size;
+	return true;
+}
+
+HttpFileBody::HttpFileBody
+(
+	std::string const& _path
+):
+	m_file(fopen(_path.c_str(), "rb")),
+	m_owned(true),
+	m_start(0),
+	m_length(0)
+{
+	if (m_file)
+	{
+		// Reads are a whole send buffer at a time, stdio buffering would only add a copy
+		setvbuf(m_file, NULL, _IONBF, 0);
+#ifdef _WIN32
+		_fseeki64(m_file, 0, SEEK_END);
+#else
+		fseeko(m_file, 0, SEEK_END);
+#endif
+		long long size = Tell(m_file);
+		m_length = (size > 0) ? (uint64)size : 0;
+		SeekTo(m_file, 0);
+	}
+}
+
+HttpFileBody::HttpFileBody
+(
+	FILE* _file,
+	uint64 _length
+):
+	m_file(_file),
+	m_owned(false),
+	m_start(0),
+	m_length(_length)
+{
+	long long start = Tell(m_file);
+	m_start = (start > 0) ? (uint64)start : 0;
+}
+
+HttpFileBody::~HttpFileBody()
+{
+	if (m_file && m_owned)
+	{
+		fclose(m_file);
+	}
+}
+
+bool HttpFileBody::Read
+(
+	void* o_data,
+	size_t _size,
+	size_t* o_read
+)
+{
+	*o_read = fread(o_data, 1, _size, m_file);
+	return *o_read != 0 || !ferror(m_file);
+}
+
+bool HttpFileBody::Rewind()
+{
+	clearerr(m_file);
+	return SeekTo(m_file, m_start);
+}
+
+HttpBodyPump::HttpBodyPump
+(
+	HttpRequestBody& _body,
+	HttpProgress const& _progress,
+	size_t _bufferSize
+):
+	m_body(_body),
+	m_progress(_progress),
+	m_length(_body.Length()),
+	m_pumped(0),
+	m_sent(0),
+	m_last(0),
+	m_finished(false),
+	m_buffer(HeadRoom + _bufferSize + 2)
+{
+}
+
+std::string HttpBodyPump::Headers() const
+{
+	if (Chunked())
+	{
+		return "Transfer-Encoding: chunked\r\n";
+	}
+	char line[64];
+	snprintf(line, sizeof(line), "Content-Length: %llu\r\n", m_length);
+	return line;
+}
+
+bool HttpBodyPump::Next
+(
+	void const** o_data,
+	size_t* o_size
+)
+{
+	*o_size = 0;
+	m_last = 0;
+	if (m_finished)
+	{
+		return true;
+	}
+
+	unsigned char* data = &m_buffer[HeadRoom];
+	size_t capacity = m_buffer.size() - HeadRoom - 2;
+	if (!Chunked() && m_length - m_pumped < capacity)
+	{
+		capacity = (size_t)(m_length - m_pumped);
+	}
+
+	size_t read = 0;
+	if (capacity != 0 && !m_body.Read(data, capacity, &read))
+	{
+		return false;
+	}
+	m_pumped += read;
+	m_last = read;
+
+	if (!Chunked())
+	{
+		if (read == 0)
+		{
+			m_finished = true;
+			return m_pumped == m_length;		// false if the body was short
+		}
+		*o_data = data;
+		*o_size = read;
+		return true;
+	}
+
+	// "<size in hex>\r\n<data>\r\n", a zero size chunk ending the body. The
+	// size line goes in the room left in front of the data, so the whole
+	// chunk is one piece without copying the data
+	char line[HeadRoom];
+	int lineLength = snprintf(line, sizeof(line), "%llx\r\n", (unsigned long long)read);
+	unsigned char* chunk = data - lineLength;
+	memcpy(chunk, line, lineLength);
+	data[read] = '\r';
+	data[read + 1] = '\n';
+	*o_data = chunk;
+	*o_size = lineLength + read + 2;
+	if (read == 0)
+	{
+		m_finished = true;
+	}
+	return true;
+}
+
+void HttpBodyPump::Sent()
+{
+	m_sent += m_last;
+	m_last = 0;
+	if (m_progress)
+	{
+		m_progress(m_sent, m_length);
+	}
+}
+
+void HttpBodyPump::SentFromFile
+(
+	uint64 _size
+)
+{
+	m_pumped += _size;
+	m_sent += _size;
+	if (m_progress)
+	{
+		m_progress(m_sent, m_length);
+	}
+}
+
+bool HttpBodyPump::Rewind()
+{
+	if (m_pumped != 0 && !m_body.Rewind())
+	{
+		return false;
+	}
+	m_pumped = 0;
+	m_sent = 0;
+	m_last = 0;
+	m_finished = false;
+	return true;
+}
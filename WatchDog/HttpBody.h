@@ -0,0 +1,155 @@
+/*----------------------------------------------------------------------------
+ *  FILE: HttpBody.h
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		Where a request body comes from, read a piece at a time as it is
+ *		sent, so an upload needs no more memory than the send buffer
+ *		however big it is. A body of unknown length is sent with
+ *		Transfer-Encoding: chunked.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef _HTTPBODY_H
+#define _HTTPBODY_H
+
+#include "sha1.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <functional>
+
+class HttpRequestBody
+{
+public:
+	/// Length() of a body to be sent chunked
+	static const uint64 UnknownLength = ~0ull;
+
+	virtual ~HttpRequestBody() {}
+
+	virtual uint64 Length() const = 0;
+	/// Up to _size bytes of what comes next, *o_read 0 at the end
+	/// @return false if it couldn't be read
+	virtual bool Read(void* o_data, size_t _size, size_t* o_read) = 0;
+	/// Back to the start, for sending again; false if it can't be
+	virtual bool Rewind() { return false; }
+	/// The open file the rest of the body is read from, at its current
+	/// position, for a backend that can send straight from it; NULL if
+	/// the body isn't a plain file
+	virtual FILE* File() { return NULL; }
+};
+
+/// Progress of an upload: body bytes sent so far and the total, which is
+/// HttpRequestBody::UnknownLength for a chunked body
+typedef std::function<void(uint64 _sent, uint64 _total)> HttpProgress;
+
+/// The caller's buffer, which must last until the request is complete
+class HttpMemoryBody : public HttpRequestBody
+{
+public:
+	HttpMemoryBody(void const* _data, size_t _size);
+
+	virtual uint64 Length() const { return m_size; }
+	virtual bool Read(void* o_data, size_t _size, size_t* o_read);
+	virtual bool Rewind() { m_offset = 0; return true; }
+
+private:
+	unsigned char const* m_data;
+	size_t m_size;
+	size_t m_offset;
+};
+
+/// A file, from where it is now to the end or for _length bytes
+class HttpFileBody : public HttpRequestBody
+{
+public:
+	/// Opens _path, Failed() if it can't be
+	explicit HttpFileBody(std::string const& _path);
+	/// The caller's file, left open. _length UnknownLength sends whatever
+	/// is there when the end is reached, chunked.
+	HttpFileBody(FILE* _file, uint64 _length);
+	virtual ~HttpFileBody();
+
+	bool Failed() const { return m_file == NULL; }
+
+	virtual uint64 Length() const { return m_length; }
+	virtual bool Read(void* o_data, size_t _size, size_t* o_read);
+	virtual bool Rewind();
+	virtual FILE* File() { return m_file; }
+
+private:
+	FILE* m_file;
+	bool m_owned;
+	uint64 m_start;
+	uint64 m_length;
+};
+
+/// Each piece comes from a function, with the same contract as Read
+class HttpCallbackBody : public HttpRequestBody
+{
+public:
+	typedef std::function<bool(void* o_data, size_t _size, size_t* o_read)> Callback;
+
+	HttpCallbackBody(Callback const& _callback, uint64 _length = UnknownLength) : m_callback(_callback), m_length(_length) {}
+
+	virtual uint64 Length() const { return m_length; }
+	virtual bool Read(void* o_data, size_t _size, size_t* o_read) { return m_callback(o_data, _size, o_read); }
+
+private:
+	Callback m_callback;
+	uint64 m_length;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Turns a body into what goes on the wire after the headers: as it
+///        is if the length is known, otherwise framed as chunks. Shared by
+///        the backends, which only have to send each piece.
+class HttpBodyPump
+{
+public:
+	HttpBodyPump(HttpRequestBody& _body, HttpProgress const& _progress, size_t _bufferSize = 256 * 1024);
+
+	/// Content-Length or Transfer-Encoding, as header lines ending "\r\n"
+	std::string Headers() const;
+	bool Chunked() const { return m_length == HttpRequestBody::UnknownLength; }
+
+	/// The next bytes to send, valid until the next call. *o_size is 0 once
+	/// everything has been.
+	/// @return false if the body couldn't be read or ended before its length
+	bool Next(void const** o_data, size_t* o_size);
+	/// The piece from the last Next has gone, tell the progress callback
+	void Sent();
+
+	/// The file the rest of a body of known length is read from, for a
+	/// backend that can send straight from it instead of through Next;
+	/// NULL if there isn't one or the body is chunked
+	FILE* File() const { return Chunked() ? NULL : m_body.File(); }
+	/// _size bytes were sent straight from File(), which has been left
+	/// positioned after them
+	void SentFromFile(uint64 _size);
+	/// Start again from the beginning of the body, to send it over a fresh
+	/// connection; false if the body can't go back
+	bool Rewind();
+
+	/// Body bytes handed out by Next or sent from File(), not counting
+	/// chunk framing
+	uint64 Pumped() const { return m_pumped; }
+	/// Body bytes not handed out yet, if the length is known
+	uint64 Remaining() const { return m_length - m_pumped; }
+
+private:
+	// Room in front of the data for a chunk's size line
+	enum { HeadRoom = 16 };
+
+	HttpRequestBody& m_body;
+	HttpProgress m_progress;
+	uint64 m_length;
+	uint64 m_pumped;
+	uint64 m_sent;
+	size_t m_last;				///< body bytes in the piece from the last Next
+	bool m_finished;
+	std::vector<unsigned char> m_buffer;
+};
+
+#endif
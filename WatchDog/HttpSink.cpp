@@ -0,0 +1,200 @@
+/*----------------------------------------------------------------------------
+ *  FILE: HttpSink.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "HttpSink.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/// Extend _file to _size bytes of allocated space, leaving the position at
+/// the start. Only an optimisation, so failing is fine.
+static bool AllocateFile
+(
+	FILE* _file,
+	uint64 _size
+)
+{
+#ifdef _WIN32
+	HANDLE handle = (HANDLE)_get_osfhandle(_fileno(_file));
+	LARGE_INTEGER offset;
+	offset.QuadPart = (LONGLONG)_size;
+	bool ok = SetFilePointerEx(handle, offset, NULL, FILE_BEGIN) && SetEndOfFile(handle);
+	offset.QuadPart = 0;
+	SetFilePointerEx(handle, offset, NULL, FILE_BEGIN);
+	return ok;
+#else
+	return posix_fallocate(fileno(_file), 0, (off_t)_size) == 0;
+#endif
+}
+
+static bool TruncateFile
+(
+	FILE* _file,
+	uint64 _size
+)
+{
+	if (fflush(_file) != 0)
+	{
+		return false;
+	}
+#ifdef _WIN32
+	return _chsize_s(_fileno(_file), (long long)_size) == 0;
+#else
+	return ftruncate(fileno(_file), (off_t)_size) == 0;
+#endif
+}
+
+HttpVectorSink::HttpVectorSink
+(
+	std::vector<unsigned char>& o_body,
+	size_t _maxReserve
+):
+	m_body(o_body),
+	m_maxReserve(_maxReserve)
+{
+}
+
+bool HttpVectorSink::Begin
+(
+	uint64 _contentLength
+)
+{
+	if (_contentLength != UnknownLength)
+	{
+		uint64 wanted = m_body.size() + _contentLength;
+		m_body.reserve((size_t)((wanted < m_maxReserve) ? wanted : m_maxReserve));
+	}
+	return true;
+}
+
+bool HttpVectorSink::Write
+(
+	void const* _data,
+	size_t _size
+)
+{
+	unsigned char const* data = (unsigned char const*)_data;
+	m_body.insert(m_body.end(), data, data + _size);
+	return true;
+}
+
+HttpFileSink::HttpFileSink
+(
+	std::string const& _path
+):
+	m_path(_path),
+	m_file(NULL),
+	m_size(0),
+	m_allocated(0),
+	m_failed(false)
+{
+}
+
+HttpFileSink::~HttpFileSink()
+{
+	if (m_file)
+	{
+		End(false);
+	}
+}
+
+bool HttpFileSink::Begin
+(
+	uint64 _contentLength
+)
+{
+	m_size = 0;
+	m_allocated = 0;
+	m_file = fopen(m_path.c_str(), "wb");
+	m_failed = (m_file == NULL);
+	if (!m_failed && _contentLength != UnknownLength && _contentLength != 0 && AllocateFile(m_file, _contentLength))
+	{
+		m_allocated = _contentLength;
+	}
+	return !m_failed;
+}
+
+bool HttpFileSink::Write
+(
+	void const* _data,
+	size_t _size
+)
+{
+	if (fwrite(_data, 1, _size, m_file) != _size)
+	{
+		m_failed = true;
+		return false;
+	}
+	m_size += _size;
+	return true;
+}
+
+void HttpFileSink::End
+(
+	bool _complete
+)
+{
+	if (m_file == NULL)
+	{
+		return;
+	}
+	// The body can be shorter than Content-Length said
+	if (_complete && !m_failed && m_allocated > m_size && !TruncateFile(m_file, m_size))
+	{
+		m_failed = true;
+	}
+	if (fclose(m_file) != 0)
+	{
+		m_failed = true;
+	}
+	m_file = NULL;
+	if (!_complete || m_failed)
+	{
+		remove(m_path.c_str());
+	}
+}
+
+HttpHashSink::HttpHashSink()
+{
+	m_sha.StreamStart();
+}
+
+bool HttpHashSink::Begin
+(
+	uint64 /*_contentLength*/
+)
+{
+	m_sha.StreamStart();
+	return true;
+}
+
+bool HttpHashSink::Write
+(
+	void const* _data,
+	size_t _size
+)
+{
+	m_sha.Update(_data, _size);
+	return true;
+}
+
+void HttpHashSink::End
+(
+	bool _complete
+)
+{
+	if (_complete)
+	{
+		m_sha.Finish();
+	}
+}
@@ -0,0 +1,114 @@
+/*----------------------------------------------------------------------------
+ *  FILE: HttpSink.h
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		Where a response body goes as it arrives. The clients read through a
+ *		fixed buffer and hand each piece to the sink, so a download needs no
+ *		more memory than that buffer unless the sink keeps it.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef _HTTPSINK_H
+#define _HTTPSINK_H
+
+#include "sha1.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <functional>
+
+class HttpResponseSink
+{
+public:
+	/// Content-Length wasn't given, e.g. a chunked response
+	static const uint64 UnknownLength = ~0ull;
+
+	virtual ~HttpResponseSink() {}
+
+	/// Once the headers are in, before any Write. _contentLength is only a
+	/// hint, the body may still turn out shorter or longer.
+	virtual bool Begin(uint64 /*_contentLength*/) { return true; }
+	/// The next piece of the body; return false to abandon the request
+	virtual bool Write(void const* _data, size_t _size) = 0;
+	/// After the last Write, if Begin returned true. _complete is false if
+	/// the body was cut short, by an error or by the sink itself.
+	virtual void End(bool /*_complete*/) {}
+};
+
+/// Collects the body in memory, reserving room for it up front when the
+/// length is known (up to m_maxReserve, Content-Length is only the server's
+/// word) so it isn't reallocated as it grows
+class HttpVectorSink : public HttpResponseSink
+{
+public:
+	explicit HttpVectorSink(std::vector<unsigned char>& o_body, size_t _maxReserve = 64 << 20);
+
+	virtual bool Begin(uint64 _contentLength);
+	virtual bool Write(void const* _data, size_t _size);
+
+private:
+	std::vector<unsigned char>& m_body;
+	size_t m_maxReserve;
+};
+
+/// Writes the body to a file, which is removed again if it doesn't arrive
+/// whole. When the length is known the space is allocated up front, so the
+/// file isn't extended a piece at a time, and trimmed to what arrived at
+/// the end.
+class HttpFileSink : public HttpResponseSink
+{
+public:
+	explicit HttpFileSink(std::string const& _path);
+	virtual ~HttpFileSink();
+
+	virtual bool Begin(uint64 _contentLength);
+	virtual bool Write(void const* _data, size_t _size);
+	virtual void End(bool _complete);
+
+	/// The file couldn't be created or written
+	bool Failed() const { return m_failed; }
+	uint64 Size() const { return m_size; }
+
+private:
+	std::string m_path;
+	FILE* m_file;
+	uint64 m_size;
+	uint64 m_allocated;
+	bool m_failed;
+};
+
+/// SHA-1 of the body, which isn't kept
+class HttpHashSink : public HttpResponseSink
+{
+public:
+	HttpHashSink();
+
+	virtual bool Begin(uint64 _contentLength);
+	virtual bool Write(void const* _data, size_t _size);
+	virtual void End(bool _complete);
+
+	/// Valid once End has been called with _complete true
+	Sha1Digest Digest() const { return m_sha.Digest(); }
+	uint64 Size() const { return m_sha.m_totalSize; }
+
+private:
+	fSHA1 m_sha;
+};
+
+/// Each piece goes to a function, which returns false to abandon the request
+class HttpCallbackSink : public HttpResponseSink
+{
+public:
+	typedef std::function<bool(void const* _data, size_t _size)> Callback;
+
+	explicit HttpCallbackSink(Callback const& _callback) : m_callback(_callback) {}
+
+	virtual bool Write(void const* _data, size_t _size) { return m_callback(_data, _size); }
+
+private:
+	Callback m_callback;
+};
+
+#endif
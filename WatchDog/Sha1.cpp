@@ -9,13 +9,15 @@
  */
 
 #include "SHA1.h"
+#include "Sha1Kernels.h"
+#include "Sha1Constexpr.h"
 #include <memory.h>
 #include <stdio.h>
 
 //F_DEFINE_DEBUG_SECTION(fSHA1)
 
 typedef unsigned char uint8;
-typedef unsigned long uint32;
+typedef fUInt32 uint32;
 typedef unsigned uint;
 
 template<unsigned N> static inline uint32 LeftRotate(uint32 _value) { return (_value << N) | (_value >> (32 - N)); }
@@ -27,22 +29,27 @@ void fSHA1::StreamStart()
 	m_hash[2] = 0x98BADCFE;
 	m_hash[3] = 0x10325476;
 	m_hash[4] = 0xC3D2E1F0;
+	m_bufferSize = 0;
+	m_totalSize = 0;
 }
 
-void fSHA1::StreamBlock(void const* _data, fSizeType _size)
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Portable compression function, used when no SIMD kernel is available
+/// @param _hash The five hash words to update
+/// @param _data The message blocks
+/// @param _blocks Number of 64 byte blocks in _data
+void fSHA1_BlocksScalar(fUInt32* _hash, uint8 const* _data, fSizeType _blocks)
 {
-//	fAssert(_size % 64 == 0); // Required chunk size
-	uint8* data = (uint8*)_data;
+	uint8 const* data = _data;
 	uint32 w[80];
 
-	while(_size > 0)
+	while(_blocks > 0)
 	{
 		// Read data as big-endian
 		for (uint i = 0; i < 16; i++)
 		{
 			w[i] = (uint32)((data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3]);
 			data += 4;
-			_size -= 4;
 		}
 
 		// Extend to 80 words
@@ -51,11 +58,11 @@ void fSHA1::StreamBlock(void const* _data, fSizeType _size)
 			w[i] = LeftRotate<1>(w[i-3] ^ w[i-8] ^ w[i-14] ^ w[i-16]);
 		}
 
-		uint32 a = m_hash[0];
-		uint32 b = m_hash[1];
-		uint32 c = m_hash[2];
-		uint32 d = m_hash[3];
-		uint32 e = m_hash[4];
+		uint32 a = _hash[0];
+		uint32 b = _hash[1];
+		uint32 c = _hash[2];
+		uint32 d = _hash[3];
+		uint32 e = _hash[4];
 
 #define F_SHA1_MAIN(k, f)												\
 		{																\
@@ -74,14 +81,49 @@ void fSHA1::StreamBlock(void const* _data, fSizeType _size)
 
 #undef F_SHA1_MAIN
 
-		m_hash[0] += a;
-		m_hash[1] += b;
-		m_hash[2] += c;
-		m_hash[3] += d;
-		m_hash[4] += e;
+		_hash[0] += a;
+		_hash[1] += b;
+		_hash[2] += c;
+		_hash[3] += d;
+		_hash[4] += e;
+
+		--_blocks;
 	}
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Pick the fastest compression function the CPU supports
+static fSHA1Kernel SelectKernel(char const** o_name)
+{
+	if (fSHA1_CpuHasSHANI())
+	{
+		*o_name = "sha-ni";
+		return &fSHA1_BlocksSHANI;
+	}
+	if (fSHA1_CpuHasSSSE3())
+	{
+		*o_name = "ssse3";
+		return &fSHA1_BlocksSSSE3;
+	}
+	*o_name = "scalar";
+	return &fSHA1_BlocksScalar;
+}
+
+static char const* s_kernelName = "scalar";
+
+static fSHA1Kernel GetKernel()
+{
+	// Selected once, on first use
+	static fSHA1Kernel const s_kernel = SelectKernel(&s_kernelName);
+	return s_kernel;
+}
+
+void fSHA1::StreamBlock(void const* _data, fSizeType _size)
+{
+//	fAssert(_size % 64 == 0); // Required chunk size
+	GetKernel()(m_hash, (uint8 const*)_data, _size / 64);
+}
+
 void fSHA1::StreamFinal(void const* _data, fSizeType _size, uint64 _totalSize)
 {
 	uint tailSize = _size % 64;
@@ -107,6 +149,113 @@ void fSHA1::StreamFinal(void const* _data, fSizeType _size, uint64 _totalSize)
 	StreamBlock(w, paddedSize);
 }
 
+void fSHA1::Update(void const* _data, fSizeType _size)
+{
+	uint8 const* data = (uint8 const*)_data;
+	m_totalSize += _size;
+
+	// Top up a partial block left from the previous call first
+	if (m_bufferSize > 0)
+	{
+		fSizeType fill = 64 - m_bufferSize;
+		if (fill > _size)
+		{
+			fill = _size;
+		}
+		memcpy(m_buffer + m_bufferSize, data, fill);
+		m_bufferSize += (uint32)fill;
+		data += fill;
+		_size -= fill;
+
+		if (m_bufferSize < 64)
+		{
+			return;
+		}
+		StreamBlock(m_buffer, 64);
+		m_bufferSize = 0;
+	}
+
+	// Whole blocks straight from the caller's memory
+	fSizeType wholeBlocks = _size - (_size % 64);
+	if (wholeBlocks > 0)
+	{
+		StreamBlock(data, wholeBlocks);
+		data += wholeBlocks;
+		_size -= wholeBlocks;
+	}
+
+	if (_size > 0)
+	{
+		memcpy(m_buffer, data, _size);
+		m_bufferSize = (uint32)_size;
+	}
+}
+
+void fSHA1::Finish()
+{
+	StreamFinal(m_buffer, m_bufferSize, m_totalSize);
+	m_bufferSize = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Write the state of a byte API stream to StateSize bytes: the hash
+///        words big-endian, the byte count little-endian and then the tail
+///        (zero padded to 64 bytes)
+/// @param o_state Receives the state
+void fSHA1::SaveState(uint8* o_state) const
+{
+	uint8* out = o_state;
+	for (uint w = 0; w < 5; ++w)
+	{
+		*out++ = (uint8)(m_hash[w] >> 24);
+		*out++ = (uint8)(m_hash[w] >> 16);
+		*out++ = (uint8)(m_hash[w] >> 8);
+		*out++ = (uint8)(m_hash[w]);
+	}
+	for (uint i = 0; i < 8; ++i)
+	{
+		*out++ = (uint8)(m_totalSize >> (i * 8));
+	}
+	memset(out, 0, 64);
+	memcpy(out, m_buffer, m_bufferSize);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Carry on a stream saved by SaveState. Update() and Finish() then
+///        behave as if they were called on the original object
+/// @param _state StateSize bytes from SaveState
+/// @return false if the state is inconsistent, the object is unchanged
+bool fSHA1::LoadState(uint8 const* _state)
+{
+	uint8 const* in = _state + 5 * 4;
+	uint64 totalSize = 0;
+	for (uint i = 0; i < 8; ++i)
+	{
+		totalSize |= (uint64)in[i] << (i * 8);
+	}
+	in += 8;
+
+	// The tail is whatever is left over after the whole blocks, anything
+	// after it must still be zero
+	uint32 bufferSize = (uint32)(totalSize % 64);
+	for (uint i = bufferSize; i < 64; ++i)
+	{
+		if (in[i] != 0)
+		{
+			return false;
+		}
+	}
+
+	for (uint w = 0; w < 5; ++w)
+	{
+		m_hash[w] = ((uint32)_state[w * 4] << 24) | ((uint32)_state[w * 4 + 1] << 16) | ((uint32)_state[w * 4 + 2] << 8) | _state[w * 4 + 3];
+	}
+	m_totalSize = totalSize;
+	m_bufferSize = bufferSize;
+	memcpy(m_buffer, in, 64);
+	return true;
+}
+
 fSHA1 fSHA1::ComputeHash(void const* _data, fSizeType _size)
 {
 	fSHA1 sha1;
@@ -116,9 +265,29 @@ fSHA1 fSHA1::ComputeHash(void const* _data, fSizeType _size)
 }
 
 
+char const *fSHA1::KernelName()
+{
+	GetKernel();
+	return s_kernelName;
+}
+
+Sha1Digest fSHA1::Digest() const
+{
+	return Sha1Digest::FromWords(m_hash);
+}
+
 char const *fSHA1::ToString()
 {
-	sprintf( &m_formatted[0], "%08X%08X%08X%08X%08X", m_hash[0], m_hash[1], m_hash[2], m_hash[3], m_hash[4]);
+	Digest().ToHex(&m_formatted[0]);
     return &m_formatted[0];
 }
 
+// fSHA1Constexpr must agree with the code above. These are the FIPS 180 test
+// vectors plus the padding edge cases (55 bytes is the most that fits in one
+// block with its padding, 64 needs a second block just for the padding),
+// all of which fSHA1::ComputeHash produces.
+static_assert(fSHA1Constexpr::Equal(fSHA1Constexpr::Hash(""), fSHA1Constexpr::FromHex("DA39A3EE5E6B4B0D3255BFEF95601890AFD80709")), "constexpr SHA-1 of empty input");
+static_assert(fSHA1Constexpr::Equal(fSHA1Constexpr::Hash("abc"), fSHA1Constexpr::FromHex("A9993E364706816ABA3E25717850C26C9CD0D89D")), "constexpr SHA-1 of abc");
+static_assert(fSHA1Constexpr::Equal(fSHA1Constexpr::Hash("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"), fSHA1Constexpr::FromHex("84983E441C3BD26EBAAE4AA1F95129E5E54670F1")), "constexpr SHA-1 of two blocks");
+static_assert(fSHA1Constexpr::Equal(fSHA1Constexpr::Hash("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"), fSHA1Constexpr::FromHex("C1C8BBDC22796E28C0E15163D20899B65621D65A")), "constexpr SHA-1 of 55 bytes");
+static_assert(fSHA1Constexpr::Equal(fSHA1Constexpr::Hash("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"), fSHA1Constexpr::FromHex("0098BA824B5C16427BD7A1122A5A442A25EC644D")), "constexpr SHA-1 of 64 bytes");
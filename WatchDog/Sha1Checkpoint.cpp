@@ -0,0 +1,239 @@
+/*----------------------------------------------------------------------------
+ *  FILE: Sha1Checkpoint.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "Sha1Checkpoint.h"
+#include "AtomicFile.h"
+#include "HashCache.h"
+#include <memory.h>
+#include <stdio.h>
+#include <vector>
+
+typedef unsigned char uint8;
+
+static char const CheckpointMagic[8] = { 'F', 'S', 'H', 'A', '1', 'C', 'K', 'P' };
+static const unsigned CheckpointVersion = 3;
+static const unsigned CheckpointSourceSize = 5 * 8;
+static const unsigned CheckpointBodySize = 8 + 4 + CheckpointSourceSize + fSHA1::StateSize;
+static const unsigned CheckpointSize = CheckpointBodySize + 20;
+
+static void PutDigest(uint8* o_data, fSHA1 const& _digest)
+{
+	for (unsigned w = 0; w < 5; ++w)
+	{
+		o_data[w * 4 + 0] = (uint8)(_digest.m_hash[w] >> 24);
+		o_data[w * 4 + 1] = (uint8)(_digest.m_hash[w] >> 16);
+		o_data[w * 4 + 2] = (uint8)(_digest.m_hash[w] >> 8);
+		o_data[w * 4 + 3] = (uint8)(_digest.m_hash[w]);
+	}
+}
+
+static void PutUint64(uint8* o_data, uint64 _value)
+{
+	for (unsigned i = 0; i < 8; ++i)
+	{
+		o_data[i] = (uint8)(_value >> (i * 8));
+	}
+}
+
+static uint64 GetUint64(uint8 const* _data)
+{
+	uint64 value = 0;
+	for (unsigned i = 0; i < 8; ++i)
+	{
+		value |= (uint64)_data[i] << (i * 8);
+	}
+	return value;
+}
+
+bool fSHA1SaveCheckpoint
+(
+	std::string const& _path,
+	fSHA1Checkpoint const& _checkpoint
+)
+{
+	uint8 data[CheckpointSize];
+	memcpy(data, CheckpointMagic, 8);
+	for (unsigned i = 0; i < 4; ++i)
+	{
+		data[8 + i] = (uint8)(CheckpointVersion >> (i * 8));
+	}
+	PutUint64(data + 12, _checkpoint.m_volume);
+	PutUint64(data + 20, _checkpoint.m_fileIndex);
+	PutUint64(data + 28, _checkpoint.m_tailSize);
+	PutUint64(data + 36, _checkpoint.m_tail.m_high);
+	PutUint64(data + 44, _checkpoint.m_tail.m_low);
+	_checkpoint.m_stream.SaveState(data + 12 + CheckpointSourceSize);
+	PutDigest(data + CheckpointBodySize, fSHA1::ComputeHash(data, CheckpointBodySize));
+
+	return AtomicWriteFile(_path, data, sizeof(data));
+}
+
+bool fSHA1LoadCheckpoint
+(
+	std::string const& _path,
+	fSHA1Checkpoint* o_checkpoint
+)
+{
+	FILE* file = fopen(_path.c_str(), "rb");
+	if (file == NULL)
+	{
+		return false;
+	}
+	uint8 data[CheckpointSize + 1];
+	size_t dataread = fread(data, 1, sizeof(data), file);
+	fclose(file);
+
+	if (dataread != CheckpointSize || memcmp(data, CheckpointMagic, 8) != 0)
+	{
+		return false;
+	}
+	unsigned version = data[8] | (data[9] << 8) | (data[10] << 16) | ((unsigned)data[11] << 24);
+	if (version != CheckpointVersion)
+	{
+		return false;
+	}
+	uint8 check[20];
+	PutDigest(check, fSHA1::ComputeHash(data, CheckpointBodySize));
+	if (memcmp(check, data + CheckpointBodySize, 20) != 0)
+	{
+		return false;
+	}
+
+	o_checkpoint->m_volume = GetUint64(data + 12);
+	o_checkpoint->m_fileIndex = GetUint64(data + 20);
+	o_checkpoint->m_tailSize = GetUint64(data + 28);
+	o_checkpoint->m_tail.m_high = GetUint64(data + 36);
+	o_checkpoint->m_tail.m_low = GetUint64(data + 44);
+	return o_checkpoint->m_stream.LoadState(data + 12 + CheckpointSourceSize);
+}
+
+static bool SeekTo(FILE* _file, uint64 _offset)
+{
+#ifdef _WIN32
+	return _fseeki64(_file, (long long)_offset, SEEK_SET) == 0;
+#else
+	return fseeko(_file, (off_t)_offset, SEEK_SET) == 0;
+#endif
+}
+
+static uint64 FileSize(FILE* _file)
+{
+#ifdef _WIN32
+	_fseeki64(_file, 0, SEEK_END);
+	long long size = _ftelli64(_file);
+#else
+	fseeko(_file, 0, SEEK_END);
+	long long size = (long long)ftello(_file);
+#endif
+	return (size > 0) ? (uint64)size : 0;
+}
+
+static void SetTail(fSHA1Checkpoint* io_checkpoint, void const* _data, size_t _size)
+{
+	io_checkpoint->m_tailSize = _size;
+	io_checkpoint->m_tail = fXXH3::ComputeHash(_data, _size).m_hash128;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Whether _checkpoint can be carried on from in _file, which it is then
+/// positioned for. _buffer has room for any tail written by this code.
+static bool CanResume(FILE* _file, FileIdentity const& _identity, fSHA1Checkpoint const& _checkpoint, std::vector<uint8>& _buffer)
+{
+	uint64 offset = _checkpoint.m_stream.m_totalSize;
+	if (_checkpoint.m_volume != _identity.m_volume || _checkpoint.m_fileIndex != _identity.m_fileIndex ||
+		offset > FileSize(_file) || _checkpoint.m_tailSize > offset || _checkpoint.m_tailSize > _buffer.size())
+	{
+		return false;
+	}
+	size_t tailSize = (size_t)_checkpoint.m_tailSize;
+	if (!SeekTo(_file, offset - tailSize) || fread(&_buffer[0], 1, tailSize, _file) != tailSize)
+	{
+		return false;
+	}
+	return fXXH3::ComputeHash(&_buffer[0], tailSize).m_hash128 == _checkpoint.m_tail;
+}
+
+bool fSHA1HashFileResumable
+(
+	std::string const& _path,
+	std::string const& _checkpointPath,
+	uint64 _checkpointInterval,
+	fSHA1* o_digest,
+	uint64* o_resumedFrom
+)
+{
+	FileIdentity identity;
+	if (!FileIdentity::Get(_path, &identity))
+	{
+		return false;
+	}
+	FILE* file = fopen(_path.c_str(), "rb");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	const size_t buffsize = 1024 * 1024;
+	std::vector<uint8> buffer(buffsize);
+
+	// Another file in its place, or this one rewritten up to the checkpoint,
+	// and it is hashed from the start
+	fSHA1Checkpoint checkpoint;
+	if (!fSHA1LoadCheckpoint(_checkpointPath, &checkpoint) || !CanResume(file, identity, checkpoint, buffer))
+	{
+		checkpoint = fSHA1Checkpoint();
+		checkpoint.m_volume = identity.m_volume;
+		checkpoint.m_fileIndex = identity.m_fileIndex;
+		checkpoint.m_stream.StreamStart();
+		if (!SeekTo(file, 0))
+		{
+			fclose(file);
+			return false;
+		}
+	}
+	fSHA1& stream = checkpoint.m_stream;
+	if (o_resumedFrom != NULL)
+	{
+		*o_resumedFrom = stream.m_totalSize;
+	}
+
+	uint64 nextCheckpoint = stream.m_totalSize + _checkpointInterval;
+	bool ok = true;
+
+	size_t dataread;
+	while ((dataread = fread(&buffer[0], 1, buffsize, file)) > 0)
+	{
+		stream.Update(&buffer[0], dataread);
+		SetTail(&checkpoint, &buffer[0], dataread);
+		if (_checkpointInterval > 0 && stream.m_totalSize >= nextCheckpoint)
+		{
+			fSHA1SaveCheckpoint(_checkpointPath, checkpoint);
+			nextCheckpoint = stream.m_totalSize + _checkpointInterval;
+		}
+	}
+	if (ferror(file))
+	{
+		ok = false;
+	}
+	fclose(file);
+
+	// Written to while being read, the digest would be of neither version
+	FileIdentity after;
+	if (ok && (!FileIdentity::Get(_path, &after) || after != identity))
+	{
+		ok = false;
+	}
+
+	if (ok)
+	{
+		fSHA1SaveCheckpoint(_checkpointPath, checkpoint);
+		*o_digest = stream;
+		o_digest->Finish();
+	}
+	return ok;
+}
@@ -0,0 +1,77 @@
+/*----------------------------------------------------------------------------
+ *  FILE: Sha1Checkpoint.h
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		Resumable SHA-1 of large files. The fSHA1 stream state is saved to a
+ *		small sidecar file every so often, so an interrupted hash (or one of a
+ *		file still being downloaded) carries on from the last checkpoint
+ *		rather than from the start of the file.
+ *
+ *		A checkpoint is only resumed for the same file (volume and file
+ *		index), no shorter than the checkpoint, and whose last piece before
+ *		the checkpoint still has the XXH3 digest it had when that was read.
+ *		A file that has only been appended to carries on; one that has been
+ *		replaced, or changed just before the checkpoint, is hashed from the
+ *		start. Earlier changes in the same file aren't noticed, this is for
+ *		files written front to back.
+ *
+ *		Sidecar layout, 164 bytes:
+ *			"FSHA1CKP"						8 byte magic
+ *			version							uint32 little-endian, currently 3
+ *			volume, file index				uint64 little-endian each
+ *			tail size						uint64 little-endian
+ *			tail digest						XXH3-128, high then low word,
+ *											uint64 little-endian each
+ *			state							fSHA1::StateSize bytes from SaveState
+ *			check							SHA-1 of everything before it
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef _FSHA1CHECKPOINT_H
+#define _FSHA1CHECKPOINT_H
+
+#include "sha1.h"
+#include "Xxh3.h"
+#include <string>
+
+struct fSHA1Checkpoint
+{
+	uint64 m_volume;			// which file it was taken of, as in FileIdentity
+	uint64 m_fileIndex;
+	uint64 m_tailSize;			// the last m_tailSize bytes before the checkpoint
+	Xxh3Digest128 m_tail;		// and their digest, to tell they are still there
+	fSHA1 m_stream;				// everything up to m_stream.m_totalSize
+
+	fSHA1Checkpoint() : m_volume(0), m_fileIndex(0), m_tailSize(0) {}
+};
+
+/// Save a checkpoint of a byte API stream (see fSHA1::SaveState). The file
+/// is replaced atomically so a crash never leaves a half written checkpoint.
+bool fSHA1SaveCheckpoint(std::string const& _path, fSHA1Checkpoint const& _checkpoint);
+
+/// Load a checkpoint saved by fSHA1SaveCheckpoint. Returns false if the
+/// file is missing, the wrong version or damaged.
+bool fSHA1LoadCheckpoint(std::string const& _path, fSHA1Checkpoint* o_checkpoint);
+
+////////////////////////////////////////////////////////////////////////////////
+/// Hash _path, starting from the checkpoint in _checkpointPath if it holds
+/// one that fits the file, and saving a new checkpoint every
+/// _checkpointInterval bytes and at the end of the file. The checkpoint is
+/// left behind so a file that is still growing can be carried on later;
+/// delete it once the file is complete.
+/// Fails if the file was written to while it was being read, as the digest
+/// would be of neither version; the checkpoints saved on the way are kept.
+/// @param o_digest The digest of the whole file as it is now
+/// @param o_resumedFrom Optional, receives the offset hashing restarted at
+bool fSHA1HashFileResumable
+(
+	std::string const& _path,
+	std::string const& _checkpointPath,
+	uint64 _checkpointInterval,
+	fSHA1* o_digest,
+	uint64* o_resumedFrom
+);
+
+#endif
@@ -0,0 +1,154 @@
+/*----------------------------------------------------------------------------
+ *  FILE: Sha1Constexpr.h
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		SHA-1 evaluated by the compiler, for digests of literals and other
+ *		build time constants. Produces exactly what fSHA1 does at runtime:
+ *
+ *			constexpr Sha1Digest s_known = fSHA1Constexpr::Hash("abc");
+ *			constexpr Sha1Digest s_expected = fSHA1Constexpr::FromHex("A9993E364706816ABA3E25717850C26C9CD0D89D");
+ *			static_assert(fSHA1Constexpr::Equal(s_known, s_expected), "");
+ *
+ *		Only the digest bytes end up in the binary, not the input. Meant for
+ *		short inputs; long ones will hit the compiler's constexpr step limit.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef _FSHA1CONSTEXPR_H
+#define _FSHA1CONSTEXPR_H
+
+#include "Sha1Digest.h"
+
+namespace fSHA1Constexpr
+{
+	typedef unsigned int uint32;
+	typedef unsigned long long uint64;
+
+	constexpr uint32 LeftRotate(uint32 _value, unsigned _bits)
+	{
+		return (_value << _bits) | (_value >> (32 - _bits));
+	}
+
+	/// Byte _index of the padded message: the data, 0x80, zeros and the
+	/// length in bits big-endian in the last 8 bytes
+	template<typename T>
+	constexpr unsigned char PaddedByte(T const* _data, size_t _size, size_t _paddedSize, size_t _index)
+	{
+		return (_index < _size) ? (unsigned char)_data[_index] :
+			(_index == _size) ? (unsigned char)0x80 :
+			(_index >= _paddedSize - 8) ? (unsigned char)(((uint64)_size * 8) >> ((_paddedSize - 1 - _index) * 8)) :
+			(unsigned char)0;
+	}
+
+	template<typename T>
+	constexpr Sha1Digest HashBytes(T const* _data, size_t _size)
+	{
+		uint32 hash[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+		size_t paddedSize = ((_size + 8) / 64 + 1) * 64;
+
+		for (size_t block = 0; block < paddedSize; block += 64)
+		{
+			uint32 w[80] = {};
+			for (unsigned i = 0; i < 16; ++i)
+			{
+				w[i] = ((uint32)PaddedByte(_data, _size, paddedSize, block + i * 4) << 24) |
+					((uint32)PaddedByte(_data, _size, paddedSize, block + i * 4 + 1) << 16) |
+					((uint32)PaddedByte(_data, _size, paddedSize, block + i * 4 + 2) << 8) |
+					(uint32)PaddedByte(_data, _size, paddedSize, block + i * 4 + 3);
+			}
+			for (unsigned i = 16; i < 80; ++i)
+			{
+				w[i] = LeftRotate(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+			}
+
+			uint32 a = hash[0], b = hash[1], c = hash[2], d = hash[3], e = hash[4];
+			for (unsigned i = 0; i < 80; ++i)
+			{
+				uint32 f = 0, k = 0;
+				if (i < 20)
+				{
+					f = (b & c) | (~b & d);
+					k = 0x5A827999;
+				}
+				else if (i < 40)
+				{
+					f = b ^ c ^ d;
+					k = 0x6ED9EBA1;
+				}
+				else if (i < 60)
+				{
+					f = (b & c) | (b & d) | (c & d);
+					k = 0x8F1BBCDC;
+				}
+				else
+				{
+					f = b ^ c ^ d;
+					k = 0xCA62C1D6;
+				}
+				uint32 temp = LeftRotate(a, 5) + f + e + k + w[i];
+				e = d;
+				d = c;
+				c = LeftRotate(b, 30);
+				b = a;
+				a = temp;
+			}
+			hash[0] += a;
+			hash[1] += b;
+			hash[2] += c;
+			hash[3] += d;
+			hash[4] += e;
+		}
+
+		Sha1Digest result;
+		for (unsigned i = 0; i < Sha1Digest::Size; ++i)
+		{
+			result.m_bytes[i] = (unsigned char)(hash[i / 4] >> ((3 - i % 4) * 8));
+		}
+		return result;
+	}
+
+	/// Digest of a string literal, not including its terminating zero
+	template<size_t N>
+	constexpr Sha1Digest Hash(char const (&_literal)[N])
+	{
+		return HashBytes(_literal, N - 1);
+	}
+
+	constexpr unsigned char HexNibble(char _c)
+	{
+		return (_c >= '0' && _c <= '9') ? (unsigned char)(_c - '0') :
+			(_c >= 'A' && _c <= 'F') ? (unsigned char)(_c - 'A' + 10) :
+			(_c >= 'a' && _c <= 'f') ? (unsigned char)(_c - 'a' + 10) :
+			throw "not a hex digit";
+	}
+
+	/// A digest written as 40 hex digits. Anything else fails to compile
+	/// when used in a constant expression.
+	template<size_t N>
+	constexpr Sha1Digest FromHex(char const (&_hex)[N])
+	{
+		static_assert(N == Sha1Digest::HexLength + 1, "a SHA-1 digest is 40 hex digits");
+		Sha1Digest result;
+		for (unsigned i = 0; i < Sha1Digest::Size; ++i)
+		{
+			result.m_bytes[i] = (unsigned char)((HexNibble(_hex[i * 2]) << 4) | HexNibble(_hex[i * 2 + 1]));
+		}
+		return result;
+	}
+
+	constexpr bool Equal(Sha1Digest const& _a, Sha1Digest const& _b)
+	{
+		for (unsigned i = 0; i < Sha1Digest::Size; ++i)
+		{
+			if (_a.m_bytes[i] != _b.m_bytes[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+#endif
@@ -0,0 +1,124 @@
+/*----------------------------------------------------------------------------
+ *  FILE: Sha1Digest.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "Sha1Digest.h"
+
+// SSE2 is part of x64 and the default for 32 bit MSVC builds, so there's no
+// need for a runtime check
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define F_SHA1_HEX_SSE2 (1)
+#include <emmintrin.h>
+#else
+#define F_SHA1_HEX_SSE2 (0)
+#endif
+
+typedef unsigned char uint8;
+
+static char const s_upperDigits[] = "0123456789ABCDEF";
+static char const s_lowerDigits[] = "0123456789abcdef";
+
+Sha1Digest Sha1Digest::FromWords(unsigned int const* _words)
+{
+	Sha1Digest result;
+	for (unsigned w = 0; w < 5; ++w)
+	{
+		result.m_bytes[w * 4 + 0] = (uint8)(_words[w] >> 24);
+		result.m_bytes[w * 4 + 1] = (uint8)(_words[w] >> 16);
+		result.m_bytes[w * 4 + 2] = (uint8)(_words[w] >> 8);
+		result.m_bytes[w * 4 + 3] = (uint8)(_words[w]);
+	}
+	return result;
+}
+
+#if F_SHA1_HEX_SSE2
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Hex encode 16 bytes to 32 characters
+static inline void HexEncode16(uint8 const* _in, char* o_hex, bool _lowerCase)
+{
+	__m128i bytes = _mm_loadu_si128((__m128i const*)_in);
+	__m128i mask = _mm_set1_epi8(0x0F);
+	__m128i hi = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+	__m128i lo = _mm_and_si128(bytes, mask);
+
+	// Interleave so each byte's high nibble comes first
+	__m128i first = _mm_unpacklo_epi8(hi, lo);
+	__m128i second = _mm_unpackhi_epi8(hi, lo);
+
+	// '0' + n, plus the gap up to 'A' or 'a' for n > 9
+	__m128i nine = _mm_set1_epi8(9);
+	__m128i zero = _mm_set1_epi8('0');
+	__m128i gap = _mm_set1_epi8(_lowerCase ? 'a' - '0' - 10 : 'A' - '0' - 10);
+	first = _mm_add_epi8(_mm_add_epi8(first, zero), _mm_and_si128(_mm_cmpgt_epi8(first, nine), gap));
+	second = _mm_add_epi8(_mm_add_epi8(second, zero), _mm_and_si128(_mm_cmpgt_epi8(second, nine), gap));
+
+	_mm_storeu_si128((__m128i*)o_hex, first);
+	_mm_storeu_si128((__m128i*)(o_hex + 16), second);
+}
+#endif
+
+void Sha1Digest::ToHex(char* o_hex, bool _lowerCase) const
+{
+	char const* digits = _lowerCase ? s_lowerDigits : s_upperDigits;
+	unsigned start = 0;
+#if F_SHA1_HEX_SSE2
+	HexEncode16(m_bytes, o_hex, _lowerCase);
+	start = 16;
+#endif
+	for (unsigned i = start; i < Size; ++i)
+	{
+		o_hex[i * 2] = digits[m_bytes[i] >> 4];
+		o_hex[i * 2 + 1] = digits[m_bytes[i] & 0x0F];
+	}
+	o_hex[HexLength] = 0;
+}
+
+std::string Sha1Digest::ToString(bool _lowerCase) const
+{
+	char hex[HexLength + 1];
+	ToHex(hex, _lowerCase);
+	return std::string(hex, HexLength);
+}
+
+static inline int HexValue(char _c)
+{
+	if (_c >= '0' && _c <= '9')
+	{
+		return _c - '0';
+	}
+	if (_c >= 'A' && _c <= 'F')
+	{
+		return _c - 'A' + 10;
+	}
+	if (_c >= 'a' && _c <= 'f')
+	{
+		return _c - 'a' + 10;
+	}
+	return -1;
+}
+
+bool Sha1Digest::Parse(char const* _hex, size_t _length, Sha1Digest* o_digest)
+{
+	if (_length != HexLength)
+	{
+		return false;
+	}
+
+	Sha1Digest result;
+	for (unsigned i = 0; i < Size; ++i)
+	{
+		int hi = HexValue(_hex[i * 2]);
+		int lo = HexValue(_hex[i * 2 + 1]);
+		if (hi < 0 || lo < 0)
+		{
+			return false;
+		}
+		result.m_bytes[i] = (uint8)((hi << 4) | lo);
+	}
+	*o_digest = result;
+	return true;
+}
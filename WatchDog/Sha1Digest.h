@@ -0,0 +1,83 @@
+/*----------------------------------------------------------------------------
+ *  FILE: Sha1Digest.h
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		A finished SHA-1 as 20 raw bytes, in the order they are printed.
+ *		Cheap to copy, compare, order and hash, so it can be used directly as
+ *		a key in sets and hash tables. Hex only comes into it when a digest
+ *		is read from or written for a human.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef _SHA1DIGEST_H
+#define _SHA1DIGEST_H
+
+#include <stddef.h>
+#include <string.h>
+#include <functional>
+#include <string>
+
+struct Sha1Digest
+{
+	enum { Size = 20, HexLength = 40 };
+
+	unsigned char m_bytes[Size];
+
+	// constexpr so digests can be computed and stored at compile time, see Sha1Constexpr.h
+	constexpr Sha1Digest() :
+		m_bytes()
+	{
+	}
+
+	/// From the five hash words of an fSHA1
+	static Sha1Digest FromWords(unsigned int const* _words);
+
+	bool operator==(Sha1Digest const& _other) const
+	{
+		return memcmp(m_bytes, _other.m_bytes, Size) == 0;
+	}
+	bool operator!=(Sha1Digest const& _other) const
+	{
+		return memcmp(m_bytes, _other.m_bytes, Size) != 0;
+	}
+	bool operator<(Sha1Digest const& _other) const
+	{
+		return memcmp(m_bytes, _other.m_bytes, Size) < 0;
+	}
+
+	/// The digest is already uniformly distributed, so any of its bytes make
+	/// a good hash
+	size_t Hash() const
+	{
+		size_t result;
+		memcpy(&result, m_bytes, sizeof(result));
+		return result;
+	}
+
+	/// Write HexLength characters plus a terminating zero to o_hex
+	void ToHex(char* o_hex, bool _lowerCase = false) const;
+	std::string ToString(bool _lowerCase = false) const;
+
+	/// Parse exactly HexLength hex digits of either case. Returns false,
+	/// leaving o_digest unchanged, for anything else.
+	static bool Parse(char const* _hex, size_t _length, Sha1Digest* o_digest);
+	static bool Parse(std::string const& _hex, Sha1Digest* o_digest)
+	{
+		return Parse(_hex.data(), _hex.size(), o_digest);
+	}
+};
+
+namespace std
+{
+	template<> struct hash<Sha1Digest>
+	{
+		size_t operator()(Sha1Digest const& _digest) const
+		{
+			return _digest.Hash();
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,49 @@
+/*----------------------------------------------------------------------------
+ *  FILE: Sha1Kernels.h
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		SHA-1 compression kernels shared by fSHA1 and its SIMD variants.
+ *		Each kernel consumes whole 64 byte blocks and updates the five
+ *		hash words in place; they all produce identical results.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef _FSHA1KERNELS_H
+#define _FSHA1KERNELS_H
+
+#include "sha1.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define F_SHA1_X86 (1)
+#else
+#define F_SHA1_X86 (0)
+#endif
+
+// MSVC allows any intrinsic in any function, gcc/clang need to be told which
+// instruction sets a function may use.
+#if defined(__GNUC__)
+#define F_SHA1_TARGET(_isa) __attribute__((target(_isa)))
+#else
+#define F_SHA1_TARGET(_isa)
+#endif
+
+typedef void (*fSHA1Kernel)(fUInt32* _hash, unsigned char const* _data, fSizeType _blocks);
+
+void fSHA1_BlocksScalar(fUInt32* _hash, unsigned char const* _data, fSizeType _blocks);
+void fSHA1_BlocksSSSE3(fUInt32* _hash, unsigned char const* _data, fSizeType _blocks);
+void fSHA1_BlocksSHANI(fUInt32* _hash, unsigned char const* _data, fSizeType _blocks);
+
+// Multi-buffer kernels. _state holds word w of lane l at _state[w * lanes + l],
+// each lane reads _blocks blocks from its own pointer, which is advanced.
+typedef void (*fSHA1MultiKernel)(fUInt32* _state, unsigned char const** _data, fSizeType _blocks);
+
+void fSHA1_BlocksX4SSSE3(fUInt32* _state, unsigned char const** _data, fSizeType _blocks);
+void fSHA1_BlocksX8AVX2(fUInt32* _state, unsigned char const** _data, fSizeType _blocks);
+
+bool fSHA1_CpuHasSSSE3();
+bool fSHA1_CpuHasSHANI();
+bool fSHA1_CpuHasAVX2();
+
+#endif
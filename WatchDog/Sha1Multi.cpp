@@ -0,0 +1,396 @@
+/*----------------------------------------------------------------------------
+ *  FILE: Sha1Multi.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "Sha1Multi.h"
+#include "Sha1Kernels.h"
+#include <memory.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+typedef unsigned char uint8;
+
+// Idle lanes are fed from this buffer, so a single step never covers more
+// blocks than it holds while any lane is idle.
+static const unsigned IdleStepBlocks = 16;
+static uint8 const s_idleBlocks[IdleStepBlocks * 64] = { 0 };
+
+struct MultiKernel
+{
+	fSHA1MultiKernel m_kernel;
+	unsigned m_lanes;
+	char const* m_name;
+};
+
+static MultiKernel SelectMultiKernel()
+{
+	MultiKernel result;
+	if (fSHA1_CpuHasAVX2())
+	{
+		result.m_kernel = &fSHA1_BlocksX8AVX2;
+		result.m_lanes = 8;
+		result.m_name = "avx2-x8";
+	}
+	else if (fSHA1_CpuHasSSSE3())
+	{
+		result.m_kernel = &fSHA1_BlocksX4SSSE3;
+		result.m_lanes = 4;
+		result.m_name = "ssse3-x4";
+	}
+	else
+	{
+		result.m_kernel = NULL;
+		result.m_lanes = 1;
+		result.m_name = "sequential";
+	}
+	return result;
+}
+
+static MultiKernel const& GetMultiKernel()
+{
+	static MultiKernel const s_kernel = SelectMultiKernel();
+	return s_kernel;
+}
+
+unsigned fSHA1MultiHasher::LaneCount()
+{
+	return GetMultiKernel().m_lanes;
+}
+
+char const* fSHA1MultiHasher::KernelName()
+{
+	return GetMultiKernel().m_name;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief ctor
+/// @param _callback Called once per job as it completes
+/// @param _context Passed through to the callback
+fSHA1MultiHasher::fSHA1MultiHasher
+(
+	CompletionCallback _callback,
+	void* _context
+):
+	m_callback(_callback),
+	m_context(_context),
+	m_laneCount(LaneCount()),
+	m_active(0)
+{
+	for (unsigned l = 0; l < MaxLanes; ++l)
+	{
+		m_lanes[l].m_job = NULL;
+		m_lanes[l].m_ptr = NULL;
+		m_lanes[l].m_blocksLeft = 0;
+		m_lanes[l].m_padding = false;
+	}
+	memset(m_state, 0, sizeof(m_state));
+}
+
+void fSHA1MultiHasher::Submit
+(
+	fSHA1Job* _job
+)
+{
+	if (m_laneCount == 1)
+	{
+		// No vector kernel, there is nothing to be gained from queueing
+		_job->m_result.StreamStart();
+		_job->m_result.StreamFinal(_job->m_data, (fSizeType)_job->m_size, _job->m_size);
+		m_callback(_job, m_context);
+		return;
+	}
+
+	while (m_active == m_laneCount)
+	{
+		Step();
+	}
+
+	for (unsigned l = 0; l < m_laneCount; ++l)
+	{
+		if (m_lanes[l].m_job == NULL)
+		{
+			StartLane(l, _job);
+			break;
+		}
+	}
+}
+
+void fSHA1MultiHasher::Flush()
+{
+	while (m_active > 0)
+	{
+		Step();
+	}
+}
+
+void fSHA1MultiHasher::StartLane
+(
+	unsigned _lane,
+	fSHA1Job* _job
+)
+{
+	fSHA1 start;
+	start.StreamStart();
+	for (unsigned w = 0; w < 5; ++w)
+	{
+		m_state[w * m_laneCount + _lane] = start.m_hash[w];
+	}
+
+	Lane& lane = m_lanes[_lane];
+	lane.m_job = _job;
+	lane.m_ptr = (uint8 const*)_job->m_data;
+	lane.m_blocksLeft = _job->m_size / 64;
+	lane.m_padding = false;
+	++m_active;
+
+	if (lane.m_blocksLeft == 0)
+	{
+		StartPadding(_lane);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Point a lane at its final padded block(s), as fSHA1::StreamFinal
+/// @param _lane The lane whose whole blocks have all been consumed
+void fSHA1MultiHasher::StartPadding
+(
+	unsigned _lane
+)
+{
+	Lane& lane = m_lanes[_lane];
+	uint64 size = lane.m_job->m_size;
+	unsigned tailSize = (unsigned)(size % 64);
+	unsigned paddedSize = (tailSize + 1 + 8 <= 64 ? 64u : 128u);
+	uint64 totalSizeBits = size * 8;
+
+	memset(lane.m_pad, 0, sizeof(lane.m_pad));
+	if (tailSize > 0)
+	{
+		memcpy(lane.m_pad, (uint8 const*)lane.m_job->m_data + (size - tailSize), tailSize);
+	}
+	lane.m_pad[tailSize] = 0x80;
+	for (unsigned i = 0; i < 8; ++i)
+	{
+		lane.m_pad[paddedSize - 1 - i] = (uint8)((totalSizeBits >> (i * 8)) & 0xFF);
+	}
+
+	lane.m_ptr = lane.m_pad;
+	lane.m_blocksLeft = paddedSize / 64;
+	lane.m_padding = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Advance every busy lane until at least one reaches the end of its
+///        data or padding, completing any jobs that finish
+void fSHA1MultiHasher::Step()
+{
+	uint8 const* ptrs[MaxLanes];
+	uint64 step = 0;
+
+	if (m_active == 1)
+	{
+		// A lone job runs faster through the single stream kernel
+		for (unsigned l = 0; l < m_laneCount; ++l)
+		{
+			Lane& lane = m_lanes[l];
+			if (lane.m_job != NULL)
+			{
+				fSHA1 single;
+				for (unsigned w = 0; w < 5; ++w)
+				{
+					single.m_hash[w] = m_state[w * m_laneCount + l];
+				}
+				single.StreamBlock(lane.m_ptr, (fSizeType)(lane.m_blocksLeft * 64));
+				for (unsigned w = 0; w < 5; ++w)
+				{
+					m_state[w * m_laneCount + l] = single.m_hash[w];
+				}
+				step = lane.m_blocksLeft;
+				ptrs[l] = lane.m_ptr + step * 64;
+			}
+		}
+	}
+	else
+	{
+		for (unsigned l = 0; l < m_laneCount; ++l)
+		{
+			Lane const& lane = m_lanes[l];
+			if (lane.m_job != NULL && (step == 0 || lane.m_blocksLeft < step))
+			{
+				step = lane.m_blocksLeft;
+			}
+		}
+		if (m_active < m_laneCount && step > IdleStepBlocks)
+		{
+			step = IdleStepBlocks;
+		}
+
+		for (unsigned l = 0; l < m_laneCount; ++l)
+		{
+			ptrs[l] = (m_lanes[l].m_job != NULL) ? m_lanes[l].m_ptr : s_idleBlocks;
+		}
+		GetMultiKernel().m_kernel(m_state, ptrs, (fSizeType)step);
+	}
+
+	for (unsigned l = 0; l < m_laneCount; ++l)
+	{
+		Lane& lane = m_lanes[l];
+		if (lane.m_job == NULL)
+		{
+			continue;
+		}
+
+		lane.m_ptr = ptrs[l];
+		lane.m_blocksLeft -= step;
+		if (lane.m_blocksLeft > 0)
+		{
+			continue;
+		}
+
+		if (!lane.m_padding)
+		{
+			StartPadding(l);
+			continue;
+		}
+
+		fSHA1Job* job = lane.m_job;
+		for (unsigned w = 0; w < 5; ++w)
+		{
+			job->m_result.m_hash[w] = m_state[w * m_laneCount + l];
+		}
+		lane.m_job = NULL;
+		--m_active;
+		m_callback(job, m_context);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// fSHA1HashFiles
+
+struct FileJob
+{
+	fSHA1Job m_job;
+	std::string const* m_path;
+	std::vector<uint8> m_data;
+};
+
+struct FileHashContext
+{
+	fSHA1FileCallback m_callback;
+	void* m_context;
+};
+
+static void OnFileJobComplete(fSHA1Job* _job, void* _context)
+{
+	FileHashContext* context = (FileHashContext*)_context;
+	FileJob* fileJob = (FileJob*)_job->m_userData;
+	context->m_callback(*fileJob->m_path, _job->m_result, _job->m_size, true, context->m_context);
+	delete fileJob;
+}
+
+static bool GetFileSize(std::string const& _path, uint64* o_size)
+{
+#ifdef _WIN32
+	struct _stat64 info;
+	if (_stat64(_path.c_str(), &info) != 0)
+	{
+		return false;
+	}
+#else
+	struct stat info;
+	if (stat(_path.c_str(), &info) != 0)
+	{
+		return false;
+	}
+#endif
+	*o_size = (uint64)info.st_size;
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Stream a large file through a single fSHA1
+static bool HashLargeFile(FILE* _file, fSHA1* o_digest, uint64* o_size)
+{
+	const size_t buffsize = 256 * 1024;
+	std::vector<uint8> buffer(buffsize);
+
+	o_digest->StreamStart();
+	size_t dataread;
+	while ((dataread = fread(&buffer[0], 1, buffsize, _file)) > 0)
+	{
+		o_digest->Update(&buffer[0], dataread);
+	}
+	if (ferror(_file))
+	{
+		return false;
+	}
+	o_digest->Finish();
+
+	*o_size = o_digest->m_totalSize;
+	return true;
+}
+
+void fSHA1HashFiles
+(
+	std::vector<std::string> const& _paths,
+	fSHA1FileCallback _callback,
+	void* _context,
+	uint64 _maxInMemory
+)
+{
+	FileHashContext context;
+	context.m_callback = _callback;
+	context.m_context = _context;
+
+	fSHA1MultiHasher hasher(&OnFileJobComplete, &context);
+	fSHA1 failed;
+
+	for (size_t i = 0; i < _paths.size(); ++i)
+	{
+		std::string const& path = _paths[i];
+		uint64 size = 0;
+		FILE* file = NULL;
+		if (GetFileSize(path, &size))
+		{
+			file = fopen(path.c_str(), "rb");
+		}
+		if (file == NULL)
+		{
+			_callback(path, failed, 0, false, _context);
+			continue;
+		}
+
+		if (size > _maxInMemory)
+		{
+			fSHA1 digest;
+			bool ok = HashLargeFile(file, &digest, &size);
+			fclose(file);
+			_callback(path, digest, size, ok, _context);
+			continue;
+		}
+
+		FileJob* fileJob = new FileJob;
+		fileJob->m_path = &path;
+		fileJob->m_data.resize((size_t)size);
+		size_t dataread = (size > 0) ? fread(&fileJob->m_data[0], 1, (size_t)size, file) : 0;
+		fclose(file);
+
+		if (dataread != size)
+		{
+			delete fileJob;
+			_callback(path, failed, 0, false, _context);
+			continue;
+		}
+
+		fileJob->m_job.m_data = fileJob->m_data.empty() ? NULL : &fileJob->m_data[0];
+		fileJob->m_job.m_size = size;
+		fileJob->m_job.m_userData = fileJob;
+		hasher.Submit(&fileJob->m_job);
+	}
+
+	hasher.Flush();
+}
@@ -0,0 +1,91 @@
+/*----------------------------------------------------------------------------
+ *  FILE: Sha1Multi.h
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		Multi-buffer SHA-1. Independent messages are packed into the lanes
+ *		of a SIMD register (4 with SSSE3, 8 with AVX2) and compressed
+ *		together, which keeps the vector units busy when hashing many
+ *		small or medium sized inputs. Digests are identical to fSHA1.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef _FSHA1MULTI_H
+#define _FSHA1MULTI_H
+
+#include "sha1.h"
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+/// A single message to hash. The data must stay valid until the job's
+/// completion callback has been called.
+struct fSHA1Job
+{
+	void const* m_data;
+	uint64 m_size;
+	void* m_userData;
+	fSHA1 m_result;
+
+	fSHA1Job() : m_data(NULL), m_size(0), m_userData(NULL) {}
+};
+
+class fSHA1MultiHasher
+{
+public:
+	enum { MaxLanes = 8 };
+
+	typedef void (*CompletionCallback)(fSHA1Job* _job, void* _context);
+
+	fSHA1MultiHasher(CompletionCallback _callback, void* _context);
+
+	/// Queue a job. If every lane is busy this hashes until one becomes free,
+	/// so callbacks for earlier jobs may run before Submit returns.
+	void Submit(fSHA1Job* _job);
+
+	/// Complete every outstanding job.
+	void Flush();
+
+	/// Number of lanes the selected kernel processes at once (1, 4 or 8)
+	static unsigned LaneCount();
+	static char const* KernelName();
+
+private:
+	struct Lane
+	{
+		fSHA1Job* m_job;
+		unsigned char const* m_ptr;
+		uint64 m_blocksLeft;
+		bool m_padding;
+		unsigned char m_pad[128];
+	};
+
+	CompletionCallback m_callback;
+	void* m_context;
+	unsigned m_laneCount;
+	unsigned m_active;
+	Lane m_lanes[MaxLanes];
+	fUInt32 m_state[5 * MaxLanes];
+
+	void StartLane(unsigned _lane, fSHA1Job* _job);
+	void StartPadding(unsigned _lane);
+	void Step();
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Hash a list of files through fSHA1MultiHasher. Files up to _maxInMemory
+/// bytes are read whole and share lanes, larger ones are streamed through a
+/// single fSHA1. The callback receives files in completion order, _ok is
+/// false (and the digest meaningless) if a file could not be read.
+typedef void (*fSHA1FileCallback)(std::string const& _path, fSHA1 const& _digest, uint64 _size, bool _ok, void* _context);
+
+void fSHA1HashFiles
+(
+	std::vector<std::string> const& _paths,
+	fSHA1FileCallback _callback,
+	void* _context,
+	uint64 _maxInMemory = 8 * 1024 * 1024
+);
+
+#endif
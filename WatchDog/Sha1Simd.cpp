@@ -0,0 +1,520 @@
+/*----------------------------------------------------------------------------
+ *  FILE: Sha1Simd.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		SIMD SHA-1 compression kernels, single stream and multi-buffer, and
+ *		the CPU feature checks used to choose between them. fSHA1 falls back
+ *		to fSHA1_BlocksScalar when none is available.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "Sha1Kernels.h"
+
+#if F_SHA1_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <immintrin.h>
+#endif
+
+typedef unsigned char uint8;
+typedef fUInt32 uint32;
+typedef unsigned uint;
+
+#if F_SHA1_X86
+
+static void CpuId(int _leaf, int _subLeaf, int o_regs[4])
+{
+#if defined(_MSC_VER)
+	__cpuidex(o_regs, _leaf, _subLeaf);
+#else
+	unsigned a = 0, b = 0, c = 0, d = 0;
+	__cpuid_count(_leaf, _subLeaf, a, b, c, d);
+	o_regs[0] = (int)a;
+	o_regs[1] = (int)b;
+	o_regs[2] = (int)c;
+	o_regs[3] = (int)d;
+#endif
+}
+
+bool fSHA1_CpuHasSSSE3()
+{
+	int regs[4];
+	CpuId(1, 0, regs);
+	return (regs[2] & (1 << 9)) != 0;
+}
+
+bool fSHA1_CpuHasSHANI()
+{
+	int regs[4];
+	CpuId(0, 0, regs);
+	if (regs[0] < 7)
+	{
+		return false;
+	}
+
+	// The SHA-NI kernel also uses SSSE3 shuffles and an SSE4.1 extract
+	CpuId(1, 0, regs);
+	bool sse41 = (regs[2] & (1 << 19)) != 0;
+	bool ssse3 = (regs[2] & (1 << 9)) != 0;
+
+	CpuId(7, 0, regs);
+	bool sha = (regs[1] & (1 << 29)) != 0;
+
+	return sha && sse41 && ssse3;
+}
+
+bool fSHA1_CpuHasAVX2()
+{
+	int regs[4];
+	CpuId(0, 0, regs);
+	if (regs[0] < 7)
+	{
+		return false;
+	}
+
+	// The OS must save the YMM registers as well as the CPU supporting AVX
+	CpuId(1, 0, regs);
+	bool osxsave = (regs[2] & (1 << 27)) != 0;
+	bool avx = (regs[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx)
+	{
+		return false;
+	}
+
+#if defined(_MSC_VER)
+	unsigned long long xcr0 = _xgetbv(0);
+#else
+	unsigned lo = 0, hi = 0;
+	__asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+	unsigned long long xcr0 = ((unsigned long long)hi << 32) | lo;
+#endif
+	if ((xcr0 & 6) != 6)
+	{
+		return false;
+	}
+
+	CpuId(7, 0, regs);
+	return (regs[1] & (1 << 5)) != 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief SSSE3 kernel: vectorised big-endian load and message schedule
+///        (four words per step), scalar rounds
+/// @param _hash The five hash words to update
+/// @param _data The message blocks
+/// @param _blocks Number of 64 byte blocks in _data
+F_SHA1_TARGET("ssse3")
+void fSHA1_BlocksSSSE3(fUInt32* _hash, uint8 const* _data, fSizeType _blocks)
+{
+	__m128i const byteSwap = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+	__m128i const k0 = _mm_set1_epi32(0x5A827999);
+	__m128i const k1 = _mm_set1_epi32(0x6ED9EBA1);
+	__m128i const k2 = _mm_set1_epi32(0x8F1BBCDC);
+	__m128i const k3 = _mm_set1_epi32(0xCA62C1D6);
+
+	alignas(16) uint32 w[80];
+	alignas(16) uint32 wk[80];
+
+	while(_blocks > 0)
+	{
+		for (uint i = 0; i < 16; i += 4)
+		{
+			__m128i v = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const*)(_data + i * 4)), byteSwap);
+			_mm_store_si128((__m128i*)&w[i], v);
+			_mm_store_si128((__m128i*)&wk[i], _mm_add_epi32(v, k0));
+		}
+
+		for (uint i = 16; i < 80; i += 4)
+		{
+			// w[i-3..i] with the not yet known w[i] left as zero ...
+			__m128i t = _mm_srli_si128(_mm_load_si128((__m128i const*)&w[i-4]), 4);
+			t = _mm_xor_si128(t, _mm_load_si128((__m128i const*)&w[i-8]));
+			t = _mm_xor_si128(t, _mm_loadu_si128((__m128i const*)&w[i-14]));
+			t = _mm_xor_si128(t, _mm_load_si128((__m128i const*)&w[i-16]));
+			__m128i r = _mm_or_si128(_mm_slli_epi32(t, 1), _mm_srli_epi32(t, 31));
+
+			// ... then patched into the last lane, the rotate distributes over xor
+			__m128i fix = _mm_slli_si128(r, 12);
+			fix = _mm_or_si128(_mm_slli_epi32(fix, 1), _mm_srli_epi32(fix, 31));
+			r = _mm_xor_si128(r, fix);
+
+			__m128i k = (i < 20) ? k0 : (i < 40) ? k1 : (i < 60) ? k2 : k3;
+			_mm_store_si128((__m128i*)&w[i], r);
+			_mm_store_si128((__m128i*)&wk[i], _mm_add_epi32(r, k));
+		}
+
+		uint32 a = _hash[0];
+		uint32 b = _hash[1];
+		uint32 c = _hash[2];
+		uint32 d = _hash[3];
+		uint32 e = _hash[4];
+
+#define F_SHA1_ROUND(f)													\
+		{																\
+			uint32 temp = ((a << 5) | (a >> 27)) + (f) + e + wk[i];		\
+			e = d;														\
+			d = c;														\
+			c = (b << 30) | (b >> 2);									\
+			b = a;														\
+			a = temp;													\
+		}
+
+		for (uint i = 0;  i < 20; i++)	{ F_SHA1_ROUND(d ^ (b & (c ^ d))); }
+		for (uint i = 20; i < 40; i++)	{ F_SHA1_ROUND(b ^ c ^ d); }
+		for (uint i = 40; i < 60; i++)	{ F_SHA1_ROUND((b & c) | (d & (b | c))); }
+		for (uint i = 60; i < 80; i++)	{ F_SHA1_ROUND(b ^ c ^ d); }
+
+#undef F_SHA1_ROUND
+
+		_hash[0] += a;
+		_hash[1] += b;
+		_hash[2] += c;
+		_hash[3] += d;
+		_hash[4] += e;
+
+		_data += 64;
+		--_blocks;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief SHA extensions kernel (sha1rnds4/sha1nexte/sha1msg1/sha1msg2)
+/// @param _hash The five hash words to update
+/// @param _data The message blocks
+/// @param _blocks Number of 64 byte blocks in _data
+F_SHA1_TARGET("sha,sse4.1")
+void fSHA1_BlocksSHANI(fUInt32* _hash, uint8 const* _data, fSizeType _blocks)
+{
+	__m128i const byteSwap = _mm_set_epi64x(0x0001020304050607ULL, 0x08090A0B0C0D0E0FULL);
+
+	__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128((__m128i const*)_hash), 0x1B);
+	__m128i e0 = _mm_set_epi32((int)_hash[4], 0, 0, 0);
+	__m128i e1;
+	__m128i msg0, msg1, msg2, msg3;
+
+	// Four rounds once the schedule is under way. _ea carries the E value for
+	// these rounds, _eb receives the state for the next four. _m0 holds the
+	// current words, _m1.._m3 are the following message words being extended.
+#define F_SHA1_NI_QUAD(_ea, _eb, _m0, _m1, _m2, _m3, _f)				\
+	_ea = _mm_sha1nexte_epu32(_ea, _m0);								\
+	_eb = abcd;															\
+	_m1 = _mm_sha1msg2_epu32(_m1, _m0);									\
+	abcd = _mm_sha1rnds4_epu32(abcd, _ea, _f);							\
+	_m3 = _mm_sha1msg1_epu32(_m3, _m0);									\
+	_m2 = _mm_xor_si128(_m2, _m0);
+
+	while(_blocks > 0)
+	{
+		__m128i abcdSave = abcd;
+		__m128i e0Save = e0;
+
+		// Rounds 0-3
+		msg0 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const*)(_data + 0)), byteSwap);
+		e0 = _mm_add_epi32(e0, msg0);
+		e1 = abcd;
+		abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+		// Rounds 4-7
+		msg1 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const*)(_data + 16)), byteSwap);
+		e1 = _mm_sha1nexte_epu32(e1, msg1);
+		e0 = abcd;
+		abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+		msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+
+		// Rounds 8-11
+		msg2 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const*)(_data + 32)), byteSwap);
+		e0 = _mm_sha1nexte_epu32(e0, msg2);
+		e1 = abcd;
+		abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+		msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+		msg0 = _mm_xor_si128(msg0, msg2);
+
+		// Rounds 12-15
+		msg3 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const*)(_data + 48)), byteSwap);
+		e1 = _mm_sha1nexte_epu32(e1, msg3);
+		e0 = abcd;
+		msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+		abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+		msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+		msg1 = _mm_xor_si128(msg1, msg3);
+
+		// Rounds 16-79, the last few extend words that are never used
+		F_SHA1_NI_QUAD(e0, e1, msg0, msg1, msg2, msg3, 0);	// 16-19
+		F_SHA1_NI_QUAD(e1, e0, msg1, msg2, msg3, msg0, 1);	// 20-23
+		F_SHA1_NI_QUAD(e0, e1, msg2, msg3, msg0, msg1, 1);	// 24-27
+		F_SHA1_NI_QUAD(e1, e0, msg3, msg0, msg1, msg2, 1);	// 28-31
+		F_SHA1_NI_QUAD(e0, e1, msg0, msg1, msg2, msg3, 1);	// 32-35
+		F_SHA1_NI_QUAD(e1, e0, msg1, msg2, msg3, msg0, 1);	// 36-39
+		F_SHA1_NI_QUAD(e0, e1, msg2, msg3, msg0, msg1, 2);	// 40-43
+		F_SHA1_NI_QUAD(e1, e0, msg3, msg0, msg1, msg2, 2);	// 44-47
+		F_SHA1_NI_QUAD(e0, e1, msg0, msg1, msg2, msg3, 2);	// 48-51
+		F_SHA1_NI_QUAD(e1, e0, msg1, msg2, msg3, msg0, 2);	// 52-55
+		F_SHA1_NI_QUAD(e0, e1, msg2, msg3, msg0, msg1, 2);	// 56-59
+		F_SHA1_NI_QUAD(e1, e0, msg3, msg0, msg1, msg2, 3);	// 60-63
+		F_SHA1_NI_QUAD(e0, e1, msg0, msg1, msg2, msg3, 3);	// 64-67
+		F_SHA1_NI_QUAD(e1, e0, msg1, msg2, msg3, msg0, 3);	// 68-71
+		F_SHA1_NI_QUAD(e0, e1, msg2, msg3, msg0, msg1, 3);	// 72-75
+		F_SHA1_NI_QUAD(e1, e0, msg3, msg0, msg1, msg2, 3);	// 76-79
+
+		e0 = _mm_sha1nexte_epu32(e0, e0Save);
+		abcd = _mm_add_epi32(abcd, abcdSave);
+
+		_data += 64;
+		--_blocks;
+	}
+
+#undef F_SHA1_NI_QUAD
+
+	_mm_storeu_si128((__m128i*)_hash, _mm_shuffle_epi32(abcd, 0x1B));
+	_hash[4] = (uint32)_mm_extract_epi32(e0, 3);
+}
+
+// Round function shared by the multi-buffer kernels, expressed through the
+// F_SHA1_V* vector operations defined before each kernel.
+#define F_SHA1_MB_ROUNDS()																\
+	{																					\
+		VecType a = F_SHA1_VLOAD(&_state[0 * LANES]);										\
+		VecType b = F_SHA1_VLOAD(&_state[1 * LANES]);										\
+		VecType c = F_SHA1_VLOAD(&_state[2 * LANES]);										\
+		VecType d = F_SHA1_VLOAD(&_state[3 * LANES]);										\
+		VecType e = F_SHA1_VLOAD(&_state[4 * LANES]);										\
+		VecType a0 = a, b0 = b, c0 = c, d0 = d, e0 = e;									\
+		for (uint t = 0; t < 80; ++t)													\
+		{																				\
+			VecType wt;																	\
+			if (t < 16)																	\
+			{																			\
+				wt = w[t];																\
+			}																			\
+			else																		\
+			{																			\
+				wt = F_SHA1_VXOR(F_SHA1_VXOR(w[(t-3) & 15], w[(t-8) & 15]),				\
+						F_SHA1_VXOR(w[(t-14) & 15], w[t & 15]));						\
+				wt = F_SHA1_VROL(wt, 1);												\
+				w[t & 15] = wt;															\
+			}																			\
+			VecType f, k;																	\
+			if (t < 20)																	\
+			{																			\
+				f = F_SHA1_VXOR(d, F_SHA1_VAND(b, F_SHA1_VXOR(c, d)));					\
+				k = k0;																	\
+			}																			\
+			else if (t < 40)															\
+			{																			\
+				f = F_SHA1_VXOR(F_SHA1_VXOR(b, c), d);									\
+				k = k1;																	\
+			}																			\
+			else if (t < 60)															\
+			{																			\
+				f = F_SHA1_VOR(F_SHA1_VAND(b, c), F_SHA1_VAND(d, F_SHA1_VOR(b, c)));	\
+				k = k2;																	\
+			}																			\
+			else																		\
+			{																			\
+				f = F_SHA1_VXOR(F_SHA1_VXOR(b, c), d);									\
+				k = k3;																	\
+			}																			\
+			VecType temp = F_SHA1_VADD(F_SHA1_VADD(F_SHA1_VROL(a, 5), f),					\
+					F_SHA1_VADD(F_SHA1_VADD(e, k), wt));								\
+			e = d;																		\
+			d = c;																		\
+			c = F_SHA1_VROL(b, 30);														\
+			b = a;																		\
+			a = temp;																	\
+		}																				\
+		F_SHA1_VSTORE(&_state[0 * LANES], F_SHA1_VADD(a, a0));							\
+		F_SHA1_VSTORE(&_state[1 * LANES], F_SHA1_VADD(b, b0));							\
+		F_SHA1_VSTORE(&_state[2 * LANES], F_SHA1_VADD(c, c0));							\
+		F_SHA1_VSTORE(&_state[3 * LANES], F_SHA1_VADD(d, d0));							\
+		F_SHA1_VSTORE(&_state[4 * LANES], F_SHA1_VADD(e, e0));							\
+	}
+
+// Load four consecutive big-endian words from four lanes, transposed so that
+// o_w[j] holds word j of every lane.
+#define F_SHA1_LOAD4X4(_p0, _p1, _p2, _p3, _byteSwap, o_w)							\
+	{																				\
+		__m128i r0 = _mm_loadu_si128((__m128i const*)(_p0));						\
+		__m128i r1 = _mm_loadu_si128((__m128i const*)(_p1));						\
+		__m128i r2 = _mm_loadu_si128((__m128i const*)(_p2));						\
+		__m128i r3 = _mm_loadu_si128((__m128i const*)(_p3));						\
+		__m128i t0 = _mm_unpacklo_epi32(r0, r1);									\
+		__m128i t1 = _mm_unpacklo_epi32(r2, r3);									\
+		__m128i t2 = _mm_unpackhi_epi32(r0, r1);									\
+		__m128i t3 = _mm_unpackhi_epi32(r2, r3);									\
+		o_w[0] = _mm_shuffle_epi8(_mm_unpacklo_epi64(t0, t1), _byteSwap);			\
+		o_w[1] = _mm_shuffle_epi8(_mm_unpackhi_epi64(t0, t1), _byteSwap);			\
+		o_w[2] = _mm_shuffle_epi8(_mm_unpacklo_epi64(t2, t3), _byteSwap);			\
+		o_w[3] = _mm_shuffle_epi8(_mm_unpackhi_epi64(t2, t3), _byteSwap);			\
+	}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Four independent messages per pass using 128 bit vectors
+/// @param _state Interleaved hash words of the four lanes
+/// @param _data Per lane block pointers, advanced past the data consumed
+/// @param _blocks Number of 64 byte blocks to take from every lane
+F_SHA1_TARGET("ssse3")
+void fSHA1_BlocksX4SSSE3(fUInt32* _state, uint8 const** _data, fSizeType _blocks)
+{
+	enum { LANES = 4 };
+	typedef __m128i VecType;
+#define F_SHA1_VLOAD(_p)		_mm_loadu_si128((__m128i const*)(_p))
+#define F_SHA1_VSTORE(_p, _v)	_mm_storeu_si128((__m128i*)(_p), _v)
+#define F_SHA1_VADD(_a, _b)		_mm_add_epi32(_a, _b)
+#define F_SHA1_VAND(_a, _b)		_mm_and_si128(_a, _b)
+#define F_SHA1_VOR(_a, _b)		_mm_or_si128(_a, _b)
+#define F_SHA1_VXOR(_a, _b)		_mm_xor_si128(_a, _b)
+#define F_SHA1_VROL(_a, _n)		_mm_or_si128(_mm_slli_epi32(_a, _n), _mm_srli_epi32(_a, 32 - (_n)))
+
+	__m128i const byteSwap = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+	__m128i const k0 = _mm_set1_epi32(0x5A827999);
+	__m128i const k1 = _mm_set1_epi32(0x6ED9EBA1);
+	__m128i const k2 = _mm_set1_epi32(0x8F1BBCDC);
+	__m128i const k3 = _mm_set1_epi32(0xCA62C1D6);
+
+	uint8 const* p0 = _data[0];
+	uint8 const* p1 = _data[1];
+	uint8 const* p2 = _data[2];
+	uint8 const* p3 = _data[3];
+
+	for (fSizeType block = 0; block < _blocks; ++block)
+	{
+		__m128i w[16];
+		for (uint i = 0; i < 16; i += 4)
+		{
+			F_SHA1_LOAD4X4(p0 + i * 4, p1 + i * 4, p2 + i * 4, p3 + i * 4, byteSwap, (w + i));
+		}
+
+		F_SHA1_MB_ROUNDS();
+
+		p0 += 64;
+		p1 += 64;
+		p2 += 64;
+		p3 += 64;
+	}
+
+	_data[0] = p0;
+	_data[1] = p1;
+	_data[2] = p2;
+	_data[3] = p3;
+
+#undef F_SHA1_VLOAD
+#undef F_SHA1_VSTORE
+#undef F_SHA1_VADD
+#undef F_SHA1_VAND
+#undef F_SHA1_VOR
+#undef F_SHA1_VXOR
+#undef F_SHA1_VROL
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Eight independent messages per pass using 256 bit vectors
+/// @param _state Interleaved hash words of the eight lanes
+/// @param _data Per lane block pointers, advanced past the data consumed
+/// @param _blocks Number of 64 byte blocks to take from every lane
+F_SHA1_TARGET("avx2")
+void fSHA1_BlocksX8AVX2(fUInt32* _state, uint8 const** _data, fSizeType _blocks)
+{
+	enum { LANES = 8 };
+	typedef __m256i VecType;
+#define F_SHA1_VLOAD(_p)		_mm256_loadu_si256((__m256i const*)(_p))
+#define F_SHA1_VSTORE(_p, _v)	_mm256_storeu_si256((__m256i*)(_p), _v)
+#define F_SHA1_VADD(_a, _b)		_mm256_add_epi32(_a, _b)
+#define F_SHA1_VAND(_a, _b)		_mm256_and_si256(_a, _b)
+#define F_SHA1_VOR(_a, _b)		_mm256_or_si256(_a, _b)
+#define F_SHA1_VXOR(_a, _b)		_mm256_xor_si256(_a, _b)
+#define F_SHA1_VROL(_a, _n)		_mm256_or_si256(_mm256_slli_epi32(_a, _n), _mm256_srli_epi32(_a, 32 - (_n)))
+
+	__m128i const byteSwap = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+	__m256i const k0 = _mm256_set1_epi32(0x5A827999);
+	__m256i const k1 = _mm256_set1_epi32(0x6ED9EBA1);
+	__m256i const k2 = _mm256_set1_epi32(0x8F1BBCDC);
+	__m256i const k3 = _mm256_set1_epi32(0xCA62C1D6);
+
+	uint8 const* p[LANES];
+	for (uint l = 0; l < LANES; ++l)
+	{
+		p[l] = _data[l];
+	}
+
+	for (fSizeType block = 0; block < _blocks; ++block)
+	{
+		__m256i w[16];
+		for (uint i = 0; i < 16; i += 4)
+		{
+			__m128i lo[4];
+			__m128i hi[4];
+			F_SHA1_LOAD4X4(p[0] + i * 4, p[1] + i * 4, p[2] + i * 4, p[3] + i * 4, byteSwap, lo);
+			F_SHA1_LOAD4X4(p[4] + i * 4, p[5] + i * 4, p[6] + i * 4, p[7] + i * 4, byteSwap, hi);
+			for (uint j = 0; j < 4; ++j)
+			{
+				w[i + j] = _mm256_inserti128_si256(_mm256_castsi128_si256(lo[j]), hi[j], 1);
+			}
+		}
+
+		F_SHA1_MB_ROUNDS();
+
+		for (uint l = 0; l < LANES; ++l)
+		{
+			p[l] += 64;
+		}
+	}
+
+	for (uint l = 0; l < LANES; ++l)
+	{
+		_data[l] = p[l];
+	}
+
+#undef F_SHA1_VLOAD
+#undef F_SHA1_VSTORE
+#undef F_SHA1_VADD
+#undef F_SHA1_VAND
+#undef F_SHA1_VOR
+#undef F_SHA1_VXOR
+#undef F_SHA1_VROL
+}
+
+#undef F_SHA1_LOAD4X4
+#undef F_SHA1_MB_ROUNDS
+
+#else // F_SHA1_X86
+
+bool fSHA1_CpuHasSSSE3()
+{
+	return false;
+}
+
+bool fSHA1_CpuHasSHANI()
+{
+	return false;
+}
+
+bool fSHA1_CpuHasAVX2()
+{
+	return false;
+}
+
+void fSHA1_BlocksSSSE3(fUInt32* _hash, uint8 const* _data, fSizeType _blocks)
+{
+	fSHA1_BlocksScalar(_hash, _data, _blocks);
+}
+
+void fSHA1_BlocksSHANI(fUInt32* _hash, uint8 const* _data, fSizeType _blocks)
+{
+	fSHA1_BlocksScalar(_hash, _data, _blocks);
+}
+
+void fSHA1_BlocksX4SSSE3(fUInt32* _state, uint8 const** _data, fSizeType _blocks)
+{
+	// Never selected, fSHA1MultiHasher runs one lane at a time without SIMD
+}
+
+void fSHA1_BlocksX8AVX2(fUInt32* _state, uint8 const** _data, fSizeType _blocks)
+{
+}
+
+#endif // F_SHA1_X86
@@ -7,17 +7,296 @@
  *
  *----------------------------------------------------------------------------
  */
-#include "windows.h"
 #include "SimpleHttp.h"
-#include "winhttp.h"
+
+// The pool and the request's SendRequest overloads are common to both
+// backends, the rest here is WinHTTP. The sockets backend is in
+// SimpleHttpSockets.cpp.
+
+HttpConnectionPool::HttpConnectionPool(const std::wstring &_userAgent, Options const &_options) :
+    m_userAgent(_userAgent),
+    m_options(_options),
+#if !F_SIMPLEHTTP_SOCKETS
+    m_session(0),
+#endif
+    m_hits(0),
+    m_misses(0)
+{
+    if (m_options.m_maxPerHost == 0)
+    {
+        m_options.m_maxPerHost = 1;
+    }
+}
+
+HttpConnectionPool::~HttpConnectionPool()
+{
+    for (size_t i = 0; i < m_connections.size(); ++i)
+    {
+        Close( m_connections[i].m_connect );
+    }
+#if !F_SIMPLEHTTP_SOCKETS
+    if( m_session ) WinHttpCloseHandle( m_session );
+#endif
+}
+
+HttpConnectionPool::Handle HttpConnectionPool::Acquire(const std::wstring &_host, INTERNET_PORT _port, bool _secure)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    while (true)
+    {
+        Clock::time_point now = Clock::now();
+        TrimLocked(now);
+
+        for (size_t i = 0; i < m_connections.size(); ++i)
+        {
+            Connection &connection = m_connections[i];
+            if (!connection.m_busy && connection.m_port == _port && connection.m_secure == _secure && connection.m_host == _host)
+            {
+                if (!Reusable(connection.m_connect))
+                {
+                    // closed by the server while it was idle
+                    Close(connection.m_connect);
+                    m_connections.erase(m_connections.begin() + i);
+                    --i;
+                    continue;
+                }
+                connection.m_busy = true;
+                ++m_hits;
+                return connection.m_connect;
+            }
+        }
+
+        if (CountLocked(_host, _port, _secure) < m_options.m_maxPerHost)
+        {
+            break;
+        }
+        m_released.wait(lock);
+    }
+
+    Handle hConnect = OpenLocked( _host, _port, _secure );
+    if (!hConnect)
+    {
+        return 0;
+    }
+
+    Connection connection;
+    connection.m_host = _host;
+    connection.m_port = _port;
+    connection.m_secure = _secure;
+    connection.m_connect = hConnect;
+    connection.m_busy = true;
+    connection.m_lastUsed = Clock::now();
+    m_connections.push_back(connection);
+    ++m_misses;
+    lock.unlock();
+
+    // it counts against the host while it connects, but other hosts
+    // needn't wait for it
+    if (!Connect( hConnect ))
+    {
+        Release( hConnect, false );
+        return 0;
+    }
+    return hConnect;
+}
+
+void HttpConnectionPool::Release(Handle _connect, bool _reusable)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        for (size_t i = 0; i < m_connections.size(); ++i)
+        {
+            if (m_connections[i].m_connect != _connect)
+            {
+                continue;
+            }
+            if (_reusable)
+            {
+                m_connections[i].m_busy = false;
+                m_connections[i].m_lastUsed = Clock::now();
+            }
+            else
+            {
+                Close( _connect );
+                m_connections.erase(m_connections.begin() + i);
+            }
+            break;
+        }
+    }
+    m_released.notify_all();
+}
+
+void HttpConnectionPool::Trim()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    TrimLocked(Clock::now());
+}
+
+unsigned HttpConnectionPool::Hits() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_hits;
+}
+
+unsigned HttpConnectionPool::Misses() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_misses;
+}
+
+void HttpConnectionPool::TrimLocked(Clock::time_point _now)
+{
+    std::chrono::milliseconds timeout(m_options.m_idleTimeoutMs);
+    for (size_t i = m_connections.size(); i-- > 0; )
+    {
+        Connection &connection = m_connections[i];
+        if (!connection.m_busy && _now - connection.m_lastUsed > timeout)
+        {
+            Close( connection.m_connect );
+            m_connections.erase(m_connections.begin() + i);
+        }
+    }
+
+#if !F_SIMPLEHTTP_SOCKETS
+    // The keep-alive sockets belong to the session rather than the
+    // connection handles, so it is only by closing it that they are dropped
+    if (m_connections.empty() && m_session)
+    {
+        WinHttpCloseHandle( m_session );
+        m_session = 0;
+    }
+#endif
+}
+
+unsigned HttpConnectionPool::CountLocked(const std::wstring &_host, INTERNET_PORT _port, bool _secure) const
+{
+    unsigned count = 0;
+    for (size_t i = 0; i < m_connections.size(); ++i)
+    {
+        Connection const &connection = m_connections[i];
+        if (connection.m_port == _port && connection.m_secure == _secure && connection.m_host == _host)
+        {
+            ++count;
+        }
+    }
+    return count;
+}
 
 SimpleHttpRequest::SimpleHttpRequest(const std::wstring &userAgent, bool _secure) :
     m_userAgent(userAgent),
-    m_secure(_secure)
+    m_pool(0),
+    m_secure(_secure),
+    m_port(0)
+{
+}
+
+SimpleHttpRequest::SimpleHttpRequest(HttpConnectionPool &_pool, bool _secure) :
+    m_pool(&_pool),
+    m_secure(_secure),
+    m_port(0)
 {
 }
 
 bool SimpleHttpRequest::SendRequest(const std::wstring &url, const std::wstring &method, const std::wstring &path, void *body, DWORD bodySize)
+{
+    m_responseBody.resize(0);
+    HttpVectorSink sink(m_responseBody);
+    return SendRequest(url, method, path, body, bodySize, sink);
+}
+
+bool SimpleHttpRequest::SendRequest(const std::wstring &url, const std::wstring &method, const std::wstring &path, void *body, DWORD bodySize, HttpResponseSink &sink)
+{
+    return Send(url, method, path, body, bodySize, NULL, sink);
+}
+
+bool SimpleHttpRequest::SendRequest(const std::wstring &url, const std::wstring &method, const std::wstring &path, HttpRequestBody &body, HttpResponseSink &sink, HttpProgress const &progress)
+{
+    HttpBodyPump pump(body, progress);
+    return Send(url, method, path, NULL, 0, &pump, sink);
+}
+
+#if !F_SIMPLEHTTP_SOCKETS
+
+HttpConnectionPool::Handle HttpConnectionPool::OpenLocked(const std::wstring &_host, INTERNET_PORT _port, bool _secure)
+{
+    if (!m_session)
+    {
+        m_session = WinHttpOpen( m_userAgent.c_str(), WINHTTP_ACCESS_TYPE_DEFAULT_PROXY, WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0 );
+        if (!m_session)
+        {
+            return 0;
+        }
+        // WinHTTP's own limit on sockets per server, so it doesn't queue
+        // requests the pool has already let through
+        DWORD maxConns = m_options.m_maxPerHost;
+        WinHttpSetOption( m_session, WINHTTP_OPTION_MAX_CONNS_PER_SERVER, &maxConns, sizeof(maxConns) );
+    }
+    return WinHttpConnect( m_session, _host.c_str(), _port, 0 );
+}
+
+bool HttpConnectionPool::Connect(Handle _connect)
+{
+    // WinHTTP connects when a request is sent
+    return true;
+}
+
+bool HttpConnectionPool::Reusable(Handle _connect)
+{
+    // and drops sockets the server has closed itself
+    return true;
+}
+
+void HttpConnectionPool::Close(Handle _connect)
+{
+    WinHttpCloseHandle( _connect );
+}
+
+uint64 HttpContentLength(HINTERNET _request)
+{
+    wchar_t length[32];
+    DWORD size = sizeof(length);
+    if (!WinHttpQueryHeaders( _request, WINHTTP_QUERY_CONTENT_LENGTH, WINHTTP_HEADER_NAME_BY_INDEX, length, &size, WINHTTP_NO_HEADER_INDEX ))
+    {
+        return HttpResponseSink::UnknownLength;
+    }
+    wchar_t* end = NULL;
+    unsigned long long value = wcstoull( length, &end, 10 );
+    return (end == length) ? HttpResponseSink::UnknownLength : value;
+}
+
+static BOOL HttpSendStreamed(HINTERNET _request, HttpBodyPump &_pump)
+{
+    // The length goes in a header of our own: dwTotalLength would cap it at
+    // 4GB, and there is none for a chunked body
+    std::string headers = _pump.Headers();
+    std::wstring wideHeaders(headers.begin(), headers.end());
+    if (!WinHttpSendRequest( _request, wideHeaders.c_str(), (DWORD)-1L, WINHTTP_NO_REQUEST_DATA, 0, WINHTTP_IGNORE_REQUEST_TOTAL_LENGTH, 0 ))
+    {
+        return FALSE;
+    }
+
+    while (true)
+    {
+        void const* data;
+        size_t size;
+        if (!_pump.Next( &data, &size ))
+        {
+            return FALSE;
+        }
+        if (size == 0)
+        {
+            return TRUE;
+        }
+        DWORD written = 0;
+        if (!WinHttpWriteData( _request, data, (DWORD)size, &written ) || written != size)
+        {
+            return FALSE;
+        }
+        _pump.Sent();
+    }
+}
+
+bool SimpleHttpRequest::Send(const std::wstring &url, const std::wstring &method, const std::wstring &path, void *body, DWORD bodySize, HttpBodyPump *pump, HttpResponseSink &sink)
 {
     DWORD dwSize=0;
     DWORD dwDownloaded=0;
@@ -28,35 +307,50 @@ bool SimpleHttpRequest::SendRequest(const std::wstring &url, const std::wstring
     HINTERNET hRequest=0;
 
     m_responseHeader.resize(0);
-    m_responseBody.resize(0);
 
-    hSession = WinHttpOpen( m_userAgent.c_str(), WINHTTP_ACCESS_TYPE_DEFAULT_PROXY, WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0 );
-    if (!hSession)
+    INTERNET_PORT port = m_port ? m_port : (m_secure ? INTERNET_DEFAULT_HTTPS_PORT : INTERNET_DEFAULT_HTTP_PORT);
+    if (m_pool)
     {
-        //printf("session handle failed\n");
+        // the pool owns the session
+        hConnect = m_pool->Acquire( url, port, m_secure );
     }
     else
     {
-        int port = (m_secure ? INTERNET_DEFAULT_HTTPS_PORT : INTERNET_DEFAULT_HTTP_PORT);
-        hConnect = WinHttpConnect( hSession, url.c_str(), port, 0 );
-        if (!hConnect)
+        hSession = WinHttpOpen( m_userAgent.c_str(), WINHTTP_ACCESS_TYPE_DEFAULT_PROXY, WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0 );
+        if (!hSession)
         {
-            //printf("connect handle failed\n");
+            //printf("session handle failed\n");
         }
         else
         {
-            hRequest = WinHttpOpenRequest( hConnect, method.c_str(), path.c_str(), NULL, WINHTTP_NO_REFERER, WINHTTP_DEFAULT_ACCEPT_TYPES, 
-                (m_secure ? WINHTTP_FLAG_SECURE : 0) );
+            hConnect = WinHttpConnect( hSession, url.c_str(), port, 0 );
+        }
+    }
 
-            if (hRequest)
+    if (!hConnect)
+    {
+        //printf("connect handle failed\n");
+    }
+    else
+    {
+        hRequest = WinHttpOpenRequest( hConnect, method.c_str(), path.c_str(), NULL, WINHTTP_NO_REFERER, WINHTTP_DEFAULT_ACCEPT_TYPES, 
+            (m_secure ? WINHTTP_FLAG_SECURE : 0) );
+
+        if (hRequest)
+        {
+            if (pump)
             {
-                bResults = WinHttpSendRequest( hRequest, WINHTTP_NO_ADDITIONAL_HEADERS, 0, body, bodySize, bodySize, 0 );
+                bResults = HttpSendStreamed( hRequest, *pump );
             }
             else
             {
-                //printf("request handle failed\n");        
+                bResults = WinHttpSendRequest( hRequest, WINHTTP_NO_ADDITIONAL_HEADERS, 0, body, bodySize, bodySize, 0 );
             }
         }
+        else
+        {
+            //printf("request handle failed\n");        
+        }
     }
 
 
@@ -85,44 +379,43 @@ bool SimpleHttpRequest::SendRequest(const std::wstring &url, const std::wstring
     }
     if (bResults)
     {
-        do
+        bResults = sink.Begin( HttpContentLength( hRequest ) );
+        if (bResults)
         {
-            // Check for available data.
-            dwSize = 0;
-            bResults = WinHttpQueryDataAvailable( hRequest, &dwSize );
-            if (!bResults)
-            {
-                //printf( "Error %u in WinHttpQueryDataAvailable.\n", GetLastError( ) );
-                break;
-            }
-
-            if (dwSize == 0)
-                break;
-
+            // read through a buffer of our own and hand each piece on, so
+            // the sink decides what to keep
+            std::vector<BYTE> buffer(ReadBufferSize);
             do
             {
-                // Allocate space for the buffer.
-                DWORD dwOffset = m_responseBody.size();
-                m_responseBody.resize(dwOffset+dwSize);
+                // Check for available data.
+                dwSize = 0;
+                bResults = WinHttpQueryDataAvailable( hRequest, &dwSize );
+                if (!bResults)
+                {
+                    //printf( "Error %u in WinHttpQueryDataAvailable.\n", GetLastError( ) );
+                    break;
+                }
+
+                if (dwSize == 0)
+                    break;
 
                 // Read the data.
-                bResults = WinHttpReadData( hRequest, &m_responseBody[dwOffset], dwSize, &dwDownloaded );
+                DWORD dwRead = (dwSize < buffer.size()) ? dwSize : (DWORD)buffer.size();
+                bResults = WinHttpReadData( hRequest, &buffer[0], dwRead, &dwDownloaded );
                 if (!bResults)
                 {
                     //printf( "Error %u in WinHttpReadData.\n", GetLastError( ) );
-                    dwDownloaded = 0;
+                    break;
                 }
 
-                m_responseBody.resize(dwOffset+dwDownloaded);
-
                 if (dwDownloaded == 0)
                     break;
 
-                dwSize -= dwDownloaded;
+                bResults = sink.Write( &buffer[0], dwDownloaded );
             }
-            while (dwSize > 0);
+            while (bResults);
+            sink.End( bResults != FALSE );
         }
-        while (true);
     }
 
     // Report any errors.
@@ -133,8 +426,16 @@ bool SimpleHttpRequest::SendRequest(const std::wstring &url, const std::wstring
 
     // Close any open handles.
     if( hRequest ) WinHttpCloseHandle( hRequest );
-    if( hConnect ) WinHttpCloseHandle( hConnect );
+    if( hConnect )
+    {
+        // the whole body has been read if bResults, leaving the socket free
+        // for the next request
+        if( m_pool ) m_pool->Release( hConnect, bResults != FALSE );
+        else WinHttpCloseHandle( hConnect );
+    }
     if( hSession ) WinHttpCloseHandle( hSession );
 
     return bResults;
-}
\ No newline at end of file
+}
+
+#endif
@@ -8,19 +8,153 @@
  *----------------------------------------------------------------------------
  */
 
+#ifndef _SIMPLEHTTP_H
+#define _SIMPLEHTTP_H
 
+// WinHTTP on Windows, plain sockets (SimpleHttpSockets.cpp) everywhere else
+#ifdef _WIN32
+#define F_SIMPLEHTTP_SOCKETS (0)
+#else
+#define F_SIMPLEHTTP_SOCKETS (1)
+#endif
+
+#if F_SIMPLEHTTP_SOCKETS
+typedef unsigned int DWORD;
+typedef unsigned char BYTE;
+typedef unsigned short INTERNET_PORT;
+struct HttpSocket;
+#else
+#include <windows.h>
+#include <winhttp.h>
+#endif
+#include "HttpBody.h"
+#include "HttpSink.h"
 #include <string>
 #include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Keeps connections open between requests, so repeated requests to
+///        the same host reuse keep-alive sockets instead of paying for a new
+///        TCP and TLS handshake each time: WinHTTP connection handles and
+///        the session that owns their sockets, or the sockets themselves.
+///        Connections are keyed on host, port and whether they are secure.
+class HttpConnectionPool
+{
+public:
+#if F_SIMPLEHTTP_SOCKETS
+    typedef HttpSocket* Handle;
+#else
+    typedef HINTERNET Handle;
+#endif
+
+    struct Options
+    {
+        Options() :
+            m_idleTimeoutMs(30000),
+            m_maxPerHost(4)
+        {
+        }
+
+        /// Connections unused for longer than this are closed; once they
+        /// all are the session goes too, taking its sockets with it
+        unsigned m_idleTimeoutMs;
+        /// Requests to one host beyond this wait for a connection to free
+        unsigned m_maxPerHost;
+    };
+
+    HttpConnectionPool(const std::wstring& _userAgent, Options const& _options = Options());
+    ~HttpConnectionPool();
+
+    /// A connection for the host, opening one if none is idle; NULL if it
+    /// can't be opened. Must be handed back with Release.
+    Handle Acquire(const std::wstring& _host, INTERNET_PORT _port, bool _secure);
+    /// Hand back a connection from Acquire. Pass false for _reusable if the
+    /// request failed, so the connection is closed rather than reused.
+    void Release(Handle _connect, bool _reusable);
+    /// Close connections idle for longer than the timeout
+    void Trim();
+
+    /// Acquires served by an idle connection
+    unsigned Hits() const;
+    /// Acquires that had to open a connection
+    unsigned Misses() const;
+
+    const std::wstring& UserAgent() const { return m_userAgent; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Connection
+    {
+        std::wstring m_host;
+        INTERNET_PORT m_port;
+        bool m_secure;
+        Handle m_connect;
+        bool m_busy;
+        Clock::time_point m_lastUsed;
+    };
+
+    HttpConnectionPool(HttpConnectionPool const&);
+    HttpConnectionPool& operator=(HttpConnectionPool const&);
+
+    // The backend's part: open a connection (under the lock, so nothing
+    // slow), connect it (outside), check an idle one is still fit to reuse
+    // and close one
+    Handle OpenLocked(const std::wstring& _host, INTERNET_PORT _port, bool _secure);
+    static bool Connect(Handle _connect);
+    static bool Reusable(Handle _connect);
+    static void Close(Handle _connect);
+
+    void TrimLocked(Clock::time_point _now);
+    unsigned CountLocked(const std::wstring& _host, INTERNET_PORT _port, bool _secure) const;
+
+    std::wstring m_userAgent;
+    Options m_options;
+#if !F_SIMPLEHTTP_SOCKETS
+    HINTERNET m_session;
+#endif
+    std::vector<Connection> m_connections;
+    unsigned m_hits;
+    unsigned m_misses;
+    mutable std::mutex m_lock;
+    std::condition_variable m_released;
+};
+
+#if !F_SIMPLEHTTP_SOCKETS
+/// Content-Length of a response whose headers have arrived, or
+/// HttpResponseSink::UnknownLength
+uint64 HttpContentLength(HINTERNET _request);
+#endif
 
 class SimpleHttpRequest
 {
 private:
     std::wstring m_userAgent;
+    HttpConnectionPool* m_pool;
+
+    bool Send(const std::wstring&, const std::wstring&, const std::wstring&, void*, DWORD, HttpBodyPump*, HttpResponseSink&);
 
 public:
     SimpleHttpRequest(const std::wstring&, bool _secure);
+    /// Requests made through the pool, which must outlive the request
+    SimpleHttpRequest(HttpConnectionPool& _pool, bool _secure);
     bool SendRequest(const std::wstring&, const std::wstring&, const std::wstring&, void*, DWORD);
+    /// The body goes to _sink rather than m_responseBody, a piece at a time
+    bool SendRequest(const std::wstring&, const std::wstring&, const std::wstring&, void*, DWORD, HttpResponseSink& _sink);
+    /// The body is read from _body as it is sent, so it needn't be in
+    /// memory nor under 4GB, and is sent chunked if its length is unknown
+    bool SendRequest(const std::wstring&, const std::wstring&, const std::wstring&, HttpRequestBody& _body, HttpResponseSink& _sink,
+        HttpProgress const& _progress = HttpProgress());
+    /// Bytes read from the connection at a time
+    enum { ReadBufferSize = 64 * 1024 };
     std::wstring m_responseHeader;
     std::vector<BYTE> m_responseBody;
     bool m_secure;
-};
\ No newline at end of file
+    /// 0 for the usual port for m_secure
+    INTERNET_PORT m_port;
+};
+
+#endif
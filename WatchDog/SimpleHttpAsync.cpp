@@ -0,0 +1,715 @@
+/*----------------------------------------------------------------------------
+ *  FILE: SimpleHttpAsync.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "windows.h"
+#include "winhttp.h"
+#include "SimpleHttpAsync.h"
+#include "SimpleHttp.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/// A request from Send until its completion has been called.
+///
+/// Only one thread at a time may call WinHTTP with m_request, and nothing may
+/// use it once it is closed. m_depth counts the threads between a WinHTTP
+/// call and Leave, including callbacks delivered inline; whichever of them
+/// brings it back to zero after m_closing is set closes the handle, so it is
+/// never closed from under a call in progress. HANDLE_CLOSING is the last
+/// callback for a handle and completes the request.
+struct AsyncHttpClient::Pending
+{
+	Pending(std::wstring const& _host, bool _secure, std::wstring const& _method, std::wstring const& _path,
+		void const* _body, DWORD _bodySize, Completion const& _completion) :
+		m_client(NULL),
+		m_id(0),
+		m_host(_host),
+		m_secure(_secure),
+		m_method(_method),
+		m_path(_path),
+		m_body((BYTE const*)_body, (BYTE const*)_body + _bodySize),
+		m_completion(_completion),
+		m_hasDeadline(false),
+		m_connect(0),
+		m_request(0),
+		m_depth(0),
+		m_closing(false),
+		m_closeIssued(false),
+		m_sink(&m_bodySink),
+		m_bodySink(m_response.m_body),
+		m_sinkBegun(false)
+	{
+	}
+
+	AsyncHttpClient* m_client;
+	RequestId m_id;
+	std::wstring m_host;
+	bool m_secure;
+	std::wstring m_method;
+	std::wstring m_path;
+	std::vector<BYTE> m_body;
+	Completion m_completion;
+	bool m_hasDeadline;
+	Clock::time_point m_deadline;
+
+	HINTERNET m_connect;
+	HINTERNET m_request;
+	unsigned m_depth;			///< guarded by m_client->m_lock, as are the two below
+	bool m_closing;				///< the outcome in m_response is decided
+	bool m_closeIssued;
+
+	HttpResponse m_response;
+	HttpResponseSink* m_sink;	///< the caller's, or m_bodySink
+	HttpVectorSink m_bodySink;
+	bool m_sinkBegun;
+	std::vector<BYTE> m_buffer;	///< the read in progress lands here
+	std::unique_ptr<HttpBodyPump> m_pump;	///< if the body is streamed rather than m_body
+};
+
+AsyncHttpClient::AsyncHttpClient
+(
+	std::wstring const& _userAgent,
+	Options const& _options
+):
+	m_userAgent(_userAgent),
+	m_options(_options),
+	m_session(0),
+	m_openError(0),
+	m_inFlight(0),
+	m_nextId(1),
+	m_stopping(false)
+{
+	if (m_options.m_maxInFlight == 0)
+	{
+		m_options.m_maxInFlight = 1;
+	}
+
+	m_session = WinHttpOpen(m_userAgent.c_str(), WINHTTP_ACCESS_TYPE_DEFAULT_PROXY, WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, WINHTTP_FLAG_ASYNC);
+	if (!m_session)
+	{
+		m_openError = GetLastError();
+	}
+	else
+	{
+		// Handles made from the session inherit the callback
+		WinHttpSetStatusCallback(m_session, StatusCallback, WINHTTP_CALLBACK_FLAG_ALL_COMPLETIONS | WINHTTP_CALLBACK_FLAG_HANDLES, 0);
+		DWORD maxConns = m_options.m_maxInFlight;
+		WinHttpSetOption(m_session, WINHTTP_OPTION_MAX_CONNS_PER_SERVER, &maxConns, sizeof(maxConns));
+	}
+
+	m_deadlines = std::thread([this]() { DeadlineThread(); });
+}
+
+AsyncHttpClient::~AsyncHttpClient()
+{
+	CancelAll();
+	{
+		std::unique_lock<std::mutex> lock(m_lock);
+		while (!m_requests.empty())
+		{
+			m_changed.wait(lock);
+		}
+		m_stopping = true;
+	}
+	m_changed.notify_all();
+	m_deadlines.join();
+
+	if (m_session)
+	{
+		WinHttpSetStatusCallback(m_session, NULL, WINHTTP_CALLBACK_FLAG_ALL_COMPLETIONS | WINHTTP_CALLBACK_FLAG_HANDLES, 0);
+		WinHttpCloseHandle(m_session);
+	}
+}
+
+AsyncHttpClient::RequestId AsyncHttpClient::Send
+(
+	std::wstring const& _host,
+	bool _secure,
+	std::wstring const& _method,
+	std::wstring const& _path,
+	void const* _body,
+	DWORD _bodySize,
+	Completion const& _completion,
+	unsigned _deadlineMs
+)
+{
+	return Send(new Pending(_host, _secure, _method, _path, _body, _bodySize, _completion), _deadlineMs);
+}
+
+AsyncHttpClient::RequestId AsyncHttpClient::Send
+(
+	std::wstring const& _host,
+	bool _secure,
+	std::wstring const& _method,
+	std::wstring const& _path,
+	void const* _body,
+	DWORD _bodySize,
+	HttpResponseSink& _sink,
+	Completion const& _completion,
+	unsigned _deadlineMs
+)
+{
+	Pending* pending = new Pending(_host, _secure, _method, _path, _body, _bodySize, _completion);
+	pending->m_sink = &_sink;
+	return Send(pending, _deadlineMs);
+}
+
+AsyncHttpClient::RequestId AsyncHttpClient::Send
+(
+	std::wstring const& _host,
+	bool _secure,
+	std::wstring const& _method,
+	std::wstring const& _path,
+	HttpRequestBody& _body,
+	HttpResponseSink& _sink,
+	Completion const& _completion,
+	HttpProgress const& _progress,
+	unsigned _deadlineMs
+)
+{
+	Pending* pending = new Pending(_host, _secure, _method, _path, NULL, 0, _completion);
+	pending->m_sink = &_sink;
+	pending->m_pump.reset(new HttpBodyPump(_body, _progress));
+	return Send(pending, _deadlineMs);
+}
+
+std::future<HttpResponse> AsyncHttpClient::Send
+(
+	std::wstring const& _host,
+	bool _secure,
+	std::wstring const& _method,
+	std::wstring const& _path,
+	void const* _body,
+	DWORD _bodySize,
+	unsigned _deadlineMs,
+	RequestId* o_id
+)
+{
+	std::shared_ptr< std::promise<HttpResponse> > promise = std::make_shared< std::promise<HttpResponse> >();
+	std::future<HttpResponse> result = promise->get_future();
+
+	RequestId id = Send(_host, _secure, _method, _path, _body, _bodySize,
+		[promise](HttpResponse& _response) { promise->set_value(std::move(_response)); }, _deadlineMs);
+	if (o_id)
+	{
+		*o_id = id;
+	}
+	return result;
+}
+
+AsyncHttpClient::RequestId AsyncHttpClient::Send
+(
+	Pending* _pending,
+	unsigned _deadlineMs
+)
+{
+	_pending->m_client = this;
+	unsigned deadlineMs = (_deadlineMs != 0) ? _deadlineMs : m_options.m_deadlineMs;
+	if (deadlineMs != 0)
+	{
+		_pending->m_hasDeadline = true;
+		_pending->m_deadline = Clock::now() + std::chrono::milliseconds(deadlineMs);
+	}
+
+	bool started = false;
+	RequestId id;
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		id = m_nextId++;
+		_pending->m_id = id;
+		m_requests[id] = _pending;
+
+		if (!m_session)
+		{
+			FinishLocked(_pending, m_openError);
+		}
+		else if (m_inFlight < m_options.m_maxInFlight && m_queue.empty())
+		{
+			started = StartLocked(_pending);
+		}
+		else
+		{
+			m_queue.push_back(_pending);
+		}
+	}
+	m_changed.notify_all();
+
+	if (started)
+	{
+		Transmit(_pending);
+	}
+	else if (_pending->m_closing)
+	{
+		Complete(_pending);
+	}
+	return id;
+}
+
+bool AsyncHttpClient::Cancel
+(
+	RequestId _id
+)
+{
+	return Abort(_id, ERROR_WINHTTP_OPERATION_CANCELLED);
+}
+
+void AsyncHttpClient::CancelAll()
+{
+	std::vector<RequestId> ids;
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		for (std::map<RequestId, Pending*>::const_iterator it = m_requests.begin(); it != m_requests.end(); ++it)
+		{
+			ids.push_back(it->first);
+		}
+	}
+	for (size_t i = 0; i < ids.size(); ++i)
+	{
+		Cancel(ids[i]);
+	}
+}
+
+bool AsyncHttpClient::WaitAll
+(
+	unsigned _timeoutMs
+)
+{
+	std::unique_lock<std::mutex> lock(m_lock);
+	return m_changed.wait_for(lock, std::chrono::milliseconds(_timeoutMs), [this]() { return m_requests.empty(); });
+}
+
+unsigned AsyncHttpClient::Outstanding() const
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	return (unsigned)m_requests.size();
+}
+
+void CALLBACK AsyncHttpClient::StatusCallback
+(
+	HINTERNET _handle,
+	DWORD_PTR _context,
+	DWORD _status,
+	LPVOID _info,
+	DWORD _infoLength
+)
+{
+	// Only request handles carry a context, the session and connections
+	// have nothing to report
+	Pending* pending = (Pending*)_context;
+	if (pending == NULL || _handle != pending->m_request)
+	{
+		return;
+	}
+	pending->m_client->OnStatus(pending, _status, _info, _infoLength);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Move the request on to its next step. Each step starts exactly one
+///        WinHTTP operation, whose completion is the next callback, or
+///        decides the outcome.
+void AsyncHttpClient::OnStatus
+(
+	Pending* _pending,
+	DWORD _status,
+	LPVOID _info,
+	DWORD _infoLength
+)
+{
+	if (_status == WINHTTP_CALLBACK_STATUS_HANDLE_CLOSING)
+	{
+		WinHttpCloseHandle(_pending->m_connect);
+		Complete(_pending);
+		return;
+	}
+
+	bool closing;
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		++_pending->m_depth;
+		closing = _pending->m_closing;
+	}
+
+	HINTERNET request = _pending->m_request;
+	HttpResponse& response = _pending->m_response;
+	DWORD error = 0;
+	bool done = false;
+	if (closing)
+	{
+		// cancelled or past its deadline, whatever this was is no longer wanted
+	}
+	else if (_status == WINHTTP_CALLBACK_STATUS_REQUEST_ERROR)
+	{
+		error = ((WINHTTP_ASYNC_RESULT*)_info)->dwError;
+	}
+	else if (_status == WINHTTP_CALLBACK_STATUS_SENDREQUEST_COMPLETE)
+	{
+		if (_pending->m_pump)
+		{
+			error = WriteNext(_pending);
+		}
+		else if (!WinHttpReceiveResponse(request, NULL))
+		{
+			error = GetLastError();
+		}
+	}
+	else if (_status == WINHTTP_CALLBACK_STATUS_WRITE_COMPLETE)
+	{
+		_pending->m_pump->Sent();
+		error = WriteNext(_pending);
+	}
+	else if (_status == WINHTTP_CALLBACK_STATUS_HEADERS_AVAILABLE)
+	{
+		DWORD status = 0;
+		DWORD size = sizeof(status);
+		if (WinHttpQueryHeaders(request, WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER, WINHTTP_HEADER_NAME_BY_INDEX, &status, &size, WINHTTP_NO_HEADER_INDEX))
+		{
+			response.m_status = status;
+		}
+
+		size = 0;
+		if (!WinHttpQueryHeaders(request, WINHTTP_QUERY_RAW_HEADERS_CRLF, WINHTTP_HEADER_NAME_BY_INDEX, WINHTTP_NO_OUTPUT_BUFFER, &size, WINHTTP_NO_HEADER_INDEX) &&
+			GetLastError() == ERROR_INSUFFICIENT_BUFFER && size != 0)
+		{
+			response.m_header.resize(size / sizeof(wchar_t));
+			if (!WinHttpQueryHeaders(request, WINHTTP_QUERY_RAW_HEADERS_CRLF, WINHTTP_HEADER_NAME_BY_INDEX, &response.m_header[0], &size, WINHTTP_NO_HEADER_INDEX))
+			{
+				size = 0;
+			}
+			response.m_header.resize(size / sizeof(wchar_t));
+		}
+
+		if (!_pending->m_sink->Begin(HttpContentLength(request)))
+		{
+			error = ERROR_WINHTTP_OPERATION_CANCELLED;
+		}
+		else
+		{
+			_pending->m_sinkBegun = true;
+			_pending->m_buffer.resize(SimpleHttpRequest::ReadBufferSize);
+			if (!WinHttpQueryDataAvailable(request, NULL))
+			{
+				error = GetLastError();
+			}
+		}
+	}
+	else if (_status == WINHTTP_CALLBACK_STATUS_DATA_AVAILABLE)
+	{
+		DWORD available = *(DWORD*)_info;
+		if (available == 0)
+		{
+			done = true;
+		}
+		else
+		{
+			DWORD size = (available < _pending->m_buffer.size()) ? available : (DWORD)_pending->m_buffer.size();
+			if (!WinHttpReadData(request, &_pending->m_buffer[0], size, NULL))
+			{
+				error = GetLastError();
+			}
+		}
+	}
+	else if (_status == WINHTTP_CALLBACK_STATUS_READ_COMPLETE)
+	{
+		if (_infoLength == 0)
+		{
+			done = true;
+		}
+		else if (!_pending->m_sink->Write(&_pending->m_buffer[0], _infoLength))
+		{
+			error = ERROR_WINHTTP_OPERATION_CANCELLED;
+		}
+		else if (!WinHttpQueryDataAvailable(request, NULL))
+		{
+			error = GetLastError();
+		}
+	}
+
+	if (error != 0 || done)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		FinishLocked(_pending, error);
+	}
+	Leave(_pending);
+}
+
+bool AsyncHttpClient::Abort
+(
+	RequestId _id,
+	DWORD _error
+)
+{
+	Pending* dequeued = NULL;
+	HINTERNET close = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		std::map<RequestId, Pending*>::iterator it = m_requests.find(_id);
+		if (it == m_requests.end() || !FinishLocked(it->second, _error))
+		{
+			return false;
+		}
+
+		Pending* pending = it->second;
+		if (!pending->m_request)
+		{
+			for (std::deque<Pending*>::iterator queued = m_queue.begin(); queued != m_queue.end(); ++queued)
+			{
+				if (*queued == pending)
+				{
+					m_queue.erase(queued);
+					break;
+				}
+			}
+			dequeued = pending;
+		}
+		else if (pending->m_depth == 0 && !pending->m_closeIssued)
+		{
+			pending->m_closeIssued = true;
+			close = pending->m_request;
+		}
+	}
+
+	if (close)
+	{
+		WinHttpCloseHandle(close);
+	}
+	if (dequeued)
+	{
+		Complete(dequeued);
+	}
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Decide the outcome, if it hasn't been already
+/// @return false if it had
+bool AsyncHttpClient::FinishLocked
+(
+	Pending* _pending,
+	DWORD _error
+)
+{
+	if (_pending->m_closing)
+	{
+		return false;
+	}
+	_pending->m_closing = true;
+	_pending->m_response.m_ok = (_error == 0);
+	_pending->m_response.m_error = _error;
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Open the handles for a request, which counts as in flight from
+///        here. Nothing is sent until Transmit, as WinHTTP may call back
+///        before it returns and the callback takes m_lock.
+/// @return false, with the outcome decided, if the handles couldn't be opened
+bool AsyncHttpClient::StartLocked
+(
+	Pending* _pending
+)
+{
+	INTERNET_PORT port = (_pending->m_secure ? INTERNET_DEFAULT_HTTPS_PORT : INTERNET_DEFAULT_HTTP_PORT);
+	_pending->m_connect = WinHttpConnect(m_session, _pending->m_host.c_str(), port, 0);
+	if (_pending->m_connect)
+	{
+		_pending->m_request = WinHttpOpenRequest(_pending->m_connect, _pending->m_method.c_str(), _pending->m_path.c_str(), NULL,
+			WINHTTP_NO_REFERER, WINHTTP_DEFAULT_ACCEPT_TYPES, (_pending->m_secure ? WINHTTP_FLAG_SECURE : 0));
+	}
+	if (!_pending->m_request)
+	{
+		FinishLocked(_pending, GetLastError());
+		if (_pending->m_connect)
+		{
+			WinHttpCloseHandle(_pending->m_connect);
+			_pending->m_connect = 0;
+		}
+		return false;
+	}
+
+	DWORD_PTR context = (DWORD_PTR)_pending;
+	WinHttpSetOption(_pending->m_request, WINHTTP_OPTION_CONTEXT_VALUE, &context, sizeof(context));
+	++_pending->m_depth;		// released by Transmit
+	++m_inFlight;
+	return true;
+}
+
+void AsyncHttpClient::StartQueuedLocked
+(
+	std::vector<Pending*>& o_started,
+	std::vector<Pending*>& o_failed
+)
+{
+	while (m_inFlight < m_options.m_maxInFlight && !m_queue.empty())
+	{
+		Pending* pending = m_queue.front();
+		m_queue.pop_front();
+		if (StartLocked(pending))
+		{
+			o_started.push_back(pending);
+		}
+		else
+		{
+			o_failed.push_back(pending);
+		}
+	}
+}
+
+void AsyncHttpClient::Transmit
+(
+	Pending* _pending
+)
+{
+	BOOL sent;
+	if (_pending->m_pump)
+	{
+		// As SimpleHttpRequest, the length goes in a header of our own
+		std::string headers = _pending->m_pump->Headers();
+		std::wstring wideHeaders(headers.begin(), headers.end());
+		sent = WinHttpSendRequest(_pending->m_request, wideHeaders.c_str(), (DWORD)-1L, WINHTTP_NO_REQUEST_DATA, 0,
+			WINHTTP_IGNORE_REQUEST_TOTAL_LENGTH, (DWORD_PTR)_pending);
+	}
+	else
+	{
+		void* body = _pending->m_body.empty() ? WINHTTP_NO_REQUEST_DATA : &_pending->m_body[0];
+		DWORD size = (DWORD)_pending->m_body.size();
+		sent = WinHttpSendRequest(_pending->m_request, WINHTTP_NO_ADDITIONAL_HEADERS, 0, body, size, size, (DWORD_PTR)_pending);
+	}
+	if (!sent)
+	{
+		DWORD error = GetLastError();
+		std::lock_guard<std::mutex> lock(m_lock);
+		FinishLocked(_pending, error);
+	}
+	Leave(_pending);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Write the next piece of a streamed body, or once it has all gone
+///        wait for the response
+/// @return the error if either couldn't be started
+DWORD AsyncHttpClient::WriteNext
+(
+	Pending* _pending
+)
+{
+	void const* data;
+	size_t size;
+	if (!_pending->m_pump->Next(&data, &size))
+	{
+		return ERROR_READ_FAULT;
+	}
+	BOOL started = (size == 0)
+		? WinHttpReceiveResponse(_pending->m_request, NULL)
+		: WinHttpWriteData(_pending->m_request, data, (DWORD)size, NULL);
+	return started ? 0 : GetLastError();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Done with m_request for now; close it if the outcome is decided and
+///        nobody else is using it. _pending may be gone once this returns.
+void AsyncHttpClient::Leave
+(
+	Pending* _pending
+)
+{
+	bool close = false;
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		if (--_pending->m_depth == 0 && _pending->m_closing && !_pending->m_closeIssued)
+		{
+			_pending->m_closeIssued = true;
+			close = true;
+		}
+	}
+	if (close)
+	{
+		WinHttpCloseHandle(_pending->m_request);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Hand the response over and free the slot for the next request
+void AsyncHttpClient::Complete
+(
+	Pending* _pending
+)
+{
+	if (_pending->m_sinkBegun)
+	{
+		_pending->m_sink->End(_pending->m_response.m_ok);
+	}
+	_pending->m_completion(_pending->m_response);
+
+	std::vector<Pending*> started;
+	std::vector<Pending*> failed;
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_requests.erase(_pending->m_id);
+		if (_pending->m_request)
+		{
+			--m_inFlight;
+		}
+		StartQueuedLocked(started, failed);
+		// under the lock, a waiting destructor could otherwise be gone first
+		m_changed.notify_all();
+	}
+	delete _pending;
+
+	// Still outstanding, so the client is still there
+	for (size_t i = 0; i < started.size(); ++i)
+	{
+		Transmit(started[i]);
+	}
+	for (size_t i = 0; i < failed.size(); ++i)
+	{
+		Complete(failed[i]);
+	}
+}
+
+void AsyncHttpClient::DeadlineThread()
+{
+	std::unique_lock<std::mutex> lock(m_lock);
+	while (!m_stopping)
+	{
+		Clock::time_point now = Clock::now();
+		Clock::time_point next = Clock::time_point::max();
+		std::vector<RequestId> expired;
+		for (std::map<RequestId, Pending*>::const_iterator it = m_requests.begin(); it != m_requests.end(); ++it)
+		{
+			Pending const* pending = it->second;
+			if (!pending->m_hasDeadline || pending->m_closing)
+			{
+				continue;
+			}
+			if (pending->m_deadline <= now)
+			{
+				expired.push_back(it->first);
+			}
+			else if (pending->m_deadline < next)
+			{
+				next = pending->m_deadline;
+			}
+		}
+
+		if (!expired.empty())
+		{
+			lock.unlock();
+			for (size_t i = 0; i < expired.size(); ++i)
+			{
+				Abort(expired[i], ERROR_WINHTTP_TIMEOUT);
+			}
+			lock.lock();
+		}
+		else if (next == Clock::time_point::max())
+		{
+			m_changed.wait(lock);
+		}
+		else
+		{
+			m_changed.wait_until(lock, next);
+		}
+	}
+}
@@ -0,0 +1,139 @@
+/*----------------------------------------------------------------------------
+ *  FILE: SimpleHttpAsync.h
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		Requests that don't block the caller. WinHTTP runs in asynchronous
+ *		mode and drives each request from its status callback, so no thread
+ *		is tied up per request; the only thread of our own enforces
+ *		deadlines. At most m_maxInFlight requests are on the wire at once,
+ *		the rest wait in order.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef _SIMPLEHTTPASYNC_H
+#define _SIMPLEHTTPASYNC_H
+
+#include <windows.h>
+#include <winhttp.h>
+#include "HttpBody.h"
+#include "HttpSink.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+
+struct HttpResponse
+{
+	HttpResponse() : m_ok(false), m_error(0), m_status(0) {}
+
+	bool m_ok;					///< the whole response was received
+	DWORD m_error;				///< WinHTTP error if not, ERROR_WINHTTP_TIMEOUT past the deadline
+	DWORD m_status;				///< HTTP status code, 0 if no headers arrived
+	std::wstring m_header;
+	std::vector<BYTE> m_body;	///< empty if the request was given a sink
+};
+
+class AsyncHttpClient
+{
+public:
+	struct Options
+	{
+		Options() :
+			m_maxInFlight(4),
+			m_deadlineMs(30000)
+		{
+		}
+
+		/// Requests sent at once, later ones queue
+		unsigned m_maxInFlight;
+		/// Default time from Send to completion, 0 for none
+		unsigned m_deadlineMs;
+	};
+
+	typedef unsigned RequestId;
+	/// Called once per request on a WinHTTP thread, so keep it short and
+	/// don't destroy the client from it
+	typedef std::function<void(HttpResponse&)> Completion;
+
+	AsyncHttpClient(std::wstring const& _userAgent, Options const& _options = Options());
+	/// Cancels anything outstanding and waits for it to complete
+	~AsyncHttpClient();
+
+	/// Start a request, _completion is called when it finishes, fails, is
+	/// cancelled or passes its deadline; _deadlineMs 0 takes the default
+	/// from Options. _body is copied.
+	RequestId Send(std::wstring const& _host, bool _secure, std::wstring const& _method, std::wstring const& _path,
+		void const* _body, DWORD _bodySize, Completion const& _completion, unsigned _deadlineMs = 0);
+	/// As above, the body going to _sink as it arrives rather than into
+	/// m_body. _sink must last until the completion has been called, and
+	/// abandoning the response from it completes the request with
+	/// ERROR_WINHTTP_OPERATION_CANCELLED.
+	RequestId Send(std::wstring const& _host, bool _secure, std::wstring const& _method, std::wstring const& _path,
+		void const* _body, DWORD _bodySize, HttpResponseSink& _sink, Completion const& _completion, unsigned _deadlineMs = 0);
+	/// As above, the request body read from _body as it is sent, chunked if
+	/// its length is unknown. _body and _sink must last until the
+	/// completion has been called; _progress is called on a WinHTTP thread.
+	/// Fails with ERROR_READ_FAULT if _body can't be read or is short.
+	RequestId Send(std::wstring const& _host, bool _secure, std::wstring const& _method, std::wstring const& _path,
+		HttpRequestBody& _body, HttpResponseSink& _sink, Completion const& _completion,
+		HttpProgress const& _progress = HttpProgress(), unsigned _deadlineMs = 0);
+	/// As the first, the response arriving through the future instead
+	std::future<HttpResponse> Send(std::wstring const& _host, bool _secure, std::wstring const& _method, std::wstring const& _path,
+		void const* _body, DWORD _bodySize, unsigned _deadlineMs = 0, RequestId* o_id = NULL);
+
+	/// Complete the request with ERROR_WINHTTP_OPERATION_CANCELLED, false if
+	/// it has already completed
+	bool Cancel(RequestId _id);
+	void CancelAll();
+	/// Wait for everything sent so far, false if _timeoutMs passes first
+	bool WaitAll(unsigned _timeoutMs);
+
+	/// Requests sent or queued and not yet completed
+	unsigned Outstanding() const;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+	struct Pending;
+
+	AsyncHttpClient(AsyncHttpClient const&);
+	AsyncHttpClient& operator=(AsyncHttpClient const&);
+
+	static void CALLBACK StatusCallback(HINTERNET _handle, DWORD_PTR _context, DWORD _status, LPVOID _info, DWORD _infoLength);
+	void OnStatus(Pending* _pending, DWORD _status, LPVOID _info, DWORD _infoLength);
+
+	RequestId Send(Pending* _pending, unsigned _deadlineMs);
+	bool Abort(RequestId _id, DWORD _error);
+	bool FinishLocked(Pending* _pending, DWORD _error);
+	bool StartLocked(Pending* _pending);
+	void StartQueuedLocked(std::vector<Pending*>& o_started, std::vector<Pending*>& o_failed);
+	void Transmit(Pending* _pending);
+	DWORD WriteNext(Pending* _pending);
+	void Leave(Pending* _pending);
+	void Complete(Pending* _pending);
+	void DeadlineThread();
+
+	std::wstring m_userAgent;
+	Options m_options;
+	HINTERNET m_session;
+	DWORD m_openError;
+
+	mutable std::mutex m_lock;
+	std::condition_variable m_changed;			///< request completed or deadline added
+	std::map<RequestId, Pending*> m_requests;	///< sent or queued
+	std::deque<Pending*> m_queue;
+	unsigned m_inFlight;
+	RequestId m_nextId;
+	bool m_stopping;
+	std::thread m_deadlines;
+};
+
+#endif
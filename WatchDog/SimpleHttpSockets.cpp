@@ -0,0 +1,1010 @@
+/*----------------------------------------------------------------------------
+ *  FILE: SimpleHttpSockets.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		SimpleHttpRequest over plain sockets, for where there is no WinHTTP.
+ *		Sockets are non-blocking, every wait goes through poll with a
+ *		timeout, and TLS is OpenSSL's when its headers are there to build
+ *		against (link with -lssl -lcrypto); without it secure requests fail.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "SimpleHttp.h"
+
+#if F_SIMPLEHTTP_SOCKETS
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <memory>
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#define F_SIMPLEHTTP_SENDFILE (1)
+#else
+#define F_SIMPLEHTTP_SENDFILE (0)
+#endif
+
+#if defined(__has_include)
+#if __has_include(<openssl/ssl.h>)
+#define F_SIMPLEHTTP_OPENSSL (1)
+#endif
+#endif
+#ifndef F_SIMPLEHTTP_OPENSSL
+#define F_SIMPLEHTTP_OPENSSL (0)
+#endif
+
+#if F_SIMPLEHTTP_OPENSSL
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL (0)		// SO_NOSIGPIPE is set on the socket instead
+#endif
+
+// WinHTTP's defaults, each for one wait rather than the whole request
+static const int s_connectTimeoutMs = 60000;
+static const int s_transferTimeoutMs = 30000;
+
+// A request body up to this size goes in the same send as the head
+static const size_t s_coalesceSize = 16 * 1024;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief UTF-8 of _text, for the request line and headers
+static std::string Narrow
+(
+	std::wstring const& _text
+)
+{
+	std::string narrow;
+	narrow.reserve(_text.size());
+	for (size_t i = 0; i < _text.size(); ++i)
+	{
+		unsigned long c = (unsigned long)_text[i];
+		if (c < 0x80)
+		{
+			narrow += (char)c;
+		}
+		else if (c < 0x800)
+		{
+			narrow += (char)(0xC0 | (c >> 6));
+			narrow += (char)(0x80 | (c & 0x3F));
+		}
+		else if (c < 0x10000)
+		{
+			narrow += (char)(0xE0 | (c >> 12));
+			narrow += (char)(0x80 | ((c >> 6) & 0x3F));
+			narrow += (char)(0x80 | (c & 0x3F));
+		}
+		else
+		{
+			narrow += (char)(0xF0 | ((c >> 18) & 0x07));
+			narrow += (char)(0x80 | ((c >> 12) & 0x3F));
+			narrow += (char)(0x80 | ((c >> 6) & 0x3F));
+			narrow += (char)(0x80 | (c & 0x3F));
+		}
+	}
+	return narrow;
+}
+
+static bool StartsWithNoCase
+(
+	char const* _text,
+	size_t _length,
+	char const* _prefix
+)
+{
+	size_t prefixLength = strlen(_prefix);
+	return _length >= prefixLength && strncasecmp(_text, _prefix, prefixLength) == 0;
+}
+
+/// Whether the comma separated header value has _token in it
+static bool HasToken
+(
+	std::string const& _value,
+	char const* _token
+)
+{
+	size_t tokenLength = strlen(_token);
+	for (size_t i = 0; i + tokenLength <= _value.size(); ++i)
+	{
+		if (strncasecmp(&_value[i], _token, tokenLength) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+#if F_SIMPLEHTTP_OPENSSL
+
+static SSL_CTX* NewTlsContext()
+{
+	// OpenSSL writes to the socket itself, without MSG_NOSIGNAL, so a server
+	// hanging up mid request would otherwise end the process. Only if no
+	// one has a handler of their own.
+	struct sigaction action;
+	if (sigaction(SIGPIPE, NULL, &action) == 0 && action.sa_handler == SIG_DFL)
+	{
+		signal(SIGPIPE, SIG_IGN);
+	}
+
+	SSL_CTX* context = SSL_CTX_new(TLS_client_method());
+	if (context == NULL)
+	{
+		return NULL;
+	}
+	SSL_CTX_set_min_proto_version(context, TLS1_2_VERSION);
+	SSL_CTX_set_default_verify_paths(context);
+	SSL_CTX_set_verify(context, SSL_VERIFY_PEER, NULL);
+	// SSL_write may take part of a buffer, as send does
+	SSL_CTX_set_mode(context, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+	return context;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief One for the process, loading the trusted roots is the slow part
+static SSL_CTX* TlsContext()
+{
+	static SSL_CTX* s_context = NewTlsContext();
+	return s_context;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief A connection to a host, with what has been received of the
+///        response but not yet consumed. The pool's handle.
+struct HttpSocket
+{
+	HttpSocket(std::wstring const& _host, INTERNET_PORT _port, bool _secure);
+	~HttpSocket();
+
+	bool Connect();
+	/// Whether an idle connection can carry another request: nothing has
+	/// arrived on it since the last response, not even the server closing it
+	bool Reusable();
+
+	bool Send(void const* _data, size_t _size);
+	/// Send the rest of the pump's File() without copying it through user
+	/// space; true with nothing sent if it can't be, Next sends it instead
+	bool SendFromFile(HttpBodyPump& _pump);
+
+	/// Receive more onto the end of what is buffered
+	/// @return bytes received, 0 if the connection was closed, -1 on an
+	///         error or timeout
+	int Fill();
+	char const* Data() const { return &m_buffer[m_begin]; }
+	size_t Available() const { return m_end - m_begin; }
+	void Consume(size_t _size) { m_begin += _size; }
+	/// The next line, without its CRLF
+	bool ReadLine(std::string* o_line);
+
+	std::string m_host;
+	INTERNET_PORT m_port;
+	bool m_secure;
+	int m_socket;
+	bool m_used;			///< has carried a request, so the server may since have closed it
+#if F_SIMPLEHTTP_OPENSSL
+	SSL* m_tls;
+#endif
+
+private:
+	HttpSocket(HttpSocket const&);
+	HttpSocket& operator=(HttpSocket const&);
+
+	bool Wait(short _events, int _timeoutMs);
+#if F_SIMPLEHTTP_OPENSSL
+	/// Wait for whatever an SSL call that returned _result wants
+	bool WaitTls(int _result, int _timeoutMs);
+#endif
+
+	std::vector<char> m_buffer;
+	size_t m_begin;
+	size_t m_end;
+};
+
+HttpSocket::HttpSocket
+(
+	std::wstring const& _host,
+	INTERNET_PORT _port,
+	bool _secure
+):
+	m_host(Narrow(_host)),
+	m_port(_port),
+	m_secure(_secure),
+	m_socket(-1),
+	m_used(false),
+#if F_SIMPLEHTTP_OPENSSL
+	m_tls(NULL),
+#endif
+	m_buffer(SimpleHttpRequest::ReadBufferSize),
+	m_begin(0),
+	m_end(0)
+{
+}
+
+HttpSocket::~HttpSocket()
+{
+#if F_SIMPLEHTTP_OPENSSL
+	if (m_tls)
+	{
+		// no close_notify, we are done with the connection whatever the
+		// server makes of it
+		SSL_free(m_tls);
+	}
+#endif
+	if (m_socket >= 0)
+	{
+		close(m_socket);
+	}
+}
+
+bool HttpSocket::Wait
+(
+	short _events,
+	int _timeoutMs
+)
+{
+	pollfd poll_ = { m_socket, _events, 0 };
+	while (true)
+	{
+		int ready = poll(&poll_, 1, _timeoutMs);
+		if (ready > 0)
+		{
+			return true;
+		}
+		if (ready == 0 || errno != EINTR)
+		{
+			return false;
+		}
+	}
+}
+
+#if F_SIMPLEHTTP_OPENSSL
+bool HttpSocket::WaitTls
+(
+	int _result,
+	int _timeoutMs
+)
+{
+	switch (SSL_get_error(m_tls, _result))
+	{
+	case SSL_ERROR_WANT_READ:
+		return Wait(POLLIN, _timeoutMs);
+	case SSL_ERROR_WANT_WRITE:
+		return Wait(POLLOUT, _timeoutMs);
+	default:
+		return false;
+	}
+}
+#endif
+
+bool HttpSocket::Connect()
+{
+	addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	char service[8];
+	snprintf(service, sizeof(service), "%u", (unsigned)m_port);
+	addrinfo* addresses = NULL;
+	if (getaddrinfo(m_host.c_str(), service, &hints, &addresses) != 0)
+	{
+		return false;
+	}
+
+	// each address in turn, as WinHTTP does
+	for (addrinfo* address = addresses; address && m_socket < 0; address = address->ai_next)
+	{
+		int s = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+		if (s < 0)
+		{
+			continue;
+		}
+		fcntl(s, F_SETFD, FD_CLOEXEC);
+		fcntl(s, F_SETFL, fcntl(s, F_GETFL) | O_NONBLOCK);
+		m_socket = s;
+
+		int error = 0;
+		socklen_t errorSize = sizeof(error);
+		if (connect(s, address->ai_addr, address->ai_addrlen) != 0 &&
+			(errno != EINPROGRESS || !Wait(POLLOUT, s_connectTimeoutMs) ||
+			 getsockopt(s, SOL_SOCKET, SO_ERROR, &error, &errorSize) != 0 || error != 0))
+		{
+			close(s);
+			m_socket = -1;
+		}
+	}
+	freeaddrinfo(addresses);
+	if (m_socket < 0)
+	{
+		return false;
+	}
+
+	// A request is a head and a body written separately then a wait for the
+	// response, which Nagle would hold up for a delayed ACK
+	int one = 1;
+	setsockopt(m_socket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+	setsockopt(m_socket, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+	if (!m_secure)
+	{
+		return true;
+	}
+#if F_SIMPLEHTTP_OPENSSL
+	SSL_CTX* context = TlsContext();
+	if (context == NULL || (m_tls = SSL_new(context)) == NULL)
+	{
+		return false;
+	}
+	SSL_set_fd(m_tls, m_socket);
+	// the name to ask for and to check the certificate against, which for
+	// an address is its IP SAN rather than SNI
+	unsigned char address[16];
+	if (inet_pton(AF_INET, m_host.c_str(), address) == 1 || inet_pton(AF_INET6, m_host.c_str(), address) == 1)
+	{
+		X509_VERIFY_PARAM_set1_ip_asc(SSL_get0_param(m_tls), m_host.c_str());
+	}
+	else
+	{
+		SSL_set_tlsext_host_name(m_tls, m_host.c_str());
+		SSL_set1_host(m_tls, m_host.c_str());
+	}
+	while (true)
+	{
+		ERR_clear_error();
+		int result = SSL_connect(m_tls);
+		if (result == 1)
+		{
+			return true;
+		}
+		if (!WaitTls(result, s_connectTimeoutMs))
+		{
+			return false;
+		}
+	}
+#else
+	return false;
+#endif
+}
+
+bool HttpSocket::Reusable()
+{
+	if (m_socket < 0 || Available() != 0)
+	{
+		return false;
+	}
+#if F_SIMPLEHTTP_OPENSSL
+	if (m_tls && SSL_pending(m_tls) != 0)
+	{
+		return false;
+	}
+#endif
+	// Readable means closed, or something we didn't ask for
+	pollfd poll_ = { m_socket, POLLIN, 0 };
+	return poll(&poll_, 1, 0) == 0;
+}
+
+bool HttpSocket::Send
+(
+	void const* _data,
+	size_t _size
+)
+{
+	char const* data = (char const*)_data;
+	while (_size != 0)
+	{
+		size_t size = (_size < (1u << 30)) ? _size : (1u << 30);
+#if F_SIMPLEHTTP_OPENSSL
+		if (m_tls)
+		{
+			ERR_clear_error();
+			int sent = SSL_write(m_tls, data, (int)size);
+			if (sent <= 0)
+			{
+				if (!WaitTls(sent, s_transferTimeoutMs))
+				{
+					return false;
+				}
+				continue;
+			}
+			data += sent;
+			_size -= (size_t)sent;
+			continue;
+		}
+#endif
+		ssize_t sent = send(m_socket, data, size, MSG_NOSIGNAL);
+		if (sent < 0)
+		{
+			if (errno == EINTR || ((errno == EAGAIN || errno == EWOULDBLOCK) && Wait(POLLOUT, s_transferTimeoutMs)))
+			{
+				continue;
+			}
+			return false;
+		}
+		data += sent;
+		_size -= (size_t)sent;
+	}
+	return true;
+}
+
+bool HttpSocket::SendFromFile
+(
+	HttpBodyPump& _pump
+)
+{
+#if F_SIMPLEHTTP_SENDFILE
+	FILE* file = _pump.File();
+#if F_SIMPLEHTTP_OPENSSL
+	if (m_tls)
+	{
+		// the data has to go through OpenSSL to be encrypted
+		file = NULL;
+	}
+#endif
+	if (file == NULL)
+	{
+		return true;
+	}
+	// from where the stream is, past anything it has buffered
+	off_t offset = ftello(file);
+	if (offset < 0)
+	{
+		return true;
+	}
+	int fd = fileno(file);
+	while (_pump.Remaining() != 0)
+	{
+		uint64 remaining = _pump.Remaining();
+		ssize_t sent = sendfile(m_socket, fd, &offset, (size_t)((remaining < (1u << 30)) ? remaining : (1u << 30)));
+		if (sent > 0)
+		{
+			_pump.SentFromFile((uint64)sent);
+			continue;
+		}
+		if (sent == 0)
+		{
+			// the file is shorter than it was said to be, Next finds out
+			break;
+		}
+		if (errno == EINTR || ((errno == EAGAIN || errno == EWOULDBLOCK) && Wait(POLLOUT, s_transferTimeoutMs)))
+		{
+			continue;
+		}
+		if ((errno == EINVAL || errno == ENOSYS) && _pump.Pumped() == 0)
+		{
+			// not a file sendfile can read from
+			return true;
+		}
+		return false;
+	}
+	return fseeko(file, offset, SEEK_SET) == 0;
+#else
+	return true;
+#endif
+}
+
+int HttpSocket::Fill()
+{
+	if (m_begin == m_end)
+	{
+		m_begin = m_end = 0;
+	}
+	else if (m_end == m_buffer.size())
+	{
+		memmove(&m_buffer[0], &m_buffer[m_begin], m_end - m_begin);
+		m_end -= m_begin;
+		m_begin = 0;
+	}
+	size_t room = m_buffer.size() - m_end;
+	if (room == 0)
+	{
+		// a line or a head longer than the buffer
+		return -1;
+	}
+
+	while (true)
+	{
+#if F_SIMPLEHTTP_OPENSSL
+		if (m_tls)
+		{
+			ERR_clear_error();
+			int received = SSL_read(m_tls, &m_buffer[m_end], (int)room);
+			if (received > 0)
+			{
+				m_end += received;
+				return received;
+			}
+			int error = SSL_get_error(m_tls, received);
+			if (error == SSL_ERROR_ZERO_RETURN || (error == SSL_ERROR_SYSCALL && ERR_peek_error() == 0 && received == 0))
+			{
+				return 0;
+			}
+			if (!WaitTls(received, s_transferTimeoutMs))
+			{
+				return -1;
+			}
+			continue;
+		}
+#endif
+		ssize_t received = recv(m_socket, &m_buffer[m_end], room, 0);
+		if (received > 0)
+		{
+			m_end += (size_t)received;
+			return (int)received;
+		}
+		if (received == 0)
+		{
+			return 0;
+		}
+		if (errno == EINTR || ((errno == EAGAIN || errno == EWOULDBLOCK) && Wait(POLLIN, s_transferTimeoutMs)))
+		{
+			continue;
+		}
+		return -1;
+	}
+}
+
+bool HttpSocket::ReadLine
+(
+	std::string* o_line
+)
+{
+	size_t searched = 0;
+	while (true)
+	{
+		char const* data = Data();
+		for (size_t i = (searched > 0) ? searched - 1 : 0; i + 1 < Available(); ++i)
+		{
+			if (data[i] == '\r' && data[i + 1] == '\n')
+			{
+				o_line->assign(data, i);
+				Consume(i + 2);
+				return true;
+			}
+		}
+		searched = Available();
+		if (Fill() <= 0)
+		{
+			return false;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief _length bytes of body from the socket to the sink
+static bool ReceiveBody
+(
+	HttpSocket& _socket,
+	uint64 _length,
+	HttpResponseSink& _sink
+)
+{
+	while (_length != 0)
+	{
+		if (_socket.Available() == 0 && _socket.Fill() <= 0)
+		{
+			return false;
+		}
+		size_t size = (_socket.Available() < _length) ? _socket.Available() : (size_t)_length;
+		if (!_sink.Write(_socket.Data(), size))
+		{
+			return false;
+		}
+		_socket.Consume(size);
+		_length -= size;
+	}
+	return true;
+}
+
+static bool ReceiveChunkedBody
+(
+	HttpSocket& _socket,
+	HttpResponseSink& _sink
+)
+{
+	std::string line;
+	while (true)
+	{
+		// "<size in hex>[;extensions]"
+		if (!_socket.ReadLine(&line))
+		{
+			return false;
+		}
+		char* end = NULL;
+		unsigned long long size = strtoull(line.c_str(), &end, 16);
+		if (end == line.c_str())
+		{
+			return false;
+		}
+		if (size == 0)
+		{
+			break;
+		}
+		if (!ReceiveBody(_socket, size, _sink) || !_socket.ReadLine(&line) || !line.empty())
+		{
+			return false;
+		}
+	}
+	// trailers, up to the empty line
+	do
+	{
+		if (!_socket.ReadLine(&line))
+		{
+			return false;
+		}
+	}
+	while (!line.empty());
+	return true;
+}
+
+static bool ReceiveBodyToClose
+(
+	HttpSocket& _socket,
+	HttpResponseSink& _sink
+)
+{
+	while (true)
+	{
+		if (_socket.Available() != 0)
+		{
+			if (!_sink.Write(_socket.Data(), _socket.Available()))
+			{
+				return false;
+			}
+			_socket.Consume(_socket.Available());
+		}
+		int received = _socket.Fill();
+		if (received <= 0)
+		{
+			return received == 0;
+		}
+	}
+}
+
+enum ExchangeResult
+{
+	ExchangeComplete,
+	ExchangeFailed,
+	/// Failed before a byte of the response arrived, which on a reused
+	/// connection means the server had closed it
+	ExchangeNothingBack,
+};
+
+struct HttpResponseHead
+{
+	HttpResponseHead() : m_status(0), m_keepAlive(false), m_chunked(false), m_contentLength(HttpResponseSink::UnknownLength) {}
+
+	unsigned m_status;
+	bool m_keepAlive;
+	bool m_chunked;
+	uint64 m_contentLength;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Read the status line and headers, the raw text of them (ending
+///        with the empty line, as WinHTTP gives them) to o_header
+static ExchangeResult ReceiveHead
+(
+	HttpSocket& _socket,
+	HttpResponseHead* o_head,
+	std::wstring* o_header
+)
+{
+	std::string line;
+	bool first = true;
+	while (true)
+	{
+		// the status line, then interim responses are skipped over
+		if (!_socket.ReadLine(&line))
+		{
+			return first ? ExchangeNothingBack : ExchangeFailed;
+		}
+		first = false;
+		unsigned major = 0, minor = 0, status = 0;
+		if (sscanf(line.c_str(), "HTTP/%u.%u %u", &major, &minor, &status) != 3)
+		{
+			return ExchangeFailed;
+		}
+		std::string raw = line + "\r\n";
+		*o_head = HttpResponseHead();
+		o_head->m_status = status;
+		o_head->m_keepAlive = (major == 1 && minor >= 1);
+
+		while (true)
+		{
+			if (!_socket.ReadLine(&line))
+			{
+				return ExchangeFailed;
+			}
+			raw += line;
+			raw += "\r\n";
+			if (line.empty())
+			{
+				break;
+			}
+			size_t colon = line.find(':');
+			if (colon == std::string::npos)
+			{
+				continue;
+			}
+			size_t start = line.find_first_not_of(" \t", colon + 1);
+			std::string value = (start == std::string::npos) ? std::string() : line.substr(start);
+			if (StartsWithNoCase(line.c_str(), colon, "Content-Length") && colon == 14)
+			{
+				char* end = NULL;
+				unsigned long long length = strtoull(value.c_str(), &end, 10);
+				if (end != value.c_str())
+				{
+					o_head->m_contentLength = length;
+				}
+			}
+			else if (StartsWithNoCase(line.c_str(), colon, "Transfer-Encoding") && colon == 17)
+			{
+				o_head->m_chunked = HasToken(value, "chunked");
+			}
+			else if (StartsWithNoCase(line.c_str(), colon, "Connection") && colon == 10)
+			{
+				if (HasToken(value, "close"))
+				{
+					o_head->m_keepAlive = false;
+				}
+				else if (HasToken(value, "keep-alive"))
+				{
+					o_head->m_keepAlive = true;
+				}
+			}
+		}
+
+		if (status < 100 || status >= 200 || status == 101)
+		{
+			// latin-1 to wide, the header is meant to be ASCII
+			o_header->resize(raw.size());
+			for (size_t i = 0; i < raw.size(); ++i)
+			{
+				(*o_header)[i] = (wchar_t)(unsigned char)raw[i];
+			}
+			return ExchangeComplete;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief One request and its response over a connected socket
+static ExchangeResult Exchange
+(
+	HttpSocket& _socket,
+	std::string const& _head,
+	bool _headOnly,
+	void const* _body,
+	DWORD _bodySize,
+	HttpBodyPump* _pump,
+	HttpResponseSink& _sink,
+	std::wstring* o_header,
+	bool* o_keepAlive
+)
+{
+	*o_keepAlive = false;
+
+	bool sent;
+	if (_pump)
+	{
+		sent = _socket.Send(_head.data(), _head.size()) && _socket.SendFromFile(*_pump);
+		while (sent)
+		{
+			void const* data;
+			size_t size;
+			if (!_pump->Next(&data, &size))
+			{
+				// the body couldn't be read, not a connection problem
+				return ExchangeFailed;
+			}
+			if (size == 0)
+			{
+				break;
+			}
+			sent = _socket.Send(data, size);
+			if (sent)
+			{
+				_pump->Sent();
+			}
+		}
+	}
+	else if (_bodySize <= s_coalesceSize)
+	{
+		std::string request = _head;
+		request.append((char const*)_body, _bodySize);
+		sent = _socket.Send(request.data(), request.size());
+	}
+	else
+	{
+		sent = _socket.Send(_head.data(), _head.size()) && _socket.Send(_body, _bodySize);
+	}
+	if (!sent)
+	{
+		// as good as nothing back, the server may have gone before it read
+		// any of it
+		return ExchangeNothingBack;
+	}
+
+	HttpResponseHead head;
+	ExchangeResult result = ReceiveHead(_socket, &head, o_header);
+	if (result != ExchangeComplete)
+	{
+		return result;
+	}
+
+	bool noBody = _headOnly || head.m_status == 204 || head.m_status == 304;
+	if (!_sink.Begin(noBody ? 0 : (head.m_chunked ? HttpResponseSink::UnknownLength : head.m_contentLength)))
+	{
+		return ExchangeFailed;
+	}
+	bool complete;
+	if (noBody)
+	{
+		complete = true;
+	}
+	else if (head.m_chunked)
+	{
+		complete = ReceiveChunkedBody(_socket, _sink);
+	}
+	else if (head.m_contentLength != HttpResponseSink::UnknownLength)
+	{
+		complete = ReceiveBody(_socket, head.m_contentLength, _sink);
+	}
+	else
+	{
+		// the body is everything until the server closes the connection
+		complete = ReceiveBodyToClose(_socket, _sink);
+		head.m_keepAlive = false;
+	}
+	_sink.End(complete);
+
+	*o_keepAlive = complete && head.m_keepAlive;
+	return complete ? ExchangeComplete : ExchangeFailed;
+}
+
+HttpConnectionPool::Handle HttpConnectionPool::OpenLocked
+(
+	const std::wstring& _host,
+	INTERNET_PORT _port,
+	bool _secure
+)
+{
+	// connected by Connect, outside the pool's lock
+	return new HttpSocket(_host, _port, _secure);
+}
+
+bool HttpConnectionPool::Connect
+(
+	Handle _connect
+)
+{
+	return _connect->Connect();
+}
+
+bool HttpConnectionPool::Reusable
+(
+	Handle _connect
+)
+{
+	return _connect->Reusable();
+}
+
+void HttpConnectionPool::Close
+(
+	Handle _connect
+)
+{
+	delete _connect;
+}
+
+bool SimpleHttpRequest::Send
+(
+	const std::wstring& url,
+	const std::wstring& method,
+	const std::wstring& path,
+	void* body,
+	DWORD bodySize,
+	HttpBodyPump* pump,
+	HttpResponseSink& sink
+)
+{
+	m_responseHeader.resize(0);
+
+	INTERNET_PORT defaultPort = m_secure ? 443 : 80;
+	INTERNET_PORT port = m_port ? m_port : defaultPort;
+
+	std::string host = Narrow(url);
+	if (host.find(':') != std::string::npos)
+	{
+		host = "[" + host + "]";
+	}
+	if (port != defaultPort)
+	{
+		char portText[8];
+		snprintf(portText, sizeof(portText), ":%u", (unsigned)port);
+		host += portText;
+	}
+	std::wstring const& userAgent = m_pool ? m_pool->UserAgent() : m_userAgent;
+
+	std::string head = Narrow(method) + " " + (path.empty() ? std::string("/") : Narrow(path)) + " HTTP/1.1\r\n";
+	head += "Host: " + host + "\r\n";
+	if (!userAgent.empty())
+	{
+		head += "User-Agent: " + Narrow(userAgent) + "\r\n";
+	}
+	if (pump)
+	{
+		head += pump->Headers();
+	}
+	else if (bodySize != 0 || (method != L"GET" && method != L"HEAD"))
+	{
+		char length[48];
+		snprintf(length, sizeof(length), "Content-Length: %u\r\n", (unsigned)bodySize);
+		head += length;
+	}
+	if (!m_pool)
+	{
+		head += "Connection: close\r\n";
+	}
+	head += "\r\n";
+	bool headOnly = (method == L"HEAD");
+
+	for (unsigned attempt = 0; ; ++attempt)
+	{
+		HttpSocket* socket;
+		std::unique_ptr<HttpSocket> owned;
+		if (m_pool)
+		{
+			socket = m_pool->Acquire( url, port, m_secure );
+		}
+		else
+		{
+			owned.reset(new HttpSocket(url, port, m_secure));
+			socket = owned->Connect() ? owned.get() : NULL;
+		}
+		if (!socket)
+		{
+			return false;
+		}
+
+		bool reused = socket->m_used;
+		socket->m_used = true;
+		bool keepAlive = false;
+		ExchangeResult result = Exchange(*socket, head, headOnly, body, bodySize, pump, sink, &m_responseHeader, &keepAlive);
+		if (m_pool)
+		{
+			m_pool->Release( socket, keepAlive );
+		}
+
+		// A kept-alive connection can be closed by the server just as we
+		// take it from the pool; that is worth one more go on a new one
+		if (result == ExchangeNothingBack && reused && attempt == 0 && (!pump || pump->Rewind()))
+		{
+			continue;
+		}
+		return result == ExchangeComplete;
+	}
+}
+
+#endif
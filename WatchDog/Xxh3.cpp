@@ -0,0 +1,652 @@
+/*----------------------------------------------------------------------------
+ *  FILE: Xxh3.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		Inputs up to 240 bytes have their own mixing functions. Longer ones
+ *		go through eight 64 bit accumulators, 64 byte stripe at a time, with
+ *		a scramble every 16 stripes and a final stripe ending exactly at the
+ *		end of the input; the accumulate loop is the only hot part and has
+ *		SSE2 and AVX2 versions.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "Xxh3.h"
+#include "Sha1Kernels.h"
+#include <stdio.h>
+#include <string.h>
+
+#if F_SHA1_X86
+#include <immintrin.h>
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define F_XXH3_SSE2 (1)
+#endif
+#endif
+#ifndef F_XXH3_SSE2
+#define F_XXH3_SSE2 (0)
+#endif
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+typedef unsigned char uint8;
+typedef fUInt32 uint32;
+
+static const uint32 Prime32_1 = 0x9E3779B1U;
+static const uint32 Prime32_2 = 0x85EBCA77U;
+static const uint32 Prime32_3 = 0xC2B2AE3DU;
+static const uint64 Prime64_1 = 0x9E3779B185EBCA87ULL;
+static const uint64 Prime64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64 Prime64_3 = 0x165667B19E3779F9ULL;
+static const uint64 Prime64_4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64 Prime64_5 = 0x27D4EB2F165667C5ULL;
+static const uint64 PrimeMx1 = 0x165667919E3779F9ULL;
+static const uint64 PrimeMx2 = 0x9FB21C651E98DF25ULL;
+
+static const size_t StripeSize = 64;
+static const size_t SecretSize = 192;
+static const size_t StripesPerBlock = (SecretSize - StripeSize) / 8;
+
+// xxHash's default secret
+static const uint8 Secret[SecretSize] =
+{
+	0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+	0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+	0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+	0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+	0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+	0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+	0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+	0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+	0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+	0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+	0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+	0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+// Little endian loads; every platform WatchDog builds for is little endian
+static inline uint32 Read32(uint8 const* _p)
+{
+	uint32 value;
+	memcpy(&value, _p, sizeof(value));
+	return value;
+}
+
+static inline uint64 Read64(uint8 const* _p)
+{
+	uint64 value;
+	memcpy(&value, _p, sizeof(value));
+	return value;
+}
+
+static inline uint32 Swap32(uint32 _x)
+{
+	return (_x << 24) | ((_x << 8) & 0x00FF0000U) | ((_x >> 8) & 0x0000FF00U) | (_x >> 24);
+}
+
+static inline uint64 Swap64(uint64 _x)
+{
+	return ((uint64)Swap32((uint32)_x) << 32) | Swap32((uint32)(_x >> 32));
+}
+
+static inline uint32 Rotl32(uint32 _x, unsigned _r)
+{
+	return (_x << _r) | (_x >> (32 - _r));
+}
+
+static inline uint64 Rotl64(uint64 _x, unsigned _r)
+{
+	return (_x << _r) | (_x >> (64 - _r));
+}
+
+static inline uint64 Multiply128(uint64 _a, uint64 _b, uint64* o_high)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	return _umul128(_a, _b, o_high);
+#elif defined(__SIZEOF_INT128__)
+	unsigned __int128 product = (unsigned __int128)_a * _b;
+	*o_high = (uint64)(product >> 64);
+	return (uint64)product;
+#else
+	uint64 loLo = (_a & 0xFFFFFFFFULL) * (_b & 0xFFFFFFFFULL);
+	uint64 hiLo = (_a >> 32) * (_b & 0xFFFFFFFFULL);
+	uint64 loHi = (_a & 0xFFFFFFFFULL) * (_b >> 32);
+	uint64 hiHi = (_a >> 32) * (_b >> 32);
+	uint64 cross = (loLo >> 32) + (hiLo & 0xFFFFFFFFULL) + loHi;
+	*o_high = (hiLo >> 32) + (cross >> 32) + hiHi;
+	return (cross << 32) | (loLo & 0xFFFFFFFFULL);
+#endif
+}
+
+static inline uint64 MultiplyFold64(uint64 _a, uint64 _b)
+{
+	uint64 high;
+	uint64 low = Multiply128(_a, _b, &high);
+	return low ^ high;
+}
+
+static inline uint64 Xxh64Avalanche(uint64 _h)
+{
+	_h ^= _h >> 33;
+	_h *= Prime64_2;
+	_h ^= _h >> 29;
+	_h *= Prime64_3;
+	_h ^= _h >> 32;
+	return _h;
+}
+
+static inline uint64 Avalanche(uint64 _h)
+{
+	_h ^= _h >> 37;
+	_h *= PrimeMx1;
+	_h ^= _h >> 32;
+	return _h;
+}
+
+static inline uint64 Rrmxmx(uint64 _h, uint64 _len)
+{
+	_h ^= Rotl64(_h, 49) ^ Rotl64(_h, 24);
+	_h *= PrimeMx2;
+	_h ^= (_h >> 35) + _len;
+	_h *= PrimeMx2;
+	_h ^= _h >> 28;
+	return _h;
+}
+
+static inline uint64 Mix16(uint8 const* _input, uint8 const* _secret)
+{
+	return MultiplyFold64(Read64(_input) ^ Read64(_secret), Read64(_input + 8) ^ Read64(_secret + 8));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 0 to 240 bytes
+
+static uint64 Hash64Short(uint8 const* _input, size_t _len)
+{
+	if (_len == 0)
+	{
+		return Xxh64Avalanche(Read64(Secret + 56) ^ Read64(Secret + 64));
+	}
+	if (_len <= 3)
+	{
+		uint32 combined = ((uint32)_input[0] << 16) | ((uint32)_input[_len >> 1] << 24) | (uint32)_input[_len - 1] | ((uint32)_len << 8);
+		uint64 bitflip = Read32(Secret) ^ Read32(Secret + 4);
+		return Xxh64Avalanche((uint64)combined ^ bitflip);
+	}
+	if (_len <= 8)
+	{
+		uint64 input = Read32(_input + _len - 4) + ((uint64)Read32(_input) << 32);
+		uint64 bitflip = Read64(Secret + 8) ^ Read64(Secret + 16);
+		return Rrmxmx(input ^ bitflip, _len);
+	}
+	if (_len <= 16)
+	{
+		uint64 low = Read64(_input) ^ (Read64(Secret + 24) ^ Read64(Secret + 32));
+		uint64 high = Read64(_input + _len - 8) ^ (Read64(Secret + 40) ^ Read64(Secret + 48));
+		return Avalanche(_len + Swap64(low) + high + MultiplyFold64(low, high));
+	}
+	uint64 acc = _len * Prime64_1;
+	if (_len <= 128)
+	{
+		if (_len > 32)
+		{
+			if (_len > 64)
+			{
+				if (_len > 96)
+				{
+					acc += Mix16(_input + 48, Secret + 96);
+					acc += Mix16(_input + _len - 64, Secret + 112);
+				}
+				acc += Mix16(_input + 32, Secret + 64);
+				acc += Mix16(_input + _len - 48, Secret + 80);
+			}
+			acc += Mix16(_input + 16, Secret + 32);
+			acc += Mix16(_input + _len - 32, Secret + 48);
+		}
+		acc += Mix16(_input, Secret);
+		acc += Mix16(_input + _len - 16, Secret + 16);
+		return Avalanche(acc);
+	}
+
+	size_t rounds = _len / 16;
+	for (size_t i = 0; i < 8; ++i)
+	{
+		acc += Mix16(_input + 16 * i, Secret + 16 * i);
+	}
+	acc = Avalanche(acc);
+	for (size_t i = 8; i < rounds; ++i)
+	{
+		acc += Mix16(_input + 16 * i, Secret + 16 * (i - 8) + 3);
+	}
+	acc += Mix16(_input + _len - 16, Secret + 136 - 17);
+	return Avalanche(acc);
+}
+
+static void Mix32(uint64* io_low, uint64* io_high, uint8 const* _input1, uint8 const* _input2, uint8 const* _secret)
+{
+	*io_low += Mix16(_input1, _secret);
+	*io_low ^= Read64(_input2) + Read64(_input2 + 8);
+	*io_high += Mix16(_input2, _secret + 16);
+	*io_high ^= Read64(_input1) + Read64(_input1 + 8);
+}
+
+static Xxh3Digest128 Hash128Short(uint8 const* _input, size_t _len)
+{
+	Xxh3Digest128 h;
+	if (_len == 0)
+	{
+		h.m_low = Xxh64Avalanche(Read64(Secret + 64) ^ Read64(Secret + 72));
+		h.m_high = Xxh64Avalanche(Read64(Secret + 80) ^ Read64(Secret + 88));
+		return h;
+	}
+	if (_len <= 3)
+	{
+		uint32 combinedLow = ((uint32)_input[0] << 16) | ((uint32)_input[_len >> 1] << 24) | (uint32)_input[_len - 1] | ((uint32)_len << 8);
+		uint32 combinedHigh = Rotl32(Swap32(combinedLow), 13);
+		uint64 bitflipLow = Read32(Secret) ^ Read32(Secret + 4);
+		uint64 bitflipHigh = Read32(Secret + 8) ^ Read32(Secret + 12);
+		h.m_low = Xxh64Avalanche((uint64)combinedLow ^ bitflipLow);
+		h.m_high = Xxh64Avalanche((uint64)combinedHigh ^ bitflipHigh);
+		return h;
+	}
+	if (_len <= 8)
+	{
+		uint64 input = Read32(_input) + ((uint64)Read32(_input + _len - 4) << 32);
+		uint64 keyed = input ^ (Read64(Secret + 16) ^ Read64(Secret + 24));
+		uint64 high;
+		uint64 low = Multiply128(keyed, Prime64_1 + (_len << 2), &high);
+		high += low << 1;
+		low ^= high >> 3;
+		low ^= low >> 35;
+		low *= PrimeMx2;
+		low ^= low >> 28;
+		h.m_low = low;
+		h.m_high = Avalanche(high);
+		return h;
+	}
+	if (_len <= 16)
+	{
+		uint64 bitflipLow = Read64(Secret + 32) ^ Read64(Secret + 40);
+		uint64 bitflipHigh = Read64(Secret + 48) ^ Read64(Secret + 56);
+		uint64 inputLow = Read64(_input);
+		uint64 inputHigh = Read64(_input + _len - 8);
+		uint64 high;
+		uint64 low = Multiply128(inputLow ^ inputHigh ^ bitflipLow, Prime64_1, &high);
+		low += (uint64)(_len - 1) << 54;
+		inputHigh ^= bitflipHigh;
+		high += inputHigh + (uint64)(uint32)inputHigh * (Prime32_2 - 1);
+		low ^= Swap64(high);
+		uint64 finalHigh;
+		uint64 finalLow = Multiply128(low, Prime64_2, &finalHigh);
+		finalHigh += high * Prime64_2;
+		h.m_low = Avalanche(finalLow);
+		h.m_high = Avalanche(finalHigh);
+		return h;
+	}
+
+	uint64 accLow = _len * Prime64_1;
+	uint64 accHigh = 0;
+	if (_len <= 128)
+	{
+		if (_len > 32)
+		{
+			if (_len > 64)
+			{
+				if (_len > 96)
+				{
+					Mix32(&accLow, &accHigh, _input + 48, _input + _len - 64, Secret + 96);
+				}
+				Mix32(&accLow, &accHigh, _input + 32, _input + _len - 48, Secret + 64);
+			}
+			Mix32(&accLow, &accHigh, _input + 16, _input + _len - 32, Secret + 32);
+		}
+		Mix32(&accLow, &accHigh, _input, _input + _len - 16, Secret);
+	}
+	else
+	{
+		size_t rounds = _len / 32;
+		for (size_t i = 0; i < 4; ++i)
+		{
+			Mix32(&accLow, &accHigh, _input + 32 * i, _input + 32 * i + 16, Secret + 32 * i);
+		}
+		accLow = Avalanche(accLow);
+		accHigh = Avalanche(accHigh);
+		for (size_t i = 4; i < rounds; ++i)
+		{
+			Mix32(&accLow, &accHigh, _input + 32 * i, _input + 32 * i + 16, Secret + 32 * (i - 4) + 3);
+		}
+		Mix32(&accLow, &accHigh, _input + _len - 16, _input + _len - 32, Secret + 136 - 17 - 16);
+	}
+	h.m_low = Avalanche(accLow + accHigh);
+	h.m_high = 0 - Avalanche(accLow * Prime64_1 + accHigh * Prime64_4 + _len * Prime64_2);
+	return h;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Accumulate loops. _stripes stripes of _data, the secret advancing 8 bytes
+// per stripe; all versions produce identical accumulators.
+
+typedef void (*Xxh3Accumulate)(uint64* io_acc, uint8 const* _data, uint8 const* _secret, size_t _stripes);
+typedef void (*Xxh3Scramble)(uint64* io_acc, uint8 const* _secret);
+
+#if !F_XXH3_SSE2
+
+static void AccumulateScalar(uint64* io_acc, uint8 const* _data, uint8 const* _secret, size_t _stripes)
+{
+	for (size_t s = 0; s < _stripes; ++s, _data += StripeSize, _secret += 8)
+	{
+		for (unsigned i = 0; i < 8; ++i)
+		{
+			uint64 value = Read64(_data + 8 * i);
+			uint64 key = value ^ Read64(_secret + 8 * i);
+			io_acc[i ^ 1] += value;
+			io_acc[i] += (uint64)(uint32)key * (key >> 32);
+		}
+	}
+}
+
+static void ScrambleScalar(uint64* io_acc, uint8 const* _secret)
+{
+	for (unsigned i = 0; i < 8; ++i)
+	{
+		uint64 acc = io_acc[i];
+		acc ^= acc >> 47;
+		acc ^= Read64(_secret + 8 * i);
+		io_acc[i] = acc * Prime32_1;
+	}
+}
+
+#else
+
+static void AccumulateSSE2(uint64* io_acc, uint8 const* _data, uint8 const* _secret, size_t _stripes)
+{
+	__m128i acc[4];
+	for (unsigned i = 0; i < 4; ++i)
+	{
+		acc[i] = _mm_loadu_si128((__m128i const*)io_acc + i);
+	}
+	for (size_t s = 0; s < _stripes; ++s, _data += StripeSize, _secret += 8)
+	{
+		for (unsigned i = 0; i < 4; ++i)
+		{
+			__m128i value = _mm_loadu_si128((__m128i const*)_data + i);
+			__m128i key = _mm_xor_si128(value, _mm_loadu_si128((__m128i const*)_secret + i));
+			__m128i product = _mm_mul_epu32(key, _mm_srli_epi64(key, 32));
+			__m128i swapped = _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+			acc[i] = _mm_add_epi64(acc[i], _mm_add_epi64(product, swapped));
+		}
+	}
+	for (unsigned i = 0; i < 4; ++i)
+	{
+		_mm_storeu_si128((__m128i*)io_acc + i, acc[i]);
+	}
+}
+
+static void ScrambleSSE2(uint64* io_acc, uint8 const* _secret)
+{
+	__m128i const prime = _mm_set1_epi32((int)Prime32_1);
+	for (unsigned i = 0; i < 4; ++i)
+	{
+		__m128i acc = _mm_loadu_si128((__m128i const*)io_acc + i);
+		acc = _mm_xor_si128(acc, _mm_srli_epi64(acc, 47));
+		acc = _mm_xor_si128(acc, _mm_loadu_si128((__m128i const*)_secret + i));
+		__m128i low = _mm_mul_epu32(acc, prime);
+		__m128i high = _mm_mul_epu32(_mm_srli_epi64(acc, 32), prime);
+		_mm_storeu_si128((__m128i*)io_acc + i, _mm_add_epi64(low, _mm_slli_epi64(high, 32)));
+	}
+}
+
+F_SHA1_TARGET("avx2")
+static void AccumulateAVX2(uint64* io_acc, uint8 const* _data, uint8 const* _secret, size_t _stripes)
+{
+	__m256i acc0 = _mm256_loadu_si256((__m256i const*)io_acc);
+	__m256i acc1 = _mm256_loadu_si256((__m256i const*)io_acc + 1);
+	for (size_t s = 0; s < _stripes; ++s, _data += StripeSize, _secret += 8)
+	{
+		__m256i value0 = _mm256_loadu_si256((__m256i const*)_data);
+		__m256i value1 = _mm256_loadu_si256((__m256i const*)_data + 1);
+		__m256i key0 = _mm256_xor_si256(value0, _mm256_loadu_si256((__m256i const*)_secret));
+		__m256i key1 = _mm256_xor_si256(value1, _mm256_loadu_si256((__m256i const*)_secret + 1));
+		__m256i product0 = _mm256_mul_epu32(key0, _mm256_srli_epi64(key0, 32));
+		__m256i product1 = _mm256_mul_epu32(key1, _mm256_srli_epi64(key1, 32));
+		acc0 = _mm256_add_epi64(acc0, _mm256_add_epi64(product0, _mm256_shuffle_epi32(value0, _MM_SHUFFLE(1, 0, 3, 2))));
+		acc1 = _mm256_add_epi64(acc1, _mm256_add_epi64(product1, _mm256_shuffle_epi32(value1, _MM_SHUFFLE(1, 0, 3, 2))));
+	}
+	_mm256_storeu_si256((__m256i*)io_acc, acc0);
+	_mm256_storeu_si256((__m256i*)io_acc + 1, acc1);
+}
+
+#endif
+
+struct Xxh3Kernel
+{
+	Xxh3Accumulate m_accumulate;
+	Xxh3Scramble m_scramble;
+	char const* m_name;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Pick the fastest accumulate loop the CPU supports. Scrambling is
+///        once per 1KB, SSE2 is plenty for it.
+static Xxh3Kernel SelectKernel()
+{
+	Xxh3Kernel kernel;
+#if F_XXH3_SSE2
+	kernel.m_scramble = &ScrambleSSE2;
+	if (fSHA1_CpuHasAVX2())
+	{
+		kernel.m_accumulate = &AccumulateAVX2;
+		kernel.m_name = "avx2";
+		return kernel;
+	}
+	kernel.m_accumulate = &AccumulateSSE2;
+	kernel.m_name = "sse2";
+	return kernel;
+#else
+	kernel.m_accumulate = &AccumulateScalar;
+	kernel.m_scramble = &ScrambleScalar;
+	kernel.m_name = "scalar";
+	return kernel;
+#endif
+}
+
+static Xxh3Kernel const& GetKernel()
+{
+	// Selected once, on first use
+	static Xxh3Kernel const s_kernel = SelectKernel();
+	return s_kernel;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Run whole stripes through the accumulators, scrambling at the end
+///        of each block
+static void ConsumeStripes(uint64* io_acc, fUInt32* io_stripesInBlock, uint8 const* _data, size_t _stripes)
+{
+	Xxh3Kernel const& kernel = GetKernel();
+	while (_stripes != 0)
+	{
+		size_t count = StripesPerBlock - *io_stripesInBlock;
+		if (count > _stripes)
+		{
+			count = _stripes;
+		}
+		kernel.m_accumulate(io_acc, _data, Secret + *io_stripesInBlock * 8, count);
+		*io_stripesInBlock += (fUInt32)count;
+		_data += count * StripeSize;
+		_stripes -= count;
+		if (*io_stripesInBlock == StripesPerBlock)
+		{
+			kernel.m_scramble(io_acc, Secret + SecretSize - StripeSize);
+			*io_stripesInBlock = 0;
+		}
+	}
+}
+
+static uint64 MergeAccumulators(uint64 const* _acc, uint8 const* _secret, uint64 _start)
+{
+	uint64 result = _start;
+	for (unsigned i = 0; i < 4; ++i)
+	{
+		result += MultiplyFold64(_acc[2 * i] ^ Read64(_secret + 16 * i), _acc[2 * i + 1] ^ Read64(_secret + 16 * i + 8));
+	}
+	return Avalanche(result);
+}
+
+void fXXH3::StreamStart()
+{
+	m_acc[0] = Prime32_3;
+	m_acc[1] = Prime64_1;
+	m_acc[2] = Prime64_2;
+	m_acc[3] = Prime64_3;
+	m_acc[4] = Prime64_4;
+	m_acc[5] = Prime32_2;
+	m_acc[6] = Prime64_5;
+	m_acc[7] = Prime32_1;
+	m_bufferSize = 0;
+	m_stripesInBlock = 0;
+	m_totalSize = 0;
+	m_hash64 = 0;
+	m_hash128 = Xxh3Digest128();
+}
+
+void fXXH3::Update(void const* _data, fSizeType _size)
+{
+	uint8 const* input = (uint8 const*)_data;
+	m_totalSize += _size;
+
+	if (m_bufferSize + _size <= sizeof(m_buffer))
+	{
+		memcpy(m_buffer + m_bufferSize, input, _size);
+		m_bufferSize += (fUInt32)_size;
+		return;
+	}
+
+	// There's more input than fits, so everything buffered has input after it
+	if (m_bufferSize != 0)
+	{
+		size_t fill = sizeof(m_buffer) - m_bufferSize;
+		memcpy(m_buffer + m_bufferSize, input, fill);
+		input += fill;
+		_size -= fill;
+		ConsumeStripes(m_acc, &m_stripesInBlock, m_buffer, sizeof(m_buffer) / StripeSize);
+		memcpy(m_lastStripe, m_buffer + sizeof(m_buffer) - StripeSize, StripeSize);
+		m_bufferSize = 0;
+	}
+
+	// Straight from the input, keeping back at least one byte
+	if (_size > sizeof(m_buffer))
+	{
+		size_t stripes = (_size - 1) / StripeSize;
+		ConsumeStripes(m_acc, &m_stripesInBlock, input, stripes);
+		input += stripes * StripeSize;
+		_size -= stripes * StripeSize;
+		memcpy(m_lastStripe, input - StripeSize, StripeSize);
+	}
+
+	memcpy(m_buffer, input, _size);
+	m_bufferSize = (fUInt32)_size;
+}
+
+void fXXH3::Finish()
+{
+	if (m_totalSize <= 240)
+	{
+		m_hash64 = Hash64Short(m_buffer, m_bufferSize);
+		m_hash128 = Hash128Short(m_buffer, m_bufferSize);
+		return;
+	}
+
+	uint64 acc[8];
+	memcpy(acc, m_acc, sizeof(acc));
+	fUInt32 stripesInBlock = m_stripesInBlock;
+
+	// Every whole stripe but the one holding the last byte, then the last
+	// 64 bytes of the input, which may reach back into data already consumed
+	size_t stripes = (m_bufferSize - 1) / StripeSize;
+	ConsumeStripes(acc, &stripesInBlock, m_buffer, stripes);
+
+	uint8 lastStripe[StripeSize];
+	if (m_bufferSize >= StripeSize)
+	{
+		memcpy(lastStripe, m_buffer + m_bufferSize - StripeSize, StripeSize);
+	}
+	else
+	{
+		size_t earlier = StripeSize - m_bufferSize;
+		memcpy(lastStripe, m_lastStripe + StripeSize - earlier, earlier);
+		memcpy(lastStripe + earlier, m_buffer, m_bufferSize);
+	}
+	GetKernel().m_accumulate(acc, lastStripe, Secret + SecretSize - StripeSize - 7, 1);
+
+	m_hash64 = MergeAccumulators(acc, Secret + 11, m_totalSize * Prime64_1);
+	m_hash128.m_low = m_hash64;
+	m_hash128.m_high = MergeAccumulators(acc, Secret + SecretSize - sizeof(acc) - 11, ~(m_totalSize * Prime64_2));
+}
+
+fXXH3 fXXH3::ComputeHash(void const* _data, fSizeType _size)
+{
+	fXXH3 xxh3;
+	if (_size <= 240)
+	{
+		// No need to go through the buffer
+		xxh3.m_totalSize = _size;
+		xxh3.m_hash64 = Hash64Short((uint8 const*)_data, _size);
+		xxh3.m_hash128 = Hash128Short((uint8 const*)_data, _size);
+		return xxh3;
+	}
+	xxh3.Update(_data, _size);
+	xxh3.Finish();
+	return xxh3;
+}
+
+char const *fXXH3::KernelName()
+{
+	return GetKernel().m_name;
+}
+
+std::string Xxh3Digest128::ToString() const
+{
+	char text[HexLength + 1];
+	snprintf(text, sizeof(text), "%016llx%016llx", (unsigned long long)m_high, (unsigned long long)m_low);
+	return text;
+}
+
+bool Xxh3Digest128::Parse
+(
+	std::string const& _text,
+	Xxh3Digest128* o_digest
+)
+{
+	if (_text.size() != HexLength)
+	{
+		return false;
+	}
+	uint64 words[2] = { 0, 0 };
+	for (size_t i = 0; i < HexLength; ++i)
+	{
+		char c = _text[i];
+		unsigned nibble;
+		if (c >= '0' && c <= '9')
+		{
+			nibble = (unsigned)(c - '0');
+		}
+		else if (c >= 'a' && c <= 'f')
+		{
+			nibble = (unsigned)(c - 'a' + 10);
+		}
+		else if (c >= 'A' && c <= 'F')
+		{
+			nibble = (unsigned)(c - 'A' + 10);
+		}
+		else
+		{
+			return false;
+		}
+		words[i / 16] = (words[i / 16] << 4) | nibble;
+	}
+	o_digest->m_high = words[0];
+	o_digest->m_low = words[1];
+	return true;
+}
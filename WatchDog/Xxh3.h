@@ -0,0 +1,79 @@
+/*----------------------------------------------------------------------------
+ *  FILE: Xxh3.h
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		XXH3 64 and 128 bit hashes (default secret, seed 0), matching the
+ *		reference xxHash 0.8 output. Many times faster than SHA-1 but not
+ *		cryptographic: good for noticing that a file has changed, no use
+ *		for proving that it hasn't been tampered with.
+ *
+ *		Same streaming shape as fSHA1: StreamStart(), Update() with any sized
+ *		pieces, Finish(). Both widths come out of the one pass.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef _XXH3_H
+#define _XXH3_H
+
+#include "sha1.h"
+#include <string>
+
+struct Xxh3Digest128
+{
+	enum { HexLength = 32 };
+
+	uint64 m_high;
+	uint64 m_low;
+
+	Xxh3Digest128() : m_high(0), m_low(0) {}
+
+	bool operator==(Xxh3Digest128 const& _other) const
+	{
+		return m_high == _other.m_high && m_low == _other.m_low;
+	}
+	bool operator!=(Xxh3Digest128 const& _other) const
+	{
+		return !(*this == _other);
+	}
+
+	/// Canonical form, high word first, as xxhsum prints it
+	std::string ToString() const;
+
+	/// 32 hex digits, either case. Returns false if _text isn't exactly that.
+	static bool Parse(std::string const& _text, Xxh3Digest128* o_digest);
+};
+
+struct fXXH3
+{
+	// Once Finish() has been called
+	uint64 m_hash64;
+	Xxh3Digest128 m_hash128;
+
+	// Input that hasn't been run through the accumulators yet. The last
+	// stripe of the input is treated differently, so nothing is consumed
+	// until more input is known to follow it.
+	uint64 m_acc[8];
+	unsigned char m_buffer[256];
+	fUInt32 m_bufferSize;
+	fUInt32 m_stripesInBlock;
+	unsigned char m_lastStripe[64];		// the 64 bytes consumed most recently
+	uint64 m_totalSize;
+
+	void StreamStart();
+	void Update(void const* _data, fSizeType _size);
+	void Finish();
+
+	static fXXH3 ComputeHash(void const* _data, fSizeType _size);
+
+	// Name of the accumulate loop selected for this CPU ("avx2", "sse2" or "scalar")
+	static char const * KernelName();
+
+	fXXH3()
+	{
+		StreamStart();
+	}
+};
+
+#endif
@@ -9,8 +9,11 @@
 #include <sstream>
 #include <time.h>
 #include "sha1.h"
-#include "simplehttp.h"
+#include "FileHasher.h"
+#include "HashCache.h"
+#include "SimpleHttpAsync.h"
 #include "rc4encrypt.h"
+#include "Base16.h"
 
 #define CREATE_PROCESS_USES_SEPARATE_ARGS (1)
 #define DEBUG_DEBUGGING (_DEBUG && 0)
@@ -407,42 +410,161 @@ void CloseLog()
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief read and hash a file
 /// @param executable - name of the file
-/// @return string - sha1 of file contents
-std::string CalculateFileChecksum
+/// @param _options - how to read the file
+/// @param _cache - digests of earlier runs, updated with this one. May be NULL
+/// @param _verify - hash the file even if the cache has it
+/// @param _deepCheckDays - how long a SHA-1 may be carried over on the strength of the fast digest alone, 0 for never
+/// @param _log - where to report progress
+/// @param o_digest - sha1 of file contents
+/// @return bool - false if the file couldn't be read
+bool CalculateFileChecksum
 (
-    std::string executable
+    std::string executable,
+    FileHashOptions const& _options,
+    HashCache* _cache,
+    bool _verify,
+    unsigned _deepCheckDays,
+    std::ostream& _log,
+    Sha1Digest* o_digest
 )
 {
-    std::string fileChecksum;
-    const int buffsize = 256*1024;
-    uint64 totalsize = 0;
-    char* buffer = new char[buffsize];
-    fSHA1 hasher;
-
-    std::ifstream file ( executable, std::ios::in|std::ios::binary);
-    if ( file.is_open() )
+    FileHashResult result;
+    FileHashOptions options = _options;
+    uint64 now = (uint64)time( NULL );
+
+    FileIdentity identity;
+    bool haveIdentity = ( _cache != NULL ) && FileIdentity::Get( executable, &identity );
+    if ( haveIdentity && !_verify && _cache->Lookup( executable, identity, &result.m_digest ) )
+    {
+        _log << "Using cached hash, " << executable << " is unchanged since it was last hashed\n";
+        *o_digest = result.m_digest.Digest();
+        return true;
+    }
+
+    // the file has been touched, but if the fast digest still matches the contents haven't changed. The SHA-1
+    // is only carried over like this for so long, then it is recalculated anyway
+    Xxh3Digest128 cachedFast;
+    fSHA1 cachedDigest;
+    uint64 sha1Time = 0;
+    bool needSha1 = true;
+    if ( haveIdentity && !_verify && _cache->LookupContent( executable, &cachedFast, &cachedDigest, &sha1Time )
+        && now - sha1Time < (uint64)_deepCheckDays * 24 * 60 * 60 )
     {
-        hasher.StreamStart();
-        while(1)
+        options.m_digests = FileHashOptions::FastOnly;
+        if ( HashFile( executable, options, &result ) && result.m_fastDigest.m_hash128 == cachedFast )
+        {
+            _log << "Fast hashed " << result.m_size << " bytes in " << result.m_seconds << "s ("
+                    << result.MegabytesPerSecond() << " MB/s, " << fXXH3::KernelName() << "), contents unchanged, using cached hash\n";
+            result.m_digest = cachedDigest;
+            needSha1 = false;
+        }
+        else
         {
-            file.read ( (char*)buffer, buffsize );
-            int dataread = (int) file.gcount();
-            totalsize += dataread;
+            _log << "Fast hash of " << executable << " differs from the cached one\n";
+        }
+    }
 
-            if ( dataread < buffsize )
-            {
-                hasher.StreamFinal( buffer, dataread, totalsize );
-                break;
-            }
-            hasher.StreamBlock ( buffer, dataread );
+    if ( needSha1 )
+    {
+        sha1Time = now;
+        options.m_digests = FileHashOptions::Sha1AndFast;
+        if ( !HashFile ( executable, options, &result ) )
+        {
+            _log << "Failed to hash " << executable << "\n";
+            return false;
         }
 
-        file.close();
-        fileChecksum.append ( hasher.ToString() );
+        _log << "Hashed " << result.m_size << " bytes in " << result.m_seconds << "s ("
+                << result.MegabytesPerSecond() << " MB/s) using " << FileHashOptions::ModeName(result.m_mode)
+                << " read, " << fSHA1::KernelName() << " kernel\n";
+    }
+    *o_digest = result.m_digest.Digest();
+
+    // only remember the digest if the file didn't change while it was being read
+    FileIdentity after;
+    if ( haveIdentity && FileIdentity::Get( executable, &after ) && after == identity )
+    {
+        _cache->Store( executable, identity, result.m_digest, &result.m_fastDigest.m_hash128, sha1Time );
+        if ( !_cache->Save() )
+        {
+            _log << "Failed to write hash cache " << _cache->Path() << "\n";
+        }
     }
 
-    delete[] buffer;
-    return fileChecksum;
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Executable checksum calculated on a worker thread while the game process
+/// is being set up
+struct ChecksumJob
+{
+    std::string m_executable;
+    FileHashOptions m_options;
+    HashCache* m_cache;
+    bool m_verify;
+    unsigned m_deepCheckDays;
+    bool m_hashed;
+    Sha1Digest m_digest;
+    std::stringstream m_log;    // flog isn't thread safe, copied to it once the job has finished
+
+    /// the digest as reported to the server, empty if the file couldn't be read
+    std::string FileChecksum() const
+    {
+        return m_hashed ? m_digest.ToString() : std::string();
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Thread function calculating a ChecksumJob
+/// @param _parameter Parameter passed to CreateThread - must be ChecksumJob *
+/// @return Thread return code
+DWORD WINAPI ChecksumThread
+(
+    void *_parameter
+)
+{
+    ChecksumJob* job = reinterpret_cast<ChecksumJob *>(_parameter);
+    job->m_hashed = CalculateFileChecksum( job->m_executable, job->m_options, job->m_cache, job->m_verify, job->m_deepCheckDays, job->m_log, &job->m_digest );
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Wait for the checksum thread and compare its result
+/// @param _hThread - the thread running ChecksumThread, closed here. NULL if the job has already run
+/// @param _job - the job it was given
+/// @param _suppliedChecksum - the checksum the executable should have, NULL if none was given
+/// @return bool - true if the checksums match
+bool WaitForChecksum
+(
+    HANDLE _hThread,
+    ChecksumJob& _job,
+    Sha1Digest const* _suppliedChecksum
+)
+{
+    if ( _hThread != NULL )
+    {
+        WaitForSingleObject( _hThread, INFINITE );
+        CloseHandle( _hThread );
+    }
+    *(flog) << _job.m_log.str();
+
+    return _job.m_hashed && _suppliedChecksum != NULL && _job.m_digest == *_suppliedChecksum;
+}
+
+
+// How long a report may take, main waits at most this long for it before exiting
+const unsigned ReportDeadlineMs = 10000;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Client the reports go through. They are sent in the background and
+///        share one session, so only the first pays for the handshake.
+/// @return AsyncHttpClient&
+AsyncHttpClient& ReportClient()
+{
+    static AsyncHttpClient s_client ( L"Forc-Watchdog/1.0" );
+    return s_client;
 }
 
 
@@ -478,7 +600,10 @@ void ReportChecksumFail
     memcpy_s( buff, len, telemetry.str().data(), len );
 
     // we decided not to use the encrypted version, but I'll leave this in as obfuscation
-    RC4Encrypt::Encrypt ( "HX863wRDd9C4265pQM6YZbvk355J8rJC", buff, len ); // if we do send encrypted data, we would need to base16 encode it
+    // keyed once, each report works on a copy
+    static RC4Context const s_telemetryKey ( "HX863wRDd9C4265pQM6YZbvk355J8rJC" );
+    RC4Context rc4 = s_telemetryKey;
+    rc4.Process ( buff, len ); // if we do send encrypted data, we would need to base16 encode it
 
     bool secure = false;
     std::wstring url;
@@ -493,60 +618,14 @@ void ReportChecksumFail
     url = L"api.orerve.net";
 #endif
 
-    // report the error to the webserver 
-    SimpleHttpRequest request(L"Forc-Watchdog/1.0",secure); // true: HTTPS security
-    request.SendRequest( url, L"POST", urlpath.str(), (void*) telemetry.str().data(), len );
+    // report the error to the webserver, in the background; nothing is done
+    // with the response
+    ReportClient().Send( url, secure, L"POST", urlpath.str(), telemetry.str().data(), len, [](HttpResponse&) {}, ReportDeadlineMs );
 
     delete [] buff;
 }
 
 
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Hex-encode a string
-/// @param _input
-/// @param _len
-/// @return std::string
-
-std::string Base16Encode
-( 
-    char const * _input, 
-    unsigned int _len 
-)
-{
-    char const bitsToChar[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
-    std::string encStr;
-    encStr.reserve( _len * 2 );	// For each byte, we write two characters.
-    for(unsigned i = 0; i < _len; i++)
-    {
-        TCHAR currChar = _input[i];
-        encStr.append( 1, bitsToChar[ (currChar & 0xF0) >> 4 ] );	// Most significant 4 bits
-        encStr.append( 1, bitsToChar[  currChar & 0x0F       ] );	// Least significant 4 bits
-    }
-
-    return encStr;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief Encrypt then base-16 encode a buffer
-/// @param _args
-/// @param szName
-/// @return std::string encoded data
-std::string EncryptAndB16
-(
-    void* _args, 
-    unsigned _len,
-    char const * _szKey
-)
-{
-    TCHAR buff[4096];
-    memcpy(buff,_args,_len);
-    RC4Encrypt::Encrypt ( _szKey, (unsigned char *) buff, _len );
-
-    return Base16Encode ( buff, _len );
-}
-
-
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief Write the game's command-line params into shared memory, to hide from hackers
 /// @param _pid - process id, used as part of the shared memory filename
@@ -567,7 +646,15 @@ bool PutArgsInSharedMemory
     TCHAR szName[256];
     sprintf_s ( szName, 256, "Local\\ED-%u-Wd", _pid );
 
-    const DWORD bufSize = 4096;
+    // The hex and its terminator, but never less than the 4096 bytes the
+    // game has always been given
+    const DWORD minBufSize = 4096;
+    if ( _len > ( MAXDWORD - 1 ) / 2 )
+    {
+        *(flog) << "Args too large for shared memory:" << _len;
+        return false;
+    }
+    const DWORD bufSize = ( _len * 2 + 1 > minBufSize ) ? _len * 2 + 1 : minBufSize;
 
     *o_hFile = CreateFileMapping(
         INVALID_HANDLE_VALUE,    // use paging file
@@ -598,9 +685,19 @@ bool PutArgsInSharedMemory
         return false;
     }
 
-    std::string encoded = EncryptAndB16( _args, _len, szName);
+    // encrypted and encoded straight into the view, which is the only buffer
+    char* view = (char*) *o_pMem;
+    if ( !EncryptAndB16InPlace( _args, _len, RC4Context( szName ), view, bufSize - 1 ) )
+    {
+        *(flog) << "Shared memory too small for args:" << bufSize;
 
-    strcpy_s ( (char*) *o_pMem, bufSize, encoded.data() );
+        UnmapViewOfFile(*o_pMem);
+        *o_pMem = NULL;
+        CloseHandle(*o_hFile);
+        *o_hFile = NULL;
+        return false;
+    }
+    view[ (size_t) _len * 2 ] = '\0';
 
     return true;
 }
@@ -628,6 +725,35 @@ void CleanupSharedMemory
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Parse a hashing setting from the command line
+/// @param _key - the option, for the warning
+/// @param _text - its value, a whole number
+/// @param _min, _max - the range it has to be in
+/// @param o_value - left alone if the value is rejected
+/// @param io_warnings - what was rejected and why, logged once the log is open
+/// @return bool - false if _text isn't a number in range
+bool ParseHashSetting
+(
+    std::string const& _key,
+    char const* _text,
+    unsigned _min,
+    unsigned _max,
+    unsigned* o_value,
+    std::ostream& io_warnings
+)
+{
+    char* end = NULL;
+    unsigned long value = strtoul( _text, &end, 10 );
+    if ( end == _text || *end != '\0' || value < _min || value > _max )
+    {
+        io_warnings << "Ignoring " << _key << " " << _text << ", expected " << _min << " to " << _max << "\n";
+        return false;
+    }
+    *o_value = (unsigned) value;
+    return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief Start of WatchDog
 /// @param argc How many args
@@ -648,6 +774,11 @@ int main
 
 	time_t startTime = time(NULL);
     bool bAttachDebugger = false;
+    FileHashOptions hashOptions;
+    bool bVerifyExecutable = false;
+    // XXH3 is no defence against a deliberately altered executable, so the fast hash shortcut is opt in
+    unsigned hashDeepCheckDays = 0;
+    std::stringstream optionWarnings;
 
 
 	for (int i = 0; i < argc; ++i)
@@ -672,6 +803,42 @@ int main
             {
                 suppliedChecksum = argv[i+1];
             }
+            else if ( key == "/HashMode" )
+            {
+                FileHashOptions::ParseMode( argv[i+1], &hashOptions.m_mode );
+            }
+            else if ( key == "/HashQueueDepth" )
+            {
+                ParseHashSetting( key, argv[i+1], 2, 64, &hashOptions.m_queueDepth, optionWarnings );
+            }
+            else if ( key == "/HashBufferSize" )
+            {
+                // in KB, 4KB (the read alignment) to 64MB
+                unsigned kilobytes = 0;
+                if ( ParseHashSetting( key, argv[i+1], 4, 64 * 1024, &kilobytes, optionWarnings ) )
+                {
+                    hashOptions.m_bufferSize = kilobytes * 1024;
+                }
+            }
+            else if ( key == "/VerifyExecutable" )
+            {
+                // hash the whole executable even if the hash cache says it is unchanged. Like /Debug the value is ignored
+                bVerifyExecutable = true;
+            }
+            else if ( key == "/HashDeepCheckDays" )
+            {
+                // how long an unchanged fast hash is trusted instead of recalculating the SHA-1, 0 never
+                hashDeepCheckDays = (unsigned) atoi( argv[i+1] );
+            }
+            else if ( key == "/HashMapWindow" )
+            {
+                // in MB, up to 1GB
+                unsigned megabytes = 0;
+                if ( ParseHashSetting( key, argv[i+1], 1, 1024, &megabytes, optionWarnings ) )
+                {
+                    hashOptions.m_mapWindowSize = megabytes * 1024 * 1024;
+                }
+            }
 #ifdef _DEBUG
             else if ( key == "/Debug" )
             {
@@ -685,6 +852,7 @@ int main
 	}
 
 	OpenLog(executable);
+    *(flog) << optionWarnings.str();
 #ifdef _DEBUG
 	std::stringstream debug;
 	debug << "Executable : " << executable 
@@ -696,18 +864,27 @@ int main
 #endif
 
 
-    // calculate a checksum for the executable file, compare against the supplied checksum
+    // calculate a checksum for the executable file while the game process is set up. It is compared
+    // against the supplied checksum before the process is allowed to run
+    HashCache hashCache( GetLogDirectory(executable) + "watchdog.hashcache" );
+    hashCache.Load();
+
+    ChecksumJob checksumJob;
+    checksumJob.m_executable = executable;
+    checksumJob.m_options = hashOptions;
+    checksumJob.m_cache = &hashCache;
+    checksumJob.m_verify = bVerifyExecutable;
+    checksumJob.m_deepCheckDays = hashDeepCheckDays;
+    checksumJob.m_hashed = false;
+
+    // either case of hex is accepted, anything that isn't a digest can never match
+    Sha1Digest suppliedDigest;
+    Sha1Digest const* pSuppliedDigest = Sha1Digest::Parse( suppliedChecksum, &suppliedDigest ) ? &suppliedDigest : NULL;
+    HANDLE hChecksumThread = CreateThread( NULL, 0, &ChecksumThread, &checksumJob, 0, NULL );
+    if ( hChecksumThread == NULL )
     {
-        std::string fileChecksum = CalculateFileChecksum(executable);
-
-        if ( fileChecksum != suppliedChecksum )
-        {
-#ifndef _DEBUG
-            ReportChecksumFail(suppliedChecksum, fileChecksum, executable);
-            CloseLog();
-            return 0;
-#endif
-        }
+        *(flog) << "Failed to start checksum thread [" << GetLastError() << "]\n";
+        ChecksumThread( &checksumJob );
     }
 
 	//create the heartbeat timer
@@ -796,6 +973,27 @@ int main
         hiddenargs[3] = randomNonce;
         PutArgsInSharedMemory( processInfo.dwProcessId, (void*)hiddenargs, sizeof(hiddenargs), &hMemoryMapFile, &pSharedMemory );
 
+        // the process is still suspended, it only gets to run once the executable is known to be good
+        if ( !WaitForChecksum( hChecksumThread, checksumJob, pSuppliedDigest ) )
+        {
+#ifndef _DEBUG
+            TerminateProcess( processInfo.hProcess, 1 );
+            CleanupSharedMemory( hMemoryMapFile, pSharedMemory );
+            CloseHandle(processInfo.hProcess);
+            CloseHandle(processInfo.hThread);
+            if (hHeartbeatTimer != INVALID_HANDLE_VALUE)
+            {
+                CloseHandle(hHeartbeatTimer);
+            }
+            delete timerSecurityAttributes;
+
+            ReportChecksumFail(suppliedChecksum, checksumJob.FileChecksum(), executable);
+            ReportClient().WaitAll( ReportDeadlineMs );
+            CloseLog();
+            return 0;
+#endif
+        }
+
 #ifdef _DEBUG
         if ( !bAttachDebugger )
 #endif
@@ -902,6 +1100,13 @@ int main
 		}
 		delete timerSecurityAttributes;
 	}
+    else if ( !WaitForChecksum( hChecksumThread, checksumJob, pSuppliedDigest ) )
+    {
+#ifndef _DEBUG
+        ReportChecksumFail(suppliedChecksum, checksumJob.FileChecksum(), executable);
+        ReportClient().WaitAll( ReportDeadlineMs );
+#endif
+    }
 
 	CloseLog();
 	return 0;
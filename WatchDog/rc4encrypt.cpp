@@ -8,6 +8,7 @@
 
 
 #include "Rc4Encrypt.h"
+#include <string.h>
 
 
 void fSwap(unsigned char& _a, unsigned char& _b)
@@ -17,48 +18,331 @@ void fSwap(unsigned char& _a, unsigned char& _b)
     _b = temp;
 }
 
-void RC4Encrypt::InitialisePermutationArray(std::string const & _key, unsigned char* _s)
+RC4Context::RC4Context
+(
+	char const * _key,
+	size_t _keyLen
+)
+{
+	SetKey(_key, _keyLen);
+}
+
+
+RC4Context::RC4Context
+(
+	char const * _key
+)
+{
+	SetKey(_key, strlen(_key));
+}
+
+
+RC4Context::RC4Context
+(
+	std::string const & _key
+)
+{
+	SetKey(_key.data(), _key.size());
+}
+
+
+void RC4Context::SetKey
+(
+	char const * _key,
+	size_t _keyLen
+)
 {
 	for (int i = 0; i < 256; i++)
 	{
-		_s[i] = (unsigned char)i;
+		m_s[i] = (unsigned char)i;
 	}
 
-	size_t len = _key.size();
 	for (size_t i = 0, j = 0; i < 256; i++)
 	{
-		j = (j + _s[i] + _key[i % len]) % 256;
-		fSwap(_s[i],_s[j]);
+		j = (j + m_s[i] + (unsigned char)_key[i % _keyLen]) % 256;
+		fSwap(m_s[i],m_s[j]);
 	}
+
+	m_i = 0;
+	m_j = 0;
 }
 
 
-void RC4Encrypt::Encrypt
+void RC4Context::Process
 (
-	std::string const & _key,
-	unsigned char *io_buff,
-	size_t _plainSz
+	unsigned char * io_buff,
+	size_t _len
 )
 {
-	unsigned char s[256];
-	InitialisePermutationArray(_key, s);
+	Process(io_buff, io_buff, _len);
+}
+
+
+void RC4Context::Process
+(
+	unsigned char const * _input,
+	unsigned char * o_output,
+	size_t _len
+)
+{
+	// unsigned char indices wrap at 256 by themselves; locals keep the
+	// state in registers rather than going back to memory on every byte
+	unsigned char i = m_i;
+	unsigned char j = m_j;
+	for (size_t charIdx = 0; charIdx < _len; charIdx++)
+	{
+		i = (unsigned char)(i + 1u);
+		j = (unsigned char)(j + m_s[i]);
+		fSwap(m_s[i],m_s[j]);
+		unsigned char keystream = m_s[ (unsigned char)(m_s[i] + m_s[j]) ];
+		o_output[charIdx] = (unsigned char)(_input[charIdx] ^ keystream);
+	}
+	m_i = i;
+	m_j = j;
+}
+
+
+// Keystream is made for every lane a block at a time, then XORed in
+static const size_t RC4Block = 64;
+
+////////////////////////////////////////////////////////////////////////////////
+/// One byte of keystream from the S-box at _s
+static inline void RC4Step( unsigned char * _s, size_t & io_i, size_t & io_j, unsigned char & o_keystream )
+{
+	io_i = (io_i + 1) & 255;
+	unsigned char si = _s[io_i];
+	io_j = (io_j + si) & 255;
+	unsigned char sj = _s[io_j];
+	_s[io_i] = sj;
+	_s[io_j] = si;
+	o_keystream = _s[ (unsigned char)(si + sj) ];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Step lanes 0 to N - 1 once each. Written out by recursion so every index
+/// is a constant: the lanes' i and j stay in registers, and the S-boxes,
+/// contexts in one array, are all reached from a single base register.
+template <unsigned N>
+struct RC4StepAll
+{
+	static inline void Do( unsigned char * _sBoxes, size_t _stride, size_t * io_i, size_t * io_j, unsigned char (*o_keystream)[RC4Block], size_t _charIdx )
+	{
+		RC4StepAll<N - 1>::Do(_sBoxes, _stride, io_i, io_j, o_keystream, _charIdx);
+		RC4Step(_sBoxes + (N - 1) * _stride, io_i[N - 1], io_j[N - 1], o_keystream[N - 1][_charIdx]);
+	}
+};
+
+template <>
+struct RC4StepAll<0>
+{
+	static inline void Do( unsigned char * /*_sBoxes*/, size_t /*_stride*/, size_t * /*io_i*/, size_t * /*io_j*/, unsigned char (* /*o_keystream*/)[RC4Block], size_t /*_charIdx*/ )
+	{
+	}
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Steps a fixed number of RC4 streams in lockstep. A lane that finishes
+/// its buffer is given the next one, so long and short buffers mix; once
+/// there aren't enough left to fill every lane the rest are done singly.
+struct RC4Lanes
+{
+	/// Where each buffer's context comes from: the caller's own, or a clone
+	/// of one keyed template
+	struct Source
+	{
+		RC4Context const * m_keyed;
+		RC4Context * m_contexts;
+	};
+
+	/// _steps bytes of every lane
+	template <unsigned Lanes>
+	static void Steps( RC4Context * io_states, unsigned char * const * _data, size_t _steps )
+	{
+		size_t i[Lanes];
+		size_t j[Lanes];
+		for (unsigned lane = 0; lane < Lanes; lane++)
+		{
+			i[lane] = io_states[lane].m_i;
+			j[lane] = io_states[lane].m_j;
+		}
+
+		unsigned char keystream[Lanes][RC4Block];
+		for (size_t done = 0; done < _steps; done += RC4Block)
+		{
+			size_t block = (_steps - done < RC4Block) ? _steps - done : RC4Block;
+			for (size_t charIdx = 0; charIdx < block; charIdx++)
+			{
+				RC4StepAll<Lanes>::Do(io_states[0].m_s, sizeof(RC4Context), i, j, keystream, charIdx);
+			}
+			for (unsigned lane = 0; lane < Lanes; lane++)
+			{
+				unsigned char * data = _data[lane] + done;
+				for (size_t charIdx = 0; charIdx < block; charIdx++)
+				{
+					data[charIdx] ^= keystream[lane][charIdx];
+				}
+			}
+		}
+
+		for (unsigned lane = 0; lane < Lanes; lane++)
+		{
+			io_states[lane].m_i = (unsigned char)i[lane];
+			io_states[lane].m_j = (unsigned char)j[lane];
+		}
+	}
 
-	size_t i = 0;
-	size_t j = 0;
-	for (size_t charIdx = 0; charIdx < _plainSz; charIdx++)
+	template <unsigned Lanes>
+	static void Run( Source const & _source, RC4Buffer const * _buffers, size_t _count )
 	{
-		i = (i + 1u) % 256u;
-		j = (j + s[i]) % 256u;
-		fSwap(s[i],s[j]);
-		unsigned char keystream = s[ (s[i] + s[j]) % 256 ];
-		unsigned char encrypted = (unsigned char)(io_buff[charIdx] ^ keystream );
-		io_buff[charIdx] = encrypted;
+		// Lanes work on their own copies, side by side, written back to
+		// the caller's context (if it's theirs) when the buffer is done
+		RC4Context state[Lanes];
+		RC4Context * owner[Lanes];
+		unsigned char * data[Lanes];
+		size_t left[Lanes];
+		size_t next = 0;
+
+		// Start the next non-empty buffer in lane _lane
+		auto load = [&](unsigned _lane) -> bool
+		{
+			while (next < _count && _buffers[next].m_len == 0)
+			{
+				next++;
+			}
+			if (next == _count)
+			{
+				return false;
+			}
+			owner[_lane] = (_source.m_keyed != NULL) ? NULL : &_source.m_contexts[next];
+			state[_lane] = (_source.m_keyed != NULL) ? *_source.m_keyed : *owner[_lane];
+			data[_lane] = _buffers[next].m_data;
+			left[_lane] = _buffers[next].m_len;
+			next++;
+			return true;
+		};
+		auto store = [&](unsigned _lane)
+		{
+			if (owner[_lane] != NULL)
+			{
+				*owner[_lane] = state[_lane];
+			}
+		};
+
+		unsigned loaded = 0;
+		while (loaded < Lanes && load(loaded))
+		{
+			loaded++;
+		}
+
+		while (loaded == Lanes)
+		{
+			size_t steps = left[0];
+			for (unsigned lane = 1; lane < Lanes; lane++)
+			{
+				steps = (left[lane] < steps) ? left[lane] : steps;
+			}
+
+			Steps<Lanes>(state, data, steps);
+
+			for (unsigned lane = 0; lane < loaded; )
+			{
+				data[lane] += steps;
+				left[lane] -= steps;
+				if (left[lane] != 0)
+				{
+					lane++;
+					continue;
+				}
+				store(lane);
+				if (load(lane))
+				{
+					lane++;
+					continue;
+				}
+				// Nothing left to start: move the last lane, which has yet to be
+				// advanced, into the gap and look at this lane again
+				loaded--;
+				if (lane != loaded)
+				{
+					state[lane] = state[loaded];
+					owner[lane] = owner[loaded];
+					data[lane] = data[loaded];
+					left[lane] = left[loaded];
+				}
+			}
+		}
+
+		for (unsigned lane = 0; lane < loaded; lane++)
+		{
+			state[lane].Process(data[lane], left[lane]);
+			store(lane);
+		}
 	}
 
+	static void Dispatch( Source const & _source, RC4Buffer const * _buffers, size_t _count, unsigned _lanes )
+	{
+		if (_lanes == 8)
+		{
+			Run<8>(_source, _buffers, _count);
+		}
+		else if (_lanes == 4)
+		{
+			Run<4>(_source, _buffers, _count);
+		}
+		else
+		{
+			Run<1>(_source, _buffers, _count);
+		}
+	}
+};
+
+
+void RC4Context::EncryptBatch
+(
+	RC4Context const & _keyed,
+	RC4Buffer const * io_buffers,
+	size_t _count,
+	unsigned _lanes
+)
+{
+	RC4Lanes::Source source = { &_keyed, NULL };
+	RC4Lanes::Dispatch(source, io_buffers, _count, _lanes);
 }
 
 
+void RC4Context::ProcessBatch
+(
+	RC4Context * io_contexts,
+	RC4Buffer const * io_buffers,
+	size_t _count,
+	unsigned _lanes
+)
+{
+	RC4Lanes::Source source = { NULL, io_contexts };
+	RC4Lanes::Dispatch(source, io_buffers, _count, _lanes);
+}
 
 
+void RC4Encrypt::Encrypt
+(
+	std::string const & _key,
+	unsigned char *io_buff,
+	size_t _plainSz
+)
+{
+	RC4Context context(_key);
+	context.Process(io_buff, _plainSz);
+}
 
 
+void RC4Encrypt::Encrypt
+(
+	char const * _key,
+	unsigned char *io_buff,
+	size_t _plainSz
+)
+{
+	RC4Context context(_key);
+	context.Process(io_buff, _plainSz);
+}
@@ -12,13 +12,66 @@
 
 
 
-class RC4Encrypt
+/// One buffer of a batch, encrypted in place
+struct RC4Buffer
+{
+	unsigned char * m_data;
+	size_t m_len;
+};
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// RC4 state: the key schedule is run once, when the context is keyed, and
+/// Process() carries on the same keystream from one call to the next, so
+/// a payload can be done in pieces. Copying a context is 258 bytes, so a
+/// keyed one kept as a template can be cloned for each payload.
+class RC4Context
 {
 public:
-	static void Encrypt( std::string const & _key, unsigned char * io_buff, size_t _plainSz );
+	RC4Context( char const * _key, size_t _keyLen );
+	explicit RC4Context( char const * _key );
+	explicit RC4Context( std::string const & _key );
+
+	/// Run the key schedule, restarting the keystream. _keyLen must not be 0.
+	void SetKey( char const * _key, size_t _keyLen );
+
+	/// XOR the next _len bytes of keystream into io_buff
+	void Process( unsigned char * io_buff, size_t _len );
+
+	/// As above, from _input to o_output, which may be the same buffer
+	void Process( unsigned char const * _input, unsigned char * o_output, size_t _len );
+
+	/// Encrypt each of io_buffers as RC4Encrypt::Encrypt would with _keyed's
+	/// key, from a fresh clone of _keyed each. Each byte of RC4 depends on
+	/// the swap before it, so one stream leaves the CPU waiting on its
+	/// S-box loads; _lanes (4 or 8) streams are stepped together to overlap
+	/// them. Any other _lanes does the buffers one at a time. On x64, 8 lanes
+	/// run out of registers and are slower than 4, see WatchDogBench.
+	static void EncryptBatch( RC4Context const & _keyed, RC4Buffer const * io_buffers, size_t _count, unsigned _lanes = 4 );
+
+	/// As above, but advancing io_contexts[n] over io_buffers[n]
+	static void ProcessBatch( RC4Context * io_contexts, RC4Buffer const * io_buffers, size_t _count, unsigned _lanes = 4 );
 
 private:
-	static void InitialisePermutationArray( std::string const & _key, unsigned char * _s);
+	friend struct RC4Lanes;
+
+	/// Unkeyed, for RC4Lanes to copy into
+	RC4Context() : m_i(0), m_j(0) {}
+
+	unsigned char m_s[256];
+	unsigned char m_i;
+	unsigned char m_j;
+};
+
+
+
+class RC4Encrypt
+{
+public:
+	/// One-off encryption of a buffer; use an RC4Context to reuse the key schedule
+	static void Encrypt( std::string const & _key, unsigned char * io_buff, size_t _plainSz );
+	static void Encrypt( char const * _key, unsigned char * io_buff, size_t _plainSz );
 };
 
 
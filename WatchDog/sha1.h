@@ -12,23 +12,50 @@
 #define _FSHA1_DAS_011112_H
 
 //#include "fCore/Types/fString.h"
+#include <stddef.h>
+#include "Sha1Digest.h"
 
 typedef size_t fSizeType;
+typedef unsigned int fUInt32;
 typedef unsigned long long uint64;
 
 struct fSHA1
 {
-	unsigned long m_hash[5];
+	fUInt32 m_hash[5];
     char m_formatted[64];
 
+	// Carry for Update(): bytes not yet making up a whole block, and the
+	// number of bytes passed to Update() since StreamStart()
+	unsigned char m_buffer[64];
+	fUInt32 m_bufferSize;
+	uint64 m_totalSize;
+
+	// Block API: StreamBlock takes whole 64 byte blocks only, StreamFinal the
+	// remainder together with the overall message length
 	void StreamStart();
 	void StreamBlock(void const* _data, fSizeType _size);
 	void StreamFinal(void const* _data, fSizeType _size, uint64 _totalSize);
 
+	// Byte API: any sized pieces, then Finish() once. Don't mix with the block API.
+	void Update(void const* _data, fSizeType _size);
+	void Finish();
+
+	// Byte API state mid-stream (hash words, byte count and unhashed tail),
+	// so a hash can be saved and carried on later from where it left off.
+	// The layout is fixed, independent of compiler and byte order.
+	enum { StateSize = 5 * 4 + 8 + 64 };
+	void SaveState(unsigned char* o_state) const;
+	bool LoadState(unsigned char const* _state);
+
 	static fSHA1 ComputeHash(void const* _data, fSizeType _size);
 
+	// The finished hash as bytes; ToString formats the same thing as upper case hex
+	Sha1Digest Digest() const;
 	char const * ToString();
 
+	// Name of the compression kernel selected for this CPU ("sha-ni", "ssse3" or "scalar")
+	static char const * KernelName();
+
 	fSHA1()
 	{
 		m_hash[0] = 0;
@@ -36,6 +63,8 @@ struct fSHA1
 		m_hash[2] = 0;
 		m_hash[3] = 0;
 		m_hash[4] = 0;
+		m_bufferSize = 0;
+		m_totalSize = 0;
 	}
 
 };
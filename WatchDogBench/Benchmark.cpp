@@ -0,0 +1,244 @@
+/*----------------------------------------------------------------------------
+ *  FILE: Benchmark.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "Benchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+
+static volatile unsigned s_sink;
+
+void BenchKeep(unsigned _value)
+{
+	s_sink = s_sink + _value;
+}
+
+BenchStats BenchStats::From
+(
+	std::vector<double> _samples
+)
+{
+	BenchStats stats;
+	if (_samples.empty())
+	{
+		return stats;
+	}
+
+	std::sort(_samples.begin(), _samples.end());
+	size_t count = _samples.size();
+	stats.m_min = _samples.front();
+	stats.m_max = _samples.back();
+	stats.m_median = (count & 1) ? _samples[count / 2] : (_samples[count / 2 - 1] + _samples[count / 2]) * 0.5;
+
+	double sum = 0.0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		sum += _samples[i];
+	}
+	stats.m_mean = sum / (double)count;
+
+	double squares = 0.0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		squares += (_samples[i] - stats.m_mean) * (_samples[i] - stats.m_mean);
+	}
+	stats.m_stddev = (count > 1) ? sqrt(squares / (double)(count - 1)) : 0.0;
+	return stats;
+}
+
+BenchRunner::BenchRunner
+(
+	Options const& _options,
+	std::ostream& _out
+):
+	m_options(_options),
+	m_out(_out)
+{
+	if (m_options.m_repetitions == 0)
+	{
+		m_options.m_repetitions = 1;
+	}
+}
+
+bool BenchRunner::Wanted
+(
+	std::string const& _name
+) const
+{
+	return m_options.m_filter.empty() || _name.find(m_options.m_filter) != std::string::npos;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Seconds taken by _iterations operations
+static double TimeBody
+(
+	BenchRunner::Body const& _body,
+	uint64 _iterations
+)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	_body(_iterations);
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void BenchRunner::Run
+(
+	std::string const& _name,
+	uint64 _bytes,
+	Body const& _body,
+	Setup const& _setup,
+	uint64 _fixedIterations
+)
+{
+	if (!Wanted(_name))
+	{
+		return;
+	}
+
+	BenchResult result;
+	result.m_name = _name;
+	result.m_bytes = _bytes;
+
+	uint64 iterations = _fixedIterations;
+	if (iterations == 0)
+	{
+		// Grow until one repetition takes long enough to time reliably, the
+		// first call also warms caches and the branch predictors
+		iterations = 1;
+		for (;;)
+		{
+			double seconds = TimeBody(_body, iterations);
+			if (seconds >= m_options.m_minSeconds)
+			{
+				break;
+			}
+			uint64 next = (seconds > 0.0) ? (uint64)((double)iterations * m_options.m_minSeconds * 1.2 / seconds) : iterations * 100;
+			iterations = std::max(iterations * 2, std::min(next, iterations * 100));
+		}
+	}
+	result.m_iterations = iterations;
+
+	for (unsigned rep = 0; rep < m_options.m_repetitions; ++rep)
+	{
+		if (_setup)
+		{
+			_setup();
+		}
+		double seconds = TimeBody(_body, iterations);
+		result.m_nsPerOp.push_back(seconds * 1e9 / (double)iterations);
+	}
+	result.m_stats = BenchStats::From(result.m_nsPerOp);
+
+	char line[512];
+	snprintf(line, sizeof(line), "%-40s %12.1f ns/op  (min %.1f, mean %.1f, sd %.1f)",
+		_name.c_str(), result.m_stats.m_median, result.m_stats.m_min, result.m_stats.m_mean, result.m_stats.m_stddev);
+	m_out << line;
+	if (_bytes != 0)
+	{
+		snprintf(line, sizeof(line), "  %8.3f GB/s", result.GigabytesPerSecond());
+		m_out << line;
+	}
+	m_out << "\n";
+	m_out.flush();
+
+	m_results.push_back(result);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief _text as a quoted JSON string
+static std::string JsonString
+(
+	std::string const& _text
+)
+{
+	std::string quoted = "\"";
+	for (size_t i = 0; i < _text.size(); ++i)
+	{
+		unsigned char c = (unsigned char)_text[i];
+		if (c == '"' || c == '\\')
+		{
+			quoted += '\\';
+			quoted += (char)c;
+		}
+		else if (c < 0x20)
+		{
+			char escaped[8];
+			snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+			quoted += escaped;
+		}
+		else
+		{
+			quoted += (char)c;
+		}
+	}
+	return quoted + "\"";
+}
+
+static std::string JsonNumber
+(
+	double _value
+)
+{
+	char text[64];
+	snprintf(text, sizeof(text), "%.17g", _value);
+	return text;
+}
+
+void BenchRunner::WriteJson
+(
+	std::ostream& _out,
+	std::string const& _kernel
+) const
+{
+#if defined(_DEBUG)
+	char const* build = "debug";
+#else
+	char const* build = "release";
+#endif
+#if defined(_MSC_VER)
+	char const* compiler = "msvc";
+#elif defined(__clang__)
+	char const* compiler = "clang";
+#elif defined(__GNUC__)
+	char const* compiler = "gcc";
+#else
+	char const* compiler = "unknown";
+#endif
+
+	_out << "{\n";
+	_out << "  \"build\": " << JsonString(build) << ",\n";
+	_out << "  \"compiler\": " << JsonString(compiler) << ",\n";
+	_out << "  \"sha1Kernel\": " << JsonString(_kernel) << ",\n";
+	_out << "  \"repetitions\": " << m_options.m_repetitions << ",\n";
+	_out << "  \"results\": [";
+	for (size_t i = 0; i < m_results.size(); ++i)
+	{
+		BenchResult const& result = m_results[i];
+		_out << (i ? ",\n" : "\n");
+		_out << "    {\n";
+		_out << "      \"name\": " << JsonString(result.m_name) << ",\n";
+		_out << "      \"bytes\": " << result.m_bytes << ",\n";
+		_out << "      \"iterations\": " << result.m_iterations << ",\n";
+		_out << "      \"nsPerOp\": { \"min\": " << JsonNumber(result.m_stats.m_min)
+			<< ", \"median\": " << JsonNumber(result.m_stats.m_median)
+			<< ", \"mean\": " << JsonNumber(result.m_stats.m_mean)
+			<< ", \"stddev\": " << JsonNumber(result.m_stats.m_stddev)
+			<< ", \"max\": " << JsonNumber(result.m_stats.m_max) << " },\n";
+		_out << "      \"gbPerSecond\": " << JsonNumber(result.GigabytesPerSecond()) << ",\n";
+		_out << "      \"samples\": [";
+		for (size_t s = 0; s < result.m_nsPerOp.size(); ++s)
+		{
+			_out << (s ? ", " : "") << JsonNumber(result.m_nsPerOp[s]);
+		}
+		_out << "]\n";
+		_out << "    }";
+	}
+	_out << "\n  ]\n";
+	_out << "}\n";
+}
@@ -0,0 +1,94 @@
+/*----------------------------------------------------------------------------
+ *  FILE: Benchmark.h
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		Minimal timing harness. Each case is calibrated to a number of
+ *		iterations that takes at least the minimum time, then timed for the
+ *		requested number of repetitions; the per-repetition ns/op figures are
+ *		summarised and can be written out as JSON for comparing builds.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef _BENCHMARK_H
+#define _BENCHMARK_H
+
+#include "../WatchDog/sha1.h"
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct BenchStats
+{
+	double m_min;
+	double m_median;
+	double m_mean;
+	double m_stddev;
+	double m_max;
+
+	BenchStats() : m_min(0.0), m_median(0.0), m_mean(0.0), m_stddev(0.0), m_max(0.0) {}
+
+	static BenchStats From(std::vector<double> _samples);
+};
+
+struct BenchResult
+{
+	std::string m_name;
+	uint64 m_bytes;					// processed per operation, 0 if throughput means nothing
+	uint64 m_iterations;			// operations per repetition
+	std::vector<double> m_nsPerOp;	// one sample per repetition
+	BenchStats m_stats;
+
+	/// Throughput at the median, 0 if m_bytes is
+	double GigabytesPerSecond() const
+	{
+		return (m_stats.m_median > 0.0) ? (double)m_bytes / m_stats.m_median : 0.0;
+	}
+};
+
+class BenchRunner
+{
+public:
+	// Runs the operation _iterations times
+	typedef std::function<void(uint64 _iterations)> Body;
+	// Called before each timed repetition, outside the timing
+	typedef std::function<void()> Setup;
+
+	struct Options
+	{
+		unsigned m_repetitions;
+		double m_minSeconds;		// per repetition, when calibrating
+		std::string m_filter;		// only run cases whose name contains this
+
+		Options() : m_repetitions(10), m_minSeconds(0.05) {}
+	};
+
+	BenchRunner(Options const& _options, std::ostream& _out);
+
+	/// Calibrate and time one case, printing a line as it completes.
+	/// A non-zero _fixedIterations skips calibration, for cases where every
+	/// repetition needs _setup to run first (e.g. evicting the file cache).
+	void Run(std::string const& _name, uint64 _bytes, Body const& _body, Setup const& _setup = Setup(), uint64 _fixedIterations = 0);
+
+	bool Wanted(std::string const& _name) const;
+
+	std::vector<BenchResult> const& Results() const
+	{
+		return m_results;
+	}
+
+	/// Every result so far, with the per-repetition samples
+	void WriteJson(std::ostream& _out, std::string const& _kernel) const;
+
+private:
+	Options m_options;
+	std::ostream& m_out;
+	std::vector<BenchResult> m_results;
+};
+
+/// Somewhere to put results so the compiler can't drop the work producing them
+void BenchKeep(unsigned _value);
+
+#endif
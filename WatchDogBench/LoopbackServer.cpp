@@ -0,0 +1,493 @@
+/*----------------------------------------------------------------------------
+ *  FILE: LoopbackServer.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+#include "LoopbackServer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+typedef int SocketLength;
+static const uintptr_t s_noSocket = (uintptr_t)INVALID_SOCKET;
+static void CloseSocket(uintptr_t _socket) { closesocket((SOCKET)_socket); }
+static void ShutdownSocket(uintptr_t _socket) { shutdown((SOCKET)_socket, SD_BOTH); }
+#else
+typedef socklen_t SocketLength;
+static const uintptr_t s_noSocket = (uintptr_t)-1;
+static void CloseSocket(uintptr_t _socket) { close((int)_socket); }
+static void ShutdownSocket(uintptr_t _socket) { shutdown((int)_socket, SHUT_RDWR); }
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL (0)
+#endif
+
+// GET bodies repeat a block this big
+static const size_t s_patternSize = 1 << 20;
+
+void LoopbackServer::Pattern
+(
+	uint64 _offset,
+	void* o_data,
+	size_t _size
+)
+{
+	static std::vector<unsigned char> const s_pattern = []()
+	{
+		std::vector<unsigned char> pattern(s_patternSize);
+		unsigned seed = 0x9E3779B9u;
+		for (size_t i = 0; i < pattern.size(); ++i)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			pattern[i] = (unsigned char)(seed >> 24);
+		}
+		return pattern;
+	}();
+
+	unsigned char* data = (unsigned char*)o_data;
+	while (_size != 0)
+	{
+		size_t at = (size_t)(_offset % s_patternSize);
+		size_t size = (s_patternSize - at < _size) ? s_patternSize - at : _size;
+		memcpy(data, &s_pattern[at], size);
+		data += size;
+		_offset += size;
+		_size -= size;
+	}
+}
+
+static std::string FormatUploadReply
+(
+	uint64 _size,
+	fSHA1& io_sha
+)
+{
+	io_sha.Finish();
+	char hex[Sha1Digest::HexLength + 1];
+	io_sha.Digest().ToHex(hex, true);
+	char reply[96];
+	snprintf(reply, sizeof(reply), "%llu %s", (unsigned long long)_size, hex);
+	return reply;
+}
+
+std::string LoopbackServer::UploadReply
+(
+	void const* _data,
+	size_t _size
+)
+{
+	fSHA1 sha;
+	sha.StreamStart();
+	sha.Update(_data, _size);
+	return FormatUploadReply(_size, sha);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The server's end of a connection: buffered reads, whole writes
+class LoopbackConnection
+{
+public:
+	explicit LoopbackConnection(uintptr_t _socket) : m_socket(_socket), m_begin(0), m_end(0), m_buffer(64 * 1024) {}
+
+	bool ReadLine(std::string* o_line)
+	{
+		o_line->clear();
+		while (true)
+		{
+			if (m_begin == m_end && !Fill())
+			{
+				return false;
+			}
+			char c = m_buffer[m_begin++];
+			if (c == '\n')
+			{
+				if (!o_line->empty() && (*o_line)[o_line->size() - 1] == '\r')
+				{
+					o_line->resize(o_line->size() - 1);
+				}
+				return true;
+			}
+			*o_line += c;
+		}
+	}
+
+	/// _size bytes, into the hash
+	bool Read(uint64 _size, fSHA1& io_sha)
+	{
+		while (_size != 0)
+		{
+			if (m_begin == m_end && !Fill())
+			{
+				return false;
+			}
+			size_t size = (m_end - m_begin < _size) ? m_end - m_begin : (size_t)_size;
+			io_sha.Update(&m_buffer[m_begin], size);
+			m_begin += size;
+			_size -= size;
+		}
+		return true;
+	}
+
+	bool Write(void const* _data, size_t _size)
+	{
+		char const* data = (char const*)_data;
+		while (_size != 0)
+		{
+			int size = (_size < (1u << 30)) ? (int)_size : (1 << 30);
+#ifdef _WIN32
+			int sent = send((SOCKET)m_socket, data, size, 0);
+#else
+			int sent = (int)send((int)m_socket, data, size, MSG_NOSIGNAL);
+#endif
+			if (sent <= 0)
+			{
+				return false;
+			}
+			data += sent;
+			_size -= sent;
+		}
+		return true;
+	}
+
+	bool Write(std::string const& _text)
+	{
+		return Write(_text.data(), _text.size());
+	}
+
+private:
+	bool Fill()
+	{
+#ifdef _WIN32
+		int received = recv((SOCKET)m_socket, &m_buffer[0], (int)m_buffer.size(), 0);
+#else
+		int received;
+		do
+		{
+			received = (int)recv((int)m_socket, &m_buffer[0], m_buffer.size(), 0);
+		}
+		while (received < 0 && errno == EINTR);
+#endif
+		m_begin = 0;
+		m_end = (received > 0) ? (size_t)received : 0;
+		return received > 0;
+	}
+
+	uintptr_t m_socket;
+	size_t m_begin;
+	size_t m_end;
+	std::vector<char> m_buffer;
+};
+
+LoopbackServer::LoopbackServer():
+	m_listener(s_noSocket),
+	m_port(0),
+	m_stopping(false),
+	m_accepted(0)
+{
+}
+
+LoopbackServer::~LoopbackServer()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_stopping = true;
+		for (std::set<Socket>::const_iterator open = m_open.begin(); open != m_open.end(); ++open)
+		{
+			ShutdownSocket(*open);
+		}
+	}
+	if (m_listener != s_noSocket)
+	{
+		// accept doesn't return for the socket being closed everywhere, but
+		// it does for a connection
+		Socket wake = (Socket)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		sockaddr_in address;
+		memset(&address, 0, sizeof(address));
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		address.sin_port = htons(m_port);
+#ifdef _WIN32
+		connect((SOCKET)wake, (sockaddr const*)&address, sizeof(address));
+#else
+		connect((int)wake, (sockaddr const*)&address, sizeof(address));
+#endif
+		m_acceptThread.join();
+		CloseSocket(wake);
+		CloseSocket(m_listener);
+	}
+
+	std::vector<std::thread> threads;
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		threads.swap(m_threads);
+	}
+	for (size_t i = 0; i < threads.size(); ++i)
+	{
+		threads[i].join();
+	}
+#ifdef _WIN32
+	if (m_listener != s_noSocket)
+	{
+		WSACleanup();
+	}
+#endif
+}
+
+bool LoopbackServer::Start()
+{
+#ifdef _WIN32
+	WSADATA data;
+	if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+	{
+		return false;
+	}
+	Socket listener = (Socket)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+#else
+	Socket listener = (Socket)(intptr_t)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+#endif
+	if (listener == s_noSocket)
+	{
+#ifdef _WIN32
+		WSACleanup();
+#endif
+		return false;
+	}
+
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = 0;
+	SocketLength length = sizeof(address);
+#ifdef _WIN32
+	SOCKET s = (SOCKET)listener;
+#else
+	int s = (int)listener;
+#endif
+	if (bind(s, (sockaddr const*)&address, sizeof(address)) != 0 || listen(s, 64) != 0 ||
+		getsockname(s, (sockaddr*)&address, &length) != 0)
+	{
+		CloseSocket(listener);
+#ifdef _WIN32
+		WSACleanup();
+#endif
+		return false;
+	}
+	m_listener = listener;
+	m_port = ntohs(address.sin_port);
+	m_acceptThread = std::thread(&LoopbackServer::AcceptLoop, this);
+	return true;
+}
+
+unsigned LoopbackServer::Connections() const
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	return m_accepted;
+}
+
+void LoopbackServer::AcceptLoop()
+{
+	while (true)
+	{
+#ifdef _WIN32
+		Socket connection = (Socket)accept((SOCKET)m_listener, NULL, NULL);
+#else
+		Socket connection = (Socket)(intptr_t)accept((int)m_listener, NULL, NULL);
+#endif
+		std::lock_guard<std::mutex> lock(m_lock);
+		if (m_stopping)
+		{
+			if (connection != s_noSocket)
+			{
+				CloseSocket(connection);
+			}
+			return;
+		}
+		if (connection == s_noSocket)
+		{
+			continue;
+		}
+		int one = 1;
+#ifdef _WIN32
+		setsockopt((SOCKET)connection, IPPROTO_TCP, TCP_NODELAY, (char const*)&one, sizeof(one));
+#else
+		setsockopt((int)connection, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#endif
+		++m_accepted;
+		m_open.insert(connection);
+		m_threads.push_back(std::thread(&LoopbackServer::Serve, this, connection));
+	}
+}
+
+void LoopbackServer::Serve
+(
+	Socket _socket
+)
+{
+	LoopbackConnection connection(_socket);
+	std::string line;
+	std::vector<unsigned char> chunk(64 * 1024);
+
+	while (connection.ReadLine(&line))
+	{
+		char method[16], path[1024];
+		if (sscanf(line.c_str(), "%15s %1023s", method, path) != 2)
+		{
+			break;
+		}
+		bool close = false;
+		bool chunked = false;
+		uint64 contentLength = 0;
+		while (connection.ReadLine(&line) && !line.empty())
+		{
+			size_t colon = line.find(':');
+			std::string name = line.substr(0, colon);
+			std::string value = (colon == std::string::npos) ? std::string() : line.substr(colon + 1);
+			for (size_t i = 0; i < name.size(); ++i)
+			{
+				name[i] = (char)tolower((unsigned char)name[i]);
+			}
+			if (name == "content-length")
+			{
+				contentLength = strtoull(value.c_str(), NULL, 10);
+			}
+			else if (name == "transfer-encoding")
+			{
+				chunked = value.find("chunked") != std::string::npos;
+			}
+			else if (name == "connection")
+			{
+				close = value.find("close") != std::string::npos;
+			}
+		}
+
+		// bodies are only ever hashed, so uploads of any size take no memory
+		fSHA1 sha;
+		sha.StreamStart();
+		uint64 bodySize = 0;
+		bool ok = true;
+		if (chunked)
+		{
+			while (ok)
+			{
+				ok = connection.ReadLine(&line);
+				uint64 size = strtoull(line.c_str(), NULL, 16);
+				if (size == 0)
+				{
+					// no trailers from SimpleHttpRequest, just the empty line
+					ok = ok && connection.ReadLine(&line);
+					break;
+				}
+				ok = ok && connection.Read(size, sha) && connection.ReadLine(&line);
+				bodySize += size;
+			}
+		}
+		else
+		{
+			ok = connection.Read(contentLength, sha);
+			bodySize = contentLength;
+		}
+		if (!ok)
+		{
+			break;
+		}
+
+		std::string verb = method;
+		std::string target = path;
+		bool head = (verb == "HEAD");
+		char header[256];
+		if (verb == "PUT" || verb == "POST")
+		{
+			std::string reply = FormatUploadReply(bodySize, sha);
+			snprintf(header, sizeof(header), "HTTP/1.1 200 OK\r\nContent-Length: %u\r\n\r\n", (unsigned)reply.size());
+			if (!connection.Write(header + reply))
+			{
+				break;
+			}
+		}
+		else if ((verb == "GET" || head) && target.compare(0, 7, "/bytes/") == 0)
+		{
+			uint64 size = strtoull(target.c_str() + 7, NULL, 10);
+			snprintf(header, sizeof(header), "HTTP/1.1 200 OK\r\nContent-Length: %llu\r\n\r\n", (unsigned long long)size);
+			ok = connection.Write(header);
+			for (uint64 sent = 0; ok && !head && sent < size; )
+			{
+				size_t piece = (size - sent < chunk.size()) ? (size_t)(size - sent) : chunk.size();
+				Pattern(sent, &chunk[0], piece);
+				ok = connection.Write(&chunk[0], piece);
+				sent += piece;
+			}
+			if (!ok)
+			{
+				break;
+			}
+		}
+		else if ((verb == "GET" || head) && target.compare(0, 9, "/chunked/") == 0)
+		{
+			uint64 size = strtoull(target.c_str() + 9, NULL, 10);
+			ok = connection.Write("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n");
+			for (uint64 sent = 0; ok && !head && sent < size; )
+			{
+				size_t piece = (size - sent < chunk.size()) ? (size_t)(size - sent) : chunk.size();
+				Pattern(sent, &chunk[0], piece);
+				snprintf(header, sizeof(header), "%x\r\n", (unsigned)piece);
+				ok = connection.Write(header) && connection.Write(&chunk[0], piece) && connection.Write("\r\n");
+				sent += piece;
+			}
+			if (!ok || (!head && !connection.Write("0\r\n\r\n")))
+			{
+				break;
+			}
+		}
+		else if ((verb == "GET" || head) && target.compare(0, 7, "/close/") == 0)
+		{
+			uint64 size = strtoull(target.c_str() + 7, NULL, 10);
+			ok = connection.Write("HTTP/1.1 200 OK\r\nConnection: close\r\n\r\n");
+			for (uint64 sent = 0; ok && !head && sent < size; )
+			{
+				size_t piece = (size - sent < chunk.size()) ? (size_t)(size - sent) : chunk.size();
+				Pattern(sent, &chunk[0], piece);
+				ok = connection.Write(&chunk[0], piece);
+				sent += piece;
+			}
+			break;
+		}
+		else if (verb == "GET" && target == "/drop")
+		{
+			connection.Write("HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n");
+			break;
+		}
+		else
+		{
+			if (!connection.Write("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n"))
+			{
+				break;
+			}
+		}
+
+		if (close)
+		{
+			break;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	m_open.erase(_socket);
+	CloseSocket(_socket);
+}
@@ -0,0 +1,75 @@
+/*----------------------------------------------------------------------------
+ *  FILE: LoopbackServer.h
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		A stand-in for the upload server on 127.0.0.1, in process, so the
+ *		HTTP client can be checked and timed without the network or
+ *		LocalUploadServer.py. One thread per connection, keep-alive, and
+ *		just enough HTTP/1.1 for SimpleHttpRequest:
+ *
+ *			GET /bytes/<n>		n bytes of Pattern, with Content-Length
+ *			GET /chunked/<n>	the same, chunked
+ *			GET /close/<n>		the same, ending when the connection closes
+ *			GET /drop			an empty reply, then the connection closes
+ *								though it was left open
+ *			PUT or POST			the body, of either kind, is read and the
+ *								reply is "<size> <SHA-1 in hex>"
+ *
+ *		HEAD works as GET without the body, anything else is a 404.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef _LOOPBACKSERVER_H
+#define _LOOPBACKSERVER_H
+
+#include "../WatchDog/sha1.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+class LoopbackServer
+{
+public:
+	LoopbackServer();
+	/// Stops it, closing any connections still open
+	~LoopbackServer();
+
+	/// Listen on an ephemeral port
+	/// @return false if it couldn't
+	bool Start();
+	unsigned short Port() const { return m_port; }
+	/// Connections accepted so far
+	unsigned Connections() const;
+
+	/// What a GET sends, byte _offset onwards
+	static void Pattern(uint64 _offset, void* o_data, size_t _size);
+	/// The reply to a PUT or POST of _data
+	static std::string UploadReply(void const* _data, size_t _size);
+
+private:
+	// A socket, whichever kind the platform has
+	typedef uintptr_t Socket;
+
+	LoopbackServer(LoopbackServer const&);
+	LoopbackServer& operator=(LoopbackServer const&);
+
+	void AcceptLoop();
+	void Serve(Socket _connection);
+
+	Socket m_listener;
+	unsigned short m_port;
+	bool m_stopping;
+	unsigned m_accepted;
+	std::thread m_acceptThread;
+	std::vector<std::thread> m_threads;
+	std::set<Socket> m_open;
+	mutable std::mutex m_lock;
+};
+
+#endif
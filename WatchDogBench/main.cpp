@@ -0,0 +1,965 @@
+/*----------------------------------------------------------------------------
+ *  FILE: main.cpp
+ *
+ *		Copyright(c) 2026 Frontier Developments Ltd.
+ *
+ *		WatchDogBench: timings for the primitives WatchDog is built on,
+ *		fSHA1 over memory and files, XXH3, RC4Encrypt and the Base16
+ *		encoding of the arguments passed to the game.
+ *
+ *		WatchDogBench [/Repetitions <n>] [/MinTime <ms>] [/Filter <text>]
+ *			[/Json <file>] [/File <path>] [/FileSize <MB>]
+ *			[/FileMode serial|pipelined|mapped]
+ *
+ *		/File hashes an existing file, otherwise a file of /FileSize MB is
+ *		written next to the executable's working directory and removed
+ *		afterwards. /FileSize 0 skips the file cases.
+ *
+ *		fSHA1 is checked against fSHA1Constexpr first, and fSHA1MultiHasher
+ *		and fSHA1HashFiles against fSHA1. The sha1-multi/ cases time the
+ *		lanes against one fSHA1::ComputeHash per message. The http/ cases time
+ *		SimpleHttpRequest against LoopbackServer, after checking what it
+ *		sends and receives. The exit code is 3 if a check fails.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#include "Benchmark.h"
+#include "../WatchDog/Base16.h"
+#include "../WatchDog/FileHasher.h"
+#include "../WatchDog/rc4encrypt.h"
+#include "../WatchDog/sha1.h"
+#include "../WatchDog/Sha1Constexpr.h"
+#include "../WatchDog/Sha1Multi.h"
+#include "../WatchDog/SimpleHttp.h"
+#include "../WatchDog/Xxh3.h"
+#include "LoopbackServer.h"
+#include <fstream>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// What WatchDog keys the argument encryption with, see PutArgsInSharedMemory
+static char const* const SharedMemoryKey = "Local\\ED-12345-Wd";
+
+static std::string SizeName
+(
+	uint64 _bytes
+)
+{
+	char name[32];
+	if (_bytes >= (1ull << 30) && (_bytes & ((1ull << 30) - 1)) == 0)
+	{
+		sprintf(name, "%lluGB", _bytes >> 30);
+	}
+	else if (_bytes >= (1ull << 20) && (_bytes & ((1ull << 20) - 1)) == 0)
+	{
+		sprintf(name, "%lluMB", _bytes >> 20);
+	}
+	else if (_bytes >= (1ull << 10) && (_bytes & ((1ull << 10) - 1)) == 0)
+	{
+		sprintf(name, "%lluKB", _bytes >> 10);
+	}
+	else
+	{
+		sprintf(name, "%lluB", _bytes);
+	}
+	return name;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Drop the file's pages from the OS cache so the next read comes
+///        from the disk
+/// @return false if the platform gave no way to do it
+static bool EvictFromCache
+(
+	std::string const& _path
+)
+{
+#ifdef _WIN32
+	// There's no per-file purge call, but opening a file for unbuffered
+	// access makes the cache manager flush and discard what it holds of it
+	HANDLE file = CreateFileA(_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	CloseHandle(file);
+	return true;
+#elif defined(POSIX_FADV_DONTNEED)
+	int fd = open(_path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+	fdatasync(fd);
+	bool ok = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+	close(fd);
+	return ok;
+#else
+	return false;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Write _size bytes of pseudo random data to _path
+static bool WriteTestFile
+(
+	std::string const& _path,
+	uint64 _size
+)
+{
+	std::ofstream file(_path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		return false;
+	}
+	std::vector<unsigned char> chunk(1024 * 1024);
+	unsigned seed = 0x12345678;
+	for (size_t i = 0; i < chunk.size(); ++i)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		chunk[i] = (unsigned char)(seed >> 24);
+	}
+	for (uint64 written = 0; written < _size; written += chunk.size())
+	{
+		// vary each chunk a little so the file isn't one block repeated
+		memcpy(&chunk[0], &written, sizeof(written));
+		size_t size = (size_t)((_size - written < chunk.size()) ? _size - written : chunk.size());
+		file.write((char const*)&chunk[0], size);
+	}
+	return file.good();
+}
+
+static void IgnoreJob
+(
+	fSHA1Job* /*_job*/,
+	void* /*_context*/
+)
+{
+}
+
+static void MemoryBenchmarks
+(
+	BenchRunner& _runner
+)
+{
+	static uint64 const sizes[] = { 64, 1024, 16 * 1024, 256 * 1024, 4 * 1024 * 1024, 64 * 1024 * 1024 };
+	static size_t const sizeCount = sizeof(sizes) / sizeof(sizes[0]);
+	uint64 largest = sizes[sizeCount - 1];
+
+	// 64 byte aligned, +1 for the unaligned cases
+	std::vector<unsigned char> storage((size_t)largest + 128);
+	unsigned char* aligned = &storage[0] + ((64 - ((size_t)&storage[0] & 63)) & 63);
+	for (size_t i = 0; i < storage.size(); ++i)
+	{
+		storage[i] = (unsigned char)(i * 131 + (i >> 8));
+	}
+
+	for (size_t s = 0; s < sizeCount; ++s)
+	{
+		for (unsigned offset = 0; offset < 2; ++offset)
+		{
+			unsigned char const* data = aligned + offset;
+			size_t size = (size_t)sizes[s];
+			_runner.Run("sha1/" + SizeName(size) + (offset ? "/unaligned" : "/aligned"), size,
+				[data, size](uint64 _iterations)
+				{
+					for (uint64 i = 0; i < _iterations; ++i)
+					{
+						BenchKeep(fSHA1::ComputeHash(data, size).m_hash[0]);
+					}
+				});
+		}
+	}
+
+	static uint64 const fastSizes[] = { 64, 16 * 1024, 4 * 1024 * 1024 };
+	for (size_t s = 0; s < sizeof(fastSizes) / sizeof(fastSizes[0]); ++s)
+	{
+		unsigned char const* data = aligned;
+		size_t size = (size_t)fastSizes[s];
+		_runner.Run("xxh3/" + SizeName(size), size,
+			[data, size](uint64 _iterations)
+			{
+				for (uint64 i = 0; i < _iterations; ++i)
+				{
+					BenchKeep((unsigned)fXXH3::ComputeHash(data, size).m_hash64);
+				}
+			});
+	}
+
+	// Update() fed in odd sized pieces, as a stream reader would
+	{
+		size_t const size = 4 * 1024 * 1024;
+		size_t const piece = 1000;
+		unsigned char const* data = aligned;
+		_runner.Run("sha1-update/" + SizeName(size) + "/1000B pieces", size,
+			[data, size, piece](uint64 _iterations)
+			{
+				for (uint64 i = 0; i < _iterations; ++i)
+				{
+					fSHA1 sha;
+					sha.StreamStart();
+					for (size_t done = 0; done < size; done += piece)
+					{
+						sha.Update(data + done, (size - done < piece) ? size - done : piece);
+					}
+					sha.Finish();
+					BenchKeep(sha.m_hash[0]);
+				}
+			});
+	}
+
+	// RC4 sets up its permutation on every call, the empty buffer is that cost alone
+	static size_t const rc4Sizes[] = { 0, 16, 256, 4096, 1024 * 1024 };
+	for (size_t s = 0; s < sizeof(rc4Sizes) / sizeof(rc4Sizes[0]); ++s)
+	{
+		size_t size = rc4Sizes[s];
+		unsigned char* buffer = aligned;
+		std::string key = SharedMemoryKey;
+		_runner.Run(size ? "rc4/" + SizeName(size) : std::string("rc4/key setup"), size,
+			[buffer, size, key](uint64 _iterations)
+			{
+				for (uint64 i = 0; i < _iterations; ++i)
+				{
+					RC4Encrypt::Encrypt(key, buffer, size);
+				}
+				BenchKeep(buffer[0]);
+			});
+	}
+
+	// The same, cloning a context keyed up front; the empty buffer is the clone alone
+	RC4Context const rc4Keyed(SharedMemoryKey);
+	for (size_t s = 0; s < sizeof(rc4Sizes) / sizeof(rc4Sizes[0]); ++s)
+	{
+		size_t size = rc4Sizes[s];
+		unsigned char* buffer = aligned;
+		_runner.Run(size ? "rc4-context/" + SizeName(size) : std::string("rc4-context/clone"), size,
+			[buffer, size, rc4Keyed](uint64 _iterations)
+			{
+				for (uint64 i = 0; i < _iterations; ++i)
+				{
+					RC4Context rc4 = rc4Keyed;
+					rc4.Process(buffer, size);
+				}
+				BenchKeep(buffer[0]);
+			});
+	}
+
+	// Many small records, one stream at a time against 4 and 8 interleaved
+	static size_t const rc4BatchSizes[] = { 64, 256, 4096 };
+	static unsigned const rc4Lanes[] = { 1, 4, 8 };
+	size_t const rc4Records = 256;
+	for (size_t s = 0; s < sizeof(rc4BatchSizes) / sizeof(rc4BatchSizes[0]); ++s)
+	{
+		size_t size = rc4BatchSizes[s];
+		std::vector<RC4Buffer> records(rc4Records);
+		for (size_t r = 0; r < rc4Records; ++r)
+		{
+			records[r].m_data = aligned + r * size;
+			records[r].m_len = size;
+		}
+		for (size_t l = 0; l < sizeof(rc4Lanes) / sizeof(rc4Lanes[0]); ++l)
+		{
+			unsigned lanes = rc4Lanes[l];
+			std::string name = "rc4-batch/" + std::to_string(rc4Records) + "x" + SizeName(size) + "/"
+				+ ((lanes == 1) ? std::string("scalar") : std::to_string(lanes) + " lanes");
+			_runner.Run(name, rc4Records * size,
+				[records, lanes, rc4Keyed](uint64 _iterations)
+				{
+					for (uint64 i = 0; i < _iterations; ++i)
+					{
+						if (lanes == 1)
+						{
+							for (size_t r = 0; r < records.size(); ++r)
+							{
+								RC4Context rc4 = rc4Keyed;
+								rc4.Process(records[r].m_data, records[r].m_len);
+							}
+						}
+						else
+						{
+							RC4Context::EncryptBatch(rc4Keyed, &records[0], records.size(), lanes);
+						}
+					}
+					BenchKeep(records[0].m_data[0]);
+				});
+		}
+	}
+
+	// Many small messages, one at a time against fSHA1MultiHasher's lanes
+	static size_t const sha1BatchSizes[] = { 64, 1024, 16 * 1024 };
+	size_t const sha1Messages = 256;
+	for (size_t s = 0; s < sizeof(sha1BatchSizes) / sizeof(sha1BatchSizes[0]); ++s)
+	{
+		size_t size = sha1BatchSizes[s];
+		std::vector<fSHA1Job> jobs(sha1Messages);
+		for (size_t m = 0; m < sha1Messages; ++m)
+		{
+			jobs[m].m_data = aligned + m * size;
+			jobs[m].m_size = size;
+		}
+		std::string name = "sha1-multi/" + std::to_string(sha1Messages) + "x" + SizeName(size) + "/";
+		_runner.Run(name + "single", sha1Messages * size,
+			[jobs](uint64 _iterations)
+			{
+				for (uint64 i = 0; i < _iterations; ++i)
+				{
+					for (size_t m = 0; m < jobs.size(); ++m)
+					{
+						BenchKeep(fSHA1::ComputeHash(jobs[m].m_data, (size_t)jobs[m].m_size).m_hash[0]);
+					}
+				}
+			});
+		_runner.Run(name + std::to_string(fSHA1MultiHasher::LaneCount()) + " lanes " + fSHA1MultiHasher::KernelName(), sha1Messages * size,
+			[jobs](uint64 _iterations) mutable
+			{
+				for (uint64 i = 0; i < _iterations; ++i)
+				{
+					fSHA1MultiHasher hasher(&IgnoreJob, NULL);
+					for (size_t m = 0; m < jobs.size(); ++m)
+					{
+						hasher.Submit(&jobs[m]);
+					}
+					hasher.Flush();
+				}
+				BenchKeep(jobs[0].m_result.m_hash[0]);
+			});
+	}
+
+	static unsigned const base16Sizes[] = { 16, 256, 4096, 1024 * 1024 };
+	for (size_t s = 0; s < sizeof(base16Sizes) / sizeof(base16Sizes[0]); ++s)
+	{
+		unsigned size = base16Sizes[s];
+		char const* data = (char const*)aligned;
+		_runner.Run("base16/" + SizeName(size), size,
+			[data, size](uint64 _iterations)
+			{
+				for (uint64 i = 0; i < _iterations; ++i)
+				{
+					BenchKeep((unsigned)Base16Encode(data, size).size());
+				}
+			});
+	}
+
+	// Into a buffer of the caller's, and back again
+	std::vector<char> hex(2 * 1024 * 1024);
+	std::vector<unsigned char> decoded(1024 * 1024);
+	for (size_t s = 0; s < sizeof(base16Sizes) / sizeof(base16Sizes[0]); ++s)
+	{
+		unsigned size = base16Sizes[s];
+		unsigned char const* data = aligned;
+		char* text = &hex[0];
+		unsigned char* bytes = &decoded[0];
+		_runner.Run("base16-to/" + SizeName(size), size,
+			[data, size, text](uint64 _iterations)
+			{
+				for (uint64 i = 0; i < _iterations; ++i)
+				{
+					BenchKeep(Base16EncodeTo(data, size, text, 2 * size));
+				}
+			});
+		_runner.Run("base16-decode/" + SizeName(size), size,
+			[text, size, bytes](uint64 _iterations)
+			{
+				for (uint64 i = 0; i < _iterations; ++i)
+				{
+					BenchKeep(Base16DecodeTo(text, 2 * size, bytes, size));
+				}
+			},
+			[data, size, text]()
+			{
+				Base16EncodeTo(data, size, text, 2 * size);
+			});
+	}
+
+	static unsigned const encryptSizes[] = { 16, 256, 4096, 1024 * 1024 };
+	for (size_t s = 0; s < sizeof(encryptSizes) / sizeof(encryptSizes[0]); ++s)
+	{
+		unsigned size = encryptSizes[s];
+		void* data = aligned;
+		_runner.Run("encryptandb16/" + SizeName(size), size,
+			[data, size](uint64 _iterations)
+			{
+				for (uint64 i = 0; i < _iterations; ++i)
+				{
+					BenchKeep((unsigned)EncryptAndB16(data, size, SharedMemoryKey).size());
+				}
+			});
+	}
+}
+
+static void FileBenchmarks
+(
+	BenchRunner& _runner,
+	std::string const& _path,
+	FileHashOptions const& _options
+)
+{
+	FileHashResult first;
+	if (!HashFile(_path, _options, &first))
+	{
+		std::cerr << "Unable to hash " << _path << "\n";
+		return;
+	}
+	std::string prefix = std::string("sha1-file/") + FileHashOptions::ModeName(_options.m_mode) + "/" + SizeName(first.m_size);
+	FileHashOptions options = _options;
+
+	// The first hash above has left the file in the cache
+	_runner.Run(prefix + "/warm", first.m_size,
+		[&_path, &options](uint64 _iterations)
+		{
+			for (uint64 i = 0; i < _iterations; ++i)
+			{
+				FileHashResult result;
+				HashFile(_path, options, &result);
+				BenchKeep(result.m_digest.m_hash[0]);
+			}
+		}, BenchRunner::Setup(), 1);
+
+	if (!_runner.Wanted(prefix + "/cold"))
+	{
+		return;
+	}
+	if (!EvictFromCache(_path))
+	{
+		std::cerr << "Can't evict " << _path << " from the file cache, skipping the cold case\n";
+		return;
+	}
+	_runner.Run(prefix + "/cold", first.m_size,
+		[&_path, &options](uint64 _iterations)
+		{
+			for (uint64 i = 0; i < _iterations; ++i)
+			{
+				FileHashResult result;
+				HashFile(_path, options, &result);
+				BenchKeep(result.m_digest.m_hash[0]);
+			}
+		},
+		[&_path]()
+		{
+			EvictFromCache(_path);
+		}, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fSHA1::ComputeHash, with whichever kernel it picked, against
+///        fSHA1Constexpr on the same bytes. The static_asserts in Sha1.cpp
+///        only hold the constexpr version to the FIPS vectors.
+/// @return false if they differ for any length
+static bool Sha1Checks()
+{
+	// every length up to three blocks, so each side of 55/56 and 63/64/65
+	// where the padding spills into another block
+	unsigned char data[3 * 64 + 1];
+	for (size_t i = 0; i < sizeof(data); ++i)
+	{
+		data[i] = (unsigned char)(i * 131 + 7);
+	}
+	bool ok = true;
+	for (size_t size = 0; size <= sizeof(data); ++size)
+	{
+		if (fSHA1::ComputeHash(data, size).Digest() != fSHA1Constexpr::HashBytes(data, size))
+		{
+			std::cout << "sha1 check " << size << " bytes: FAILED, " << fSHA1::KernelName() << " kernel and constexpr differ\n";
+			ok = false;
+		}
+	}
+	if (ok)
+	{
+		std::cout << "sha1 check 0 to " << sizeof(data) << " bytes: ok\n";
+	}
+	return ok;
+}
+
+static void CountJob
+(
+	fSHA1Job* /*_job*/,
+	void* _context
+)
+{
+	++*(size_t*)_context;
+}
+
+struct HashedFile
+{
+	std::string m_path;
+	Sha1Digest m_digest;
+	uint64 m_size;
+	bool m_ok;
+};
+
+static void NoteFile
+(
+	std::string const& _path,
+	fSHA1 const& _digest,
+	uint64 _size,
+	bool _ok,
+	void* _context
+)
+{
+	HashedFile hashed;
+	hashed.m_path = _path;
+	hashed.m_digest = _digest.Digest();
+	hashed.m_size = _size;
+	hashed.m_ok = _ok;
+	((std::vector<HashedFile>*)_context)->push_back(hashed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fSHA1MultiHasher and fSHA1HashFiles against fSHA1::ComputeHash of
+///        each message on its own. The lengths are mixed so lanes finish at
+///        different times and are refilled, and some start unaligned.
+/// @return false if any digest differs
+static bool Sha1MultiChecks()
+{
+	std::vector<size_t> sizes;
+	for (size_t size = 0; size <= 3 * 64 + 1; ++size)
+	{
+		sizes.push_back(size);
+	}
+	sizes.push_back(4096);
+	sizes.push_back(64 * 1024 + 13);
+	sizes.push_back(1024 * 1024 + 7);
+
+	std::vector<unsigned char> data(2 * 1024 * 1024);
+	for (size_t i = 0; i < data.size(); ++i)
+	{
+		data[i] = (unsigned char)(i * 131 + (i >> 8));
+	}
+
+	std::vector<fSHA1Job> jobs(sizes.size());
+	size_t completed = 0;
+	{
+		fSHA1MultiHasher hasher(&CountJob, &completed);
+		for (size_t i = 0; i < jobs.size(); ++i)
+		{
+			jobs[i].m_data = &data[(i * 7) % 4096];
+			jobs[i].m_size = sizes[i];
+			hasher.Submit(&jobs[i]);
+		}
+		hasher.Flush();
+	}
+	bool ok = (completed == jobs.size());
+	for (size_t i = 0; i < jobs.size(); ++i)
+	{
+		if (jobs[i].m_result.Digest() != fSHA1::ComputeHash(jobs[i].m_data, sizes[i]).Digest())
+		{
+			std::cout << "sha1-multi check " << sizes[i] << " bytes: FAILED\n";
+			ok = false;
+		}
+	}
+
+	// Files either side of the in memory limit, so both the lanes and the
+	// streamed path are used, and one that can't be opened
+	static size_t const fileSizes[] = { 0, 55, 64, 1000, 65536, 65537, 300000 };
+	size_t const fileCount = sizeof(fileSizes) / sizeof(fileSizes[0]);
+	std::vector<std::string> paths;
+	for (size_t f = 0; f < fileCount; ++f)
+	{
+		paths.push_back("WatchDogBench-multi" + std::to_string(f) + ".tmp");
+		std::ofstream file(paths[f].c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		file.write((char const*)&data[f], fileSizes[f]);
+	}
+	paths.push_back("WatchDogBench-missing.tmp");
+
+	std::vector<HashedFile> results;
+	fSHA1HashFiles(paths, &NoteFile, &results, 65536);
+	bool filesOk = (results.size() == paths.size());
+	for (size_t r = 0; r < results.size(); ++r)
+	{
+		size_t f = 0;
+		while (f < paths.size() && paths[f] != results[r].m_path)
+		{
+			++f;
+		}
+		bool fileOk = (f == fileCount) ? !results[r].m_ok
+			: (f < fileCount && results[r].m_ok && results[r].m_size == fileSizes[f]
+				&& results[r].m_digest == fSHA1::ComputeHash(&data[f], fileSizes[f]).Digest());
+		if (!fileOk)
+		{
+			std::cout << "sha1-multi check " << results[r].m_path << ": FAILED\n";
+			filesOk = false;
+		}
+	}
+	for (size_t f = 0; f < fileCount; ++f)
+	{
+		remove(paths[f].c_str());
+	}
+	ok &= filesOk;
+
+	if (ok)
+	{
+		std::cout << "sha1-multi check " << jobs.size() << " messages and " << paths.size() << " files, "
+			<< fSHA1MultiHasher::LaneCount() << " lanes (" << fSHA1MultiHasher::KernelName() << "): ok\n";
+	}
+	return ok;
+}
+
+static std::wstring HttpPath
+(
+	wchar_t const* _prefix,
+	uint64 _size
+)
+{
+	return _prefix + std::to_wstring(_size);
+}
+
+static bool HttpCheck
+(
+	char const* _name,
+	bool _ok
+)
+{
+	std::cout << "http check " << _name << (_ok ? ": ok\n" : ": FAILED\n");
+	return _ok;
+}
+
+static std::string ResponseText
+(
+	SimpleHttpRequest const& _request
+)
+{
+	return std::string(_request.m_responseBody.begin(), _request.m_responseBody.end());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Every way SimpleHttpRequest sends and receives a body, against
+///        what the server says it got and what it is known to send
+/// @return false if any of them is wrong
+static bool HttpChecks
+(
+	LoopbackServer& _server
+)
+{
+	std::wstring const host = L"127.0.0.1";
+	INTERNET_PORT const port = _server.Port();
+	// a few pieces of the read buffer and an odd end
+	size_t const size = 3 * 1024 * 1024 + 17;
+	std::vector<unsigned char> expected(size);
+	LoopbackServer::Pattern(0, &expected[0], size);
+	std::string const uploaded = LoopbackServer::UploadReply(&expected[0], size);
+	bool ok = true;
+
+	{
+		SimpleHttpRequest request(L"WatchDogBench", false);
+		request.m_port = port;
+		bool sent = request.SendRequest(host, L"GET", HttpPath(L"/bytes/", size), NULL, 0);
+		ok &= HttpCheck("get content-length", sent && request.m_responseBody == expected &&
+			request.m_responseHeader.compare(0, 15, L"HTTP/1.1 200 OK") == 0);
+		sent = request.SendRequest(host, L"GET", HttpPath(L"/chunked/", size), NULL, 0);
+		ok &= HttpCheck("get chunked", sent && request.m_responseBody == expected);
+		sent = request.SendRequest(host, L"GET", HttpPath(L"/close/", size), NULL, 0);
+		ok &= HttpCheck("get to close", sent && request.m_responseBody == expected);
+		sent = request.SendRequest(host, L"HEAD", HttpPath(L"/bytes/", size), NULL, 0);
+		ok &= HttpCheck("head", sent && request.m_responseBody.empty());
+		sent = request.SendRequest(host, L"GET", L"/missing", NULL, 0);
+		ok &= HttpCheck("not found", sent && request.m_responseHeader.compare(0, 12, L"HTTP/1.1 404") == 0);
+
+		HttpHashSink hash;
+		sent = request.SendRequest(host, L"GET", HttpPath(L"/chunked/", size), NULL, 0, hash);
+		ok &= HttpCheck("get to hash sink", sent && hash.Size() == size && hash.Digest() == fSHA1::ComputeHash(&expected[0], size).Digest());
+
+		sent = request.SendRequest(host, L"PUT", L"/api/1.0/dump/upload", &expected[0], (DWORD)size);
+		ok &= HttpCheck("put from memory", sent && ResponseText(request) == uploaded);
+
+		// chunked, its length unknown until it ends
+		size_t offset = 0;
+		HttpCallbackBody chunked([&expected, &offset](void* o_data, size_t _size, size_t* o_read)
+			{
+				*o_read = (expected.size() - offset < _size) ? expected.size() - offset : _size;
+				memcpy(o_data, &expected[offset], *o_read);
+				offset += *o_read;
+				return true;
+			});
+		std::vector<unsigned char> reply;
+		HttpVectorSink replySink(reply);
+		sent = request.SendRequest(host, L"PUT", L"/api/1.0/dump/upload", chunked, replySink);
+		ok &= HttpCheck("put chunked", sent && std::string(reply.begin(), reply.end()) == uploaded);
+
+		std::string const path = "WatchDogBench-http.tmp";
+		FILE* file = fopen(path.c_str(), "wb");
+		bool written = file && fwrite(&expected[0], 1, size, file) == size;
+		if (file)
+		{
+			written = (fclose(file) == 0) && written;
+		}
+		uint64 progress = 0;
+		{
+			HttpFileBody fileBody(path);
+			reply.clear();
+			sent = written && !fileBody.Failed() && request.SendRequest(host, L"PUT", L"/api/1.0/dump/upload", fileBody, replySink,
+				[&progress](uint64 _sent, uint64 /*_total*/) { progress = _sent; });
+		}
+		remove(path.c_str());
+		ok &= HttpCheck("put from file", sent && std::string(reply.begin(), reply.end()) == uploaded && progress == size);
+	}
+
+	{
+		HttpConnectionPool pool(L"WatchDogBench");
+		unsigned connections = _server.Connections();
+		bool sent = true;
+		for (unsigned i = 0; i < 8; ++i)
+		{
+			SimpleHttpRequest request(pool, false);
+			request.m_port = port;
+			sent = request.SendRequest(host, L"GET", L"/bytes/100", NULL, 0) && request.m_responseBody.size() == 100 && sent;
+		}
+		ok &= HttpCheck("pool reuse", sent && pool.Misses() == 1 && pool.Hits() == 7 && _server.Connections() == connections + 1);
+
+		// the server closes a connection it left open, the next request
+		// mustn't fail for it
+		SimpleHttpRequest request(pool, false);
+		request.m_port = port;
+		sent = request.SendRequest(host, L"GET", L"/drop", NULL, 0);
+		sent = sent && request.SendRequest(host, L"GET", L"/bytes/100", NULL, 0) && request.m_responseBody.size() == 100;
+		ok &= HttpCheck("server closed idle connection", sent);
+	}
+
+	{
+		// nothing listens on port 1
+		SimpleHttpRequest request(L"WatchDogBench", false);
+		request.m_port = 1;
+		ok &= HttpCheck("connection refused", !request.SendRequest(host, L"GET", L"/bytes/100", NULL, 0));
+	}
+	return ok;
+}
+
+static void HttpBenchmarks
+(
+	BenchRunner& _runner,
+	LoopbackServer& _server
+)
+{
+	std::wstring const host = L"127.0.0.1";
+	INTERNET_PORT const port = _server.Port();
+	HttpConnectionPool pool(L"WatchDogBench");
+
+	// Requests a second: what a connection costs against reusing one
+	_runner.Run("http/get 64B/pooled", 64,
+		[&pool, &host, port](uint64 _iterations)
+		{
+			for (uint64 i = 0; i < _iterations; ++i)
+			{
+				SimpleHttpRequest request(pool, false);
+				request.m_port = port;
+				request.SendRequest(host, L"GET", L"/bytes/64", NULL, 0);
+				BenchKeep((unsigned)request.m_responseBody.size());
+			}
+		});
+	_runner.Run("http/get 64B/new connection", 64,
+		[&host, port](uint64 _iterations)
+		{
+			for (uint64 i = 0; i < _iterations; ++i)
+			{
+				SimpleHttpRequest request(L"WatchDogBench", false);
+				request.m_port = port;
+				request.SendRequest(host, L"GET", L"/bytes/64", NULL, 0);
+				BenchKeep((unsigned)request.m_responseBody.size());
+			}
+		});
+
+	uint64 const size = 16 * 1024 * 1024;
+	_runner.Run("http/get " + SizeName(size) + "/to memory", size,
+		[&pool, &host, port, size](uint64 _iterations)
+		{
+			for (uint64 i = 0; i < _iterations; ++i)
+			{
+				SimpleHttpRequest request(pool, false);
+				request.m_port = port;
+				request.SendRequest(host, L"GET", HttpPath(L"/bytes/", size), NULL, 0);
+				BenchKeep((unsigned)request.m_responseBody.size());
+			}
+		});
+	_runner.Run("http/get " + SizeName(size) + "/chunked to hash", size,
+		[&pool, &host, port, size](uint64 _iterations)
+		{
+			for (uint64 i = 0; i < _iterations; ++i)
+			{
+				SimpleHttpRequest request(pool, false);
+				request.m_port = port;
+				HttpHashSink hash;
+				request.SendRequest(host, L"GET", HttpPath(L"/chunked/", size), NULL, 0, hash);
+				BenchKeep(hash.Digest().m_bytes[0]);
+			}
+		});
+
+	// The server hashes what it receives, so these are bounded by fSHA1
+	// as well as the client
+	std::vector<unsigned char> body((size_t)size);
+	LoopbackServer::Pattern(0, &body[0], body.size());
+	_runner.Run("http/put " + SizeName(size) + "/from memory", size,
+		[&pool, &host, port, &body](uint64 _iterations)
+		{
+			for (uint64 i = 0; i < _iterations; ++i)
+			{
+				SimpleHttpRequest request(pool, false);
+				request.m_port = port;
+				request.SendRequest(host, L"PUT", L"/api/1.0/dump/upload", &body[0], (DWORD)body.size());
+				BenchKeep((unsigned)request.m_responseBody.size());
+			}
+		});
+	_runner.Run("http/put " + SizeName(size) + "/chunked", size,
+		[&pool, &host, port, &body](uint64 _iterations)
+		{
+			for (uint64 i = 0; i < _iterations; ++i)
+			{
+				size_t offset = 0;
+				HttpCallbackBody chunked([&body, &offset](void* o_data, size_t _size, size_t* o_read)
+					{
+						*o_read = (body.size() - offset < _size) ? body.size() - offset : _size;
+						memcpy(o_data, &body[offset], *o_read);
+						offset += *o_read;
+						return true;
+					});
+				SimpleHttpRequest request(pool, false);
+				request.m_port = port;
+				std::vector<unsigned char> reply;
+				HttpVectorSink replySink(reply);
+				request.SendRequest(host, L"PUT", L"/api/1.0/dump/upload", chunked, replySink);
+				BenchKeep((unsigned)reply.size());
+			}
+		});
+
+	std::string const path = "WatchDogBench-http.tmp";
+	if (WriteTestFile(path, size))
+	{
+		_runner.Run("http/put " + SizeName(size) + "/from file", size,
+			[&pool, &host, port, &path](uint64 _iterations)
+			{
+				for (uint64 i = 0; i < _iterations; ++i)
+				{
+					HttpFileBody fileBody(path);
+					SimpleHttpRequest request(pool, false);
+					request.m_port = port;
+					std::vector<unsigned char> reply;
+					HttpVectorSink replySink(reply);
+					request.SendRequest(host, L"PUT", L"/api/1.0/dump/upload", fileBody, replySink);
+					BenchKeep((unsigned)reply.size());
+				}
+			});
+	}
+	remove(path.c_str());
+}
+
+int main
+(
+	int argc,
+	char* argv[]
+)
+{
+	BenchRunner::Options options;
+	std::string jsonPath, filePath;
+	uint64 fileSize = 256ull * 1024 * 1024;
+	FileHashOptions fileOptions;
+	fileOptions.m_unbuffered = false;	// the cold case depends on going through the cache
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string key = argv[i];
+		std::string value = argv[i + 1];
+
+		if (key == "/Repetitions")
+		{
+			options.m_repetitions = (unsigned)atoi(value.c_str());
+		}
+		else if (key == "/MinTime")
+		{
+			options.m_minSeconds = atof(value.c_str()) / 1000.0;
+		}
+		else if (key == "/Filter")
+		{
+			options.m_filter = value;
+		}
+		else if (key == "/Json")
+		{
+			jsonPath = value;
+		}
+		else if (key == "/File")
+		{
+			filePath = value;
+		}
+		else if (key == "/FileSize")
+		{
+			// in MB
+			fileSize = (uint64)atoll(value.c_str()) * 1024 * 1024;
+		}
+		else if (key == "/FileMode")
+		{
+			if (!FileHashOptions::ParseMode(value, &fileOptions.m_mode))
+			{
+				std::cerr << "Unknown file mode " << value << "\n";
+				return 1;
+			}
+		}
+		else
+		{
+			std::cerr << "Unknown option " << key << "\n";
+			std::cerr << "Usage: WatchDogBench [/Repetitions <n>] [/MinTime <ms>] [/Filter <text>] [/Json <file>]\n"
+				"                     [/File <path>] [/FileSize <MB>] [/FileMode serial|pipelined|mapped]\n";
+			return 1;
+		}
+	}
+
+	std::cout << "fSHA1 kernel: " << fSHA1::KernelName() << ", XXH3 kernel: " << fXXH3::KernelName() << ", "
+		<< options.m_repetitions << " repetitions\n";
+	bool sha1Ok = Sha1Checks();
+	sha1Ok &= Sha1MultiChecks();
+	BenchRunner runner(options, std::cout);
+	MemoryBenchmarks(runner);
+
+	bool httpOk = true;
+	// a filter naming one of the http cases wants the server too
+	if (runner.Wanted("http/") || options.m_filter.compare(0, 5, "http/") == 0)
+	{
+		LoopbackServer server;
+		if (!server.Start())
+		{
+			std::cerr << "Unable to start the loopback server\n";
+		}
+		else
+		{
+			httpOk = HttpChecks(server);
+			HttpBenchmarks(runner, server);
+		}
+	}
+
+	if (!filePath.empty())
+	{
+		FileBenchmarks(runner, filePath, fileOptions);
+	}
+	else if (fileSize != 0 && runner.Wanted("sha1-file/"))
+	{
+		std::string tempPath = "WatchDogBench.tmp";
+		if (WriteTestFile(tempPath, fileSize))
+		{
+			FileBenchmarks(runner, tempPath, fileOptions);
+		}
+		else
+		{
+			std::cerr << "Unable to write " << tempPath << "\n";
+		}
+		remove(tempPath.c_str());
+	}
+
+	if (!jsonPath.empty())
+	{
+		std::ofstream json(jsonPath.c_str(), std::ios::out | std::ios::trunc);
+		runner.WriteJson(json, fSHA1::KernelName());
+		if (!json.good())
+		{
+			std::cerr << "Unable to write " << jsonPath << "\n";
+			return 2;
+		}
+	}
+	return (sha1Ok && httpOk) ? 0 : 3;
+}